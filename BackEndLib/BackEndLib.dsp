@@ -138,6 +138,10 @@ SOURCE=.\Base64.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Bitboard.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Browser.cpp
 # End Source File
 # Begin Source File
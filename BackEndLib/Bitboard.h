@@ -0,0 +1,294 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//Bitboard.h
+//Room-sized grid of bits, for operating on whole sets of squares at once.
+//
+//Bits are stored a column at a time, as in CCoordSet, so a standard room
+//column fits in one word.  Squares connected along a column are found with a
+//few shifts of each word, and connections between columns by combining
+//neighboring columns.
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "Types.h"
+#include "CoordSet.h"
+
+#include <algorithm>
+#include <vector>
+
+class CBitboard
+{
+public:
+	CBitboard() : wCols(0), wRows(0), wColWords(0) {}
+	CBitboard(const UINT wCols, const UINT wRows) : wCols(0), wRows(0), wColWords(0)
+		{resize(wCols, wRows);}
+
+	void resize(const UINT wCols, const UINT wRows)
+	//Sets the size of the grid and clears it.
+	{
+		this->wCols = wCols;
+		this->wRows = wRows;
+		this->wColWords = (wRows + 31) / 32;
+		this->bits.assign(wCols * this->wColWords, 0);
+	}
+	void clear() {std::fill(this->bits.begin(), this->bits.end(), 0);}
+
+	inline UINT GetCols() const {return this->wCols;}
+	inline UINT GetRows() const {return this->wRows;}
+
+	inline bool has(const UINT wX, const UINT wY) const
+	{
+		return wX < this->wCols && wY < this->wRows &&
+				(this->bits[wX * this->wColWords + wY / 32] & (1u << (wY % 32))) != 0;
+	}
+	inline void insert(const UINT wX, const UINT wY)
+	{
+		ASSERT(wX < this->wCols && wY < this->wRows);
+		this->bits[wX * this->wColWords + wY / 32] |= 1u << (wY % 32);
+	}
+	void insert(const CCoordSet& coords)
+	//Adds the coords in the set that are on the grid.
+	{
+		for (CCoordSet::const_iterator coord = coords.begin(); coord != coords.end(); ++coord)
+			if (coord->wX < this->wCols && coord->wY < this->wRows)
+				insert(coord->wX, coord->wY);
+	}
+	inline void erase(const UINT wX, const UINT wY)
+	{
+		ASSERT(wX < this->wCols && wY < this->wRows);
+		this->bits[wX * this->wColWords + wY / 32] &= ~(1u << (wY % 32));
+	}
+	bool empty() const
+	{
+		for (std::vector<UINT>::const_iterator word = this->bits.begin(); word != this->bits.end(); ++word)
+			if (*word)
+				return false;
+		return true;
+	}
+
+	void AddTo(CCoordSet& coords) const
+	//Adds the squares set here to coords.
+	{
+		for (UINT wX = 0; wX < this->wCols; ++wX)
+			coords.InsertColumnBits(wX, &this->bits[wX * this->wColWords], this->wColWords);
+	}
+
+	CBitboard& operator&=(const CBitboard& that)
+	{
+		ASSERT(that.wCols == this->wCols && that.wRows == this->wRows);
+		for (UINT wI = this->bits.size(); wI--; )
+			this->bits[wI] &= that.bits[wI];
+		return *this;
+	}
+	CBitboard& operator|=(const CBitboard& that)
+	{
+		ASSERT(that.wCols == this->wCols && that.wRows == this->wRows);
+		for (UINT wI = this->bits.size(); wI--; )
+			this->bits[wI] |= that.bits[wI];
+		return *this;
+	}
+	CBitboard& operator-=(const CBitboard& that)
+	{
+		ASSERT(that.wCols == this->wCols && that.wRows == this->wRows);
+		for (UINT wI = this->bits.size(); wI--; )
+			this->bits[wI] &= ~that.bits[wI];
+		return *this;
+	}
+	inline bool operator==(const CBitboard& that) const
+		{return this->wCols == that.wCols && this->wRows == that.wRows && this->bits == that.bits;}
+
+	CBitboard Shifted(const int nDX, const int nDY) const
+	//Returns: copy with each square moved by (nDX,nDY), where each is -1, 0 or 1.
+	//Squares moved off the grid are dropped.
+	{
+		ASSERT(nDX >= -1 && nDX <= 1 && nDY >= -1 && nDY <= 1);
+		CBitboard shifted(this->wCols, this->wRows);
+		for (UINT wX = 0; wX < this->wCols; ++wX)
+		{
+			const UINT wSrcX = wX - nDX;
+			if (wSrcX < this->wCols)
+				ShiftColumn(&this->bits[wSrcX * this->wColWords],
+						&shifted.bits[wX * this->wColWords], nDY);
+		}
+		return shifted;
+	}
+
+	void Dilate(const bool b8Neighbor)
+	//Adds the squares next to each square set.
+	{
+		CBitboard grown(Shifted(0, -1));
+		grown |= Shifted(0, 1);
+		grown |= *this;
+		CBitboard sides(b8Neighbor ? grown : *this);
+		*this = grown;
+		*this |= sides.Shifted(-1, 0);
+		*this |= sides.Shifted(1, 0);
+	}
+
+	void FloodFill(
+	//Grows the squares set here through all the squares of region they
+	//connect to.  Squares not in region are dropped.
+	//
+	//Params:
+		const CBitboard& region,  //(in) squares that may be filled
+		const bool b8Neighbor,    //(in) whether squares connect diagonally
+		const CBitboard *pNoDiagonalFrom=NULL) //(in) if set, no diagonal steps
+		                                       //are taken from these squares
+	{
+		ASSERT(region.wCols == this->wCols && region.wRows == this->wRows);
+		ASSERT(!pNoDiagonalFrom || (pNoDiagonalFrom->wCols == this->wCols &&
+				pNoDiagonalFrom->wRows == this->wRows));
+		*this &= region;
+
+		//Sweep across the columns, alternating direction, until nothing changes.
+		std::vector<UINT> grown(this->wColWords), from(this->wColWords), shifted(this->wColWords);
+		bool bChanged, bForward = true;
+		do {
+			bChanged = false;
+			for (UINT wN = 0; wN < this->wCols; ++wN)
+			{
+				const UINT wX = bForward ? wN : this->wCols - 1 - wN;
+				UINT *pCol = &this->bits[wX * this->wColWords];
+				const UINT *pRegion = &region.bits[wX * this->wColWords];
+				std::copy(pCol, pCol + this->wColWords, grown.begin());
+
+				//Take squares from the neighboring columns.
+				for (int nDX = -1; nDX <= 1; nDX += 2)
+				{
+					const UINT wNX = wX + nDX;
+					if (wNX >= this->wCols)
+						continue;
+					const UINT *pAdj = &this->bits[wNX * this->wColWords];
+					UINT wI;
+					for (wI = 0; wI < this->wColWords; ++wI)
+						grown[wI] |= pAdj[wI];
+					if (!b8Neighbor)
+						continue;
+
+					std::copy(pAdj, pAdj + this->wColWords, from.begin());
+					if (pNoDiagonalFrom)
+					{
+						const UINT *pNoDiagonal = &pNoDiagonalFrom->bits[wNX * this->wColWords];
+						for (wI = 0; wI < this->wColWords; ++wI)
+							from[wI] &= ~pNoDiagonal[wI];
+					}
+					ShiftColumn(&from[0], &shifted[0], 1);
+					for (wI = 0; wI < this->wColWords; ++wI)
+						grown[wI] |= shifted[wI];
+					ShiftColumn(&from[0], &shifted[0], -1);
+					for (wI = 0; wI < this->wColWords; ++wI)
+						grown[wI] |= shifted[wI];
+				}
+
+				//Then spread along the column.
+				UINT wI;
+				for (wI = 0; wI < this->wColWords; ++wI)
+					grown[wI] &= pRegion[wI];
+				FillColumn(&grown[0], pRegion);
+
+				if (!std::equal(grown.begin(), grown.end(), pCol))
+				{
+					std::copy(grown.begin(), grown.end(), pCol);
+					bChanged = true;
+				}
+			}
+			bForward = !bForward;
+		} while (bChanged);
+	}
+
+private:
+	void ShiftColumn(const UINT *pSrc, UINT *pDest, const int nDY) const
+	//Writes a column with its squares moved nDY rows, where nDY is -1, 0 or 1.
+	{
+		UINT wI;
+		if (nDY > 0)
+		{
+			for (wI = 0; wI < this->wColWords; ++wI)
+				pDest[wI] = (pSrc[wI] << 1) | (wI ? pSrc[wI - 1] >> 31 : 0);
+		} else if (nDY < 0) {
+			for (wI = 0; wI < this->wColWords; ++wI)
+				pDest[wI] = (pSrc[wI] >> 1) | (wI + 1 < this->wColWords ? pSrc[wI + 1] << 31 : 0);
+		} else {
+			std::copy(pSrc, pSrc + this->wColWords, pDest);
+		}
+		if (this->wRows % 32)
+			pDest[this->wColWords - 1] &= (1u << (this->wRows % 32)) - 1;
+	}
+
+	static inline UINT FillWord(UINT fill, const UINT region)
+	//Returns: fill grown each way along the runs of bits in region it touches
+	//(fill must be a subset of region)
+	{
+		UINT open = region;
+		fill |= open & (fill << 1);  open &= open << 1;
+		fill |= open & (fill << 2);  open &= open << 2;
+		fill |= open & (fill << 4);  open &= open << 4;
+		fill |= open & (fill << 8);  open &= open << 8;
+		fill |= open & (fill << 16);
+		open = region;
+		fill |= open & (fill >> 1);  open &= open >> 1;
+		fill |= open & (fill >> 2);  open &= open >> 2;
+		fill |= open & (fill >> 4);  open &= open >> 4;
+		fill |= open & (fill >> 8);  open &= open >> 8;
+		fill |= open & (fill >> 16);
+		return fill;
+	}
+
+	void FillColumn(UINT *pCol, const UINT *pRegion) const
+	//Grows the squares set in a column along the column's runs of region squares.
+	{
+		bool bCarried;
+		do {
+			UINT wI;
+			for (wI = 0; wI < this->wColWords; ++wI)
+				pCol[wI] = FillWord(pCol[wI], pRegion[wI]);
+
+			//Runs may continue across words.
+			bCarried = false;
+			for (wI = 0; wI + 1 < this->wColWords; ++wI)
+			{
+				if ((pCol[wI] >> 31) && (pRegion[wI + 1] & 1) && !(pCol[wI + 1] & 1))
+				{
+					pCol[wI + 1] |= 1;
+					bCarried = true;
+				}
+				if ((pCol[wI + 1] & 1) && (pRegion[wI] >> 31) && !(pCol[wI] >> 31))
+				{
+					pCol[wI] |= 1u << 31;
+					bCarried = true;
+				}
+			}
+		} while (bCarried);
+	}
+
+	std::vector<UINT> bits;  //wColWords words for each of wCols columns, column by column
+	UINT wCols, wRows;
+	UINT wColWords;
+};
+
+#endif //...#ifndef BITBOARD_H
@@ -35,10 +35,20 @@
 //will be used.
 //
 //Additionally, special values can be stored at X,Y coordinates.
+//
+//Copies of an index share the same storage until one of them is modified
+//(copy-on-write), so duplicating room state (e.g., for game snapshots) only
+//allocates memory for indexes that actually change afterwards.
+//
+//The count of copies sharing storage is atomic, so copies may be modified and
+//freed on different threads.  The count is created by the first copy made,
+//which writes to the source, so an index must only be copied on the thread
+//that owns it.
 
 #include "Types.h"
 #include "AttachableObject.h"
 #include "Assert.h"
+#include <SDL_atomic.h>
 #include <cstring>
 
 class CCoordSet;
@@ -65,7 +75,6 @@ public:
 	inline UINT  GetRows() const {return this->wRows;}
 	inline UINT  GetSize() const {return this->dwCoordCount;}
 	inline T     GetAt(const UINT wX, const UINT wY) const;
-	inline T&    GetAt(const UINT wX, const UINT wY);
 	bool        Init(const UINT wSetCols, const UINT wSetRows, const T val=0);
 	void        Remove(const UINT wX, const UINT wY);
 	void        RemoveAll(const T val);
@@ -74,9 +83,14 @@ public:
 	void        SetAtIndex(const UINT index, const T val);
 
 private:
+	void        Detach();
+	void        Release();
+	void        ShareFrom(const CCoordIndex_T<T>& Src);
+
 	UINT dwCoordCount;
 	UINT  wCols, wRows;
 	T *   pbytIndex;
+	mutable SDL_atomic_t *pRefCount; //when non-NULL, pbytIndex may be shared with other copies
 };
 
 typedef CCoordIndex_T<BYTE> CCoordIndex;
@@ -99,6 +113,7 @@ CCoordIndex_T<T>::CCoordIndex_T(
 	, dwCoordCount(0L)
 	, wCols(0), wRows(0)
 	, pbytIndex(NULL)
+	, pRefCount(NULL)
 {
 	if (wCols && wRows)
 		VERIFY(Init(wCols, wRows, val));
@@ -111,17 +126,10 @@ CCoordIndex_T<T>::CCoordIndex_T(const CCoordIndex_T<T>& coordIndex)
 	, dwCoordCount(0L)
 	, wCols(0), wRows(0)
 	, pbytIndex(NULL)
+	, pRefCount(NULL)
 {
 	if (coordIndex.wCols && coordIndex.wRows)
-	{
-		if (Init(coordIndex.wCols, coordIndex.wRows))
-		{
-			//works only for primitive types
-			memcpy(this->pbytIndex, coordIndex.pbytIndex,
-					coordIndex.wCols * coordIndex.wRows * sizeof(T));
-			this->dwCoordCount = coordIndex.dwCoordCount;
-		}
-	}
+		ShareFrom(coordIndex);
 }
 
 //*******************************************************************************
@@ -129,24 +137,24 @@ template<typename T>
 CCoordIndex_T<T>::~CCoordIndex_T()
 //Destructor.
 {
-	delete[] this->pbytIndex;
+	Release();
 }
 
 //*******************************************************************************
 template<typename T>
 CCoordIndex_T<T>& CCoordIndex_T<T>::operator=(const CCoordIndex_T<T>& rhs)
 {
+	if (&rhs == this)
+		return *this;
+
 	if (!rhs.wCols || !rhs.wRows)
 	{
-		delete[] this->pbytIndex;
-		this->pbytIndex = NULL;
+		Release();
 		this->wCols = rhs.wCols;
 		this->wRows = rhs.wRows;
 		this->dwCoordCount = 0;
-	} else if (Init(rhs.wCols, rhs.wRows)) {
-		//works only for primitive types
-		memcpy(this->pbytIndex, rhs.pbytIndex, rhs.GetArea() * sizeof(T));
-		this->dwCoordCount = rhs.dwCoordCount;
+	} else {
+		ShareFrom(rhs);
 	}
 	return *this;
 }
@@ -178,7 +186,7 @@ bool CCoordIndex_T<T>::Init(
 		return true;
 	}
 
-	delete[] this->pbytIndex;
+	Release();
 
 	//Create new index storage.
 	this->pbytIndex = new T[wSetCols * wSetRows];
@@ -218,6 +226,7 @@ void CCoordIndex_T<T>::AddAtIndex(
 {
 	ASSERT(val != 0); //zero is considered the reset value
 	ASSERT(this->pbytIndex);
+	Detach();
 	if (this->pbytIndex[index] == 0) {
 		++this->dwCoordCount;
 		ASSERT(this->dwCoordCount <= GetArea());
@@ -232,7 +241,10 @@ void CCoordIndex_T<T>::Clear(const T val)	//[default=0]
 {
 	if (this->pbytIndex) {
 		if (val || !empty()) //if already empty, don't need to reset memory to 0 again
+		{
+			Detach();
 			memset(this->pbytIndex, val, GetArea() * sizeof(T));
+		}
 	}
 	this->dwCoordCount = val ? GetArea() : 0;
 }
@@ -269,22 +281,6 @@ const
 	return this->pbytIndex[wY * this->wCols + wX];
 }
 
-//*******************************************************************************
-template<typename T>
-T& CCoordIndex_T<T>::GetAt(
-//
-//
-//Params:
-	const UINT wX, const UINT wY)
-//
-//Returns:
-//Value stored at (wX,wY)
-{
-	ASSERT(wX < this->wCols && wY < this->wRows);
-	ASSERT(this->pbytIndex);
-	return this->pbytIndex[wY * this->wCols + wX];
-}
-
 //*******************************************************************************
 template<typename T>
 void CCoordIndex_T<T>::GetCoordsWithValue(const T val, CCoordSet* pCoords) const
@@ -312,6 +308,7 @@ void CCoordIndex_T<T>::Remove(
 	ASSERT(this->pbytIndex);
 	if (this->pbytIndex[dwSquareI])
 	{
+		Detach();
 		--this->dwCoordCount;
 		ASSERT(this->dwCoordCount < GetArea());
 		this->pbytIndex[dwSquareI] = 0;
@@ -330,6 +327,7 @@ void CCoordIndex_T<T>::RemoveAll(
 
 	const UINT area = GetArea();
 	ASSERT(this->dwCoordCount <= area);
+	Detach();
 	for (UINT dwSquareI = 0; dwSquareI<area; ++dwSquareI)
 	{
 		if (this->pbytIndex[dwSquareI] == val)
@@ -351,6 +349,7 @@ void CCoordIndex_T<T>::Replace(const T oldVal, const T newVal)
 	const int inc = oldVal == 0 ? 1 : newVal == 0 ? -1 : 0;
 
 	const UINT area = GetArea();
+	Detach();
 	for (UINT dwSquareI = 0; dwSquareI < area; ++dwSquareI)
 	{
 		if (this->pbytIndex[dwSquareI] == oldVal)
@@ -380,6 +379,7 @@ void CCoordIndex_T<T>::SetAtIndex(
 	const T val)
 {
 	ASSERT(this->pbytIndex);
+	Detach();
 	if (this->pbytIndex[index])
 		--this->dwCoordCount;
 	this->pbytIndex[index] = val;
@@ -390,4 +390,80 @@ void CCoordIndex_T<T>::SetAtIndex(
 	}
 }
 
+//
+//CCoordIndex private template methods.
+//
+
+//*******************************************************************************
+template<typename T>
+void CCoordIndex_T<T>::Detach()
+//Ensures this object holds the only reference to its index storage
+//before the storage is modified.
+{
+	if (!this->pRefCount)
+		return;
+
+	if (SDL_AtomicGet(this->pRefCount) == 1)
+	{
+		//No other copy holds the storage, and none can start to, since
+		//copies are only made from an object holding it.
+		delete this->pRefCount;
+		this->pRefCount = NULL;
+		return;
+	}
+
+	//Other copies may still be using the shared storage -- make a private copy.
+	const UINT area = GetArea();
+	T *pNewIndex = new T[area];
+	//works only for primitive types
+	memcpy(pNewIndex, this->pbytIndex, area * sizeof(T));
+	Release();
+	this->pbytIndex = pNewIndex;
+}
+
+//*******************************************************************************
+template<typename T>
+void CCoordIndex_T<T>::Release()
+//Drops this object's reference to its index storage.
+{
+	if (this->pRefCount)
+	{
+		ASSERT(SDL_AtomicGet(this->pRefCount) > 0);
+		if (SDL_AtomicDecRef(this->pRefCount))
+		{
+			//This was the last copy holding the storage.
+			delete[] this->pbytIndex;
+			delete this->pRefCount;
+		}
+		this->pRefCount = NULL;
+	} else {
+		delete[] this->pbytIndex;
+	}
+	this->pbytIndex = NULL;
+}
+
+//*******************************************************************************
+template<typename T>
+void CCoordIndex_T<T>::ShareFrom(const CCoordIndex_T<T>& Src)
+//Makes this object reference Src's index storage instead of copying it.
+{
+	ASSERT(Src.pbytIndex);
+	if (Src.pbytIndex == this->pbytIndex)
+		return; //already sharing
+
+	if (!Src.pRefCount)
+	{
+		Src.pRefCount = new SDL_atomic_t;
+		SDL_AtomicSet(Src.pRefCount, 1);
+	}
+	SDL_AtomicIncRef(Src.pRefCount);
+
+	Release();
+	this->pbytIndex = Src.pbytIndex;
+	this->pRefCount = Src.pRefCount;
+	this->wCols = Src.wCols;
+	this->wRows = Src.wRows;
+	this->dwCoordCount = Src.dwCoordCount;
+}
+
 #endif //...#ifndef COORDINDEX_H
@@ -25,6 +25,14 @@
  *
  * ***** END LICENSE BLOCK ***** */
 
+//CoordSet.h
+//Set of room coordinates.
+//
+//Coords are kept in a bitboard with one bit per square, stored a column at a
+//time so that scanning the bits visits coords in the same (x, then y) order
+//as a sorted set of ROOMCOORDs would.  The bitboard grows to fit the coords
+//inserted.  Coords too large to reasonably fit in it are kept in a std::set.
+
 #include "Types.h"
 #include "Coord.h"
 #include "CoordIndex.h"
@@ -32,79 +40,214 @@
 #ifndef COORDSET_H
 #define COORDSET_H
 
+#include <algorithm>
+#include <iterator>
 #include <set>
+#include <vector>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
 
 class CCoordSet : public CAttachableObject
 {
 public:
-	typedef std::set<ROOMCOORD> CoordSet;
-	typedef CoordSet::const_iterator const_iterator;
+	//Coords past this in either dimension are not kept in the bitboard.
+	static const UINT MAX_BITBOARD_DIMENSION = 256;
+
+	class const_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef ROOMCOORD value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const ROOMCOORD* pointer;
+		typedef const ROOMCOORD& reference;
+
+		const_iterator() : pSet(NULL), bEnd(true), bBitsLeft(false), bFromBits(false) {}
 
-	CCoordSet() {}
-	CCoordSet(const UINT wX, const UINT wY) {insert(wX,wY);}
+		inline const ROOMCOORD& operator*() const {return this->coord;}
+		inline const ROOMCOORD* operator->() const {return &this->coord;}
+
+		const_iterator& operator++()
+		{
+			ASSERT(!this->bEnd);
+			if (this->bFromBits)
+				this->bBitsLeft = this->pSet->FindNextBit(this->coord.wX,
+						this->coord.wY + 1, this->bitCoord);
+			else
+				++this->overflowIter;
+			Settle();
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator prev(*this);
+			++*this;
+			return prev;
+		}
 
-	inline void clear() {this->data.clear();}
+		inline bool operator==(const const_iterator& rhs) const
+		{
+			if (this->bEnd || rhs.bEnd)
+				return this->bEnd == rhs.bEnd;
+			return this->coord == rhs.coord;
+		}
+		inline bool operator!=(const const_iterator& rhs) const {return !(*this == rhs);}
+
+	private:
+		friend class CCoordSet;
+
+		explicit const_iterator(const CCoordSet *pSet)
+			: pSet(pSet), bEnd(false), bFromBits(false)
+			, overflowIter(pSet->overflow.begin())
+		{
+			this->bBitsLeft = pSet->FindNextBit(0, 0, this->bitCoord);
+			Settle();
+		}
+
+		void Settle()
+		//Make the current coord the lower of the next coords in the bitboard and
+		//in the overflow set.
+		{
+			const bool bOverflowLeft = this->overflowIter != this->pSet->overflow.end();
+			if (this->bBitsLeft && (!bOverflowLeft || this->bitCoord < *this->overflowIter))
+			{
+				this->coord = this->bitCoord;
+				this->bFromBits = true;
+			} else if (bOverflowLeft) {
+				this->coord = *this->overflowIter;
+				this->bFromBits = false;
+			} else {
+				this->bEnd = true;
+			}
+		}
+
+		const CCoordSet *pSet;
+		ROOMCOORD coord;      //current coord
+		bool bEnd;
+		ROOMCOORD bitCoord;   //next coord in the bitboard, if bBitsLeft
+		bool bBitsLeft, bFromBits;
+		std::set<ROOMCOORD>::const_iterator overflowIter;
+	};
+
+	CCoordSet() : wCols(0), wColWords(0), wBitCount(0) {}
+	CCoordSet(const UINT wX, const UINT wY) : wCols(0), wColWords(0), wBitCount(0) {insert(wX,wY);}
+
+	void clear()
+	{
+		//Keep the bitboard allocated, since sets are often refilled.
+		if (this->wBitCount)
+		{
+			std::fill(this->bits.begin(), this->bits.end(), 0);
+			this->wBitCount = 0;
+		}
+		this->overflow.clear();
+	}
 
 	inline bool insert(const UINT wX, const UINT wY)
 	{
-		return insert(ROOMCOORD(wX,wY));
+		if (!InBitboardRange(wX, wY))
+			return this->overflow.insert(ROOMCOORD(wX,wY)).second;
+		Fit(wX, wY);
+		UINT& word = this->bits[wX * this->wColWords + wY / 32];
+		const UINT bit = 1u << (wY % 32);
+		if (word & bit)
+			return false;
+		word |= bit;
+		++this->wBitCount;
+		return true;
 	}
 	inline bool insert(ROOMCOORD const &cc)
 	{
-		return this->data.insert(cc).second;
+		return insert(cc.wX, cc.wY);
 	}
 	inline void insert(CCoordSet::const_iterator begin, CCoordSet::const_iterator end)
 	{
-		this->data.insert(begin, end);
+		for (; begin != end; ++begin)
+			insert(*begin);
+	}
+	void InsertColumnBits(const UINT wX, const UINT *pWords, UINT wWords)
+	//Inserts (wX,wY) for each bit wY set in a column of words.
+	{
+		while (wWords && !pWords[wWords - 1])
+			--wWords;
+		if (!wWords)
+			return;
+		if (!InBitboardRange(wX, wWords * 32 - 1))
+		{
+			for (UINT wY = 0; wY < wWords * 32; ++wY)
+				if (pWords[wY / 32] & (1u << (wY % 32)))
+					insert(wX, wY);
+			return;
+		}
+		Fit(wX, wWords * 32 - 1);
+		UINT *pWord = &this->bits[wX * this->wColWords];
+		for (UINT wI = 0; wI < wWords; ++wI)
+		{
+			this->wBitCount += CountBits(pWords[wI] & ~pWord[wI]);
+			pWord[wI] |= pWords[wI];
+		}
 	}
 
-	inline bool empty() const {return this->data.empty();}
-	inline UINT size() const {return this->data.size();}
+	inline bool empty() const {return !size();}
+	inline UINT size() const {return this->wBitCount + this->overflow.size();}
 
 	inline bool erase(const UINT wX, const UINT wY)
 	{
-		return erase(ROOMCOORD(wX,wY));
+		if (!InBitboardRange(wX, wY))
+			return this->overflow.erase(ROOMCOORD(wX,wY)) != 0;
+		if (!InBitboard(wX, wY))
+			return false;
+		UINT& word = this->bits[wX * this->wColWords + wY / 32];
+		const UINT bit = 1u << (wY % 32);
+		if (!(word & bit))
+			return false;
+		word &= ~bit;
+		--this->wBitCount;
+		return true;
 	}
 	inline bool erase(ROOMCOORD const &cc)
 	{
-		return this->data.erase(cc) != 0;
+		return erase(cc.wX, cc.wY);
 	}
 
 	inline bool first(UINT &wX, UINT &wY) const
 	{
 		if (empty())
 			return false;
-		CoordSet::const_iterator iter = this->data.begin();
+		const_iterator iter = begin();
 		wX = iter->wX; wY = iter->wY;
 		return true;
 	}
 	bool pop_first(UINT &wX, UINT &wY)
 	{
-		if (empty())
+		if (!first(wX, wY))
 			return false;
-		CoordSet::iterator iter = this->data.begin();
-		wX = iter->wX; wY = iter->wY;
-		this->data.erase(iter);
+		erase(wX, wY);
 		return true;
 	}
 
 	inline bool has(const UINT wX, const UINT wY) const
 	{
-		return has(ROOMCOORD(wX, wY));
+		if (InBitboard(wX, wY))
+			return (this->bits[wX * this->wColWords + wY / 32] & (1u << (wY % 32))) != 0;
+		if (InBitboardRange(wX, wY))
+			return false;
+		return this->overflow.count(ROOMCOORD(wX,wY)) != 0;
 	}
 	inline bool has(ROOMCOORD const &cc) const
 	{
-		return this->data.count(cc) != 0;
+		return has(cc.wX, cc.wY);
 	}
 
-	inline const_iterator begin() const {return this->data.begin();}
-	inline const_iterator end() const {return this->data.end();}
+	inline const_iterator begin() const {return const_iterator(this);}
+	inline const_iterator end() const {return const_iterator();}
 
 	void AddTo(CCoordIndex &coordIndex) const
 	//Places all the coords in this object in coordIndex.
 	{
-		for (const_iterator trav = this->data.begin();
-				trav != this->data.end(); ++trav)
+		for (const_iterator trav = begin(); trav != end(); ++trav)
 		{
 			//ASSUME: (wX,wY) are within the bounds of coordIndex
 			coordIndex.Add(trav->wX, trav->wY);
@@ -137,22 +280,166 @@ public:
 	CCoordSet& operator+=(const CCoordSet& that)
 	//Adds all instances of coords in 'that' to this.
 	{
-		for (const_iterator iter = that.data.begin();
-				iter != that.data.end(); ++iter)
-			insert(*iter);
+		if (that.wBitCount)
+		{
+			Fit(that.wCols - 1, that.wColWords * 32 - 1);
+			for (UINT wX = 0; wX < that.wCols; ++wX)
+			{
+				UINT *pWord = &this->bits[wX * this->wColWords];
+				const UINT *pThatWord = &that.bits[wX * that.wColWords];
+				for (UINT wI = 0; wI < that.wColWords; ++wI, ++pWord, ++pThatWord)
+				{
+					this->wBitCount += CountBits(*pThatWord & ~*pWord);
+					*pWord |= *pThatWord;
+				}
+			}
+		}
+		if (!that.overflow.empty())
+			this->overflow.insert(that.overflow.begin(), that.overflow.end());
 		return *this;
 	}
 	CCoordSet& operator-=(const CCoordSet& that)
 	//Removes all instances of coords in 'that' from this.
 	{
-		for (const_iterator iter = that.data.begin();
-				iter != that.data.end(); ++iter)
-			erase(*iter);
+		if (this->wBitCount && that.wBitCount)
+		{
+			const UINT wCols = this->wCols < that.wCols ? this->wCols : that.wCols;
+			const UINT wWords = this->wColWords < that.wColWords ? this->wColWords : that.wColWords;
+			for (UINT wX = 0; wX < wCols; ++wX)
+			{
+				UINT *pWord = &this->bits[wX * this->wColWords];
+				const UINT *pThatWord = &that.bits[wX * that.wColWords];
+				for (UINT wI = 0; wI < wWords; ++wI, ++pWord, ++pThatWord)
+				{
+					this->wBitCount -= CountBits(*pWord & *pThatWord);
+					*pWord &= ~*pThatWord;
+				}
+			}
+		}
+		for (std::set<ROOMCOORD>::const_iterator iter = that.overflow.begin();
+				iter != that.overflow.end() && !this->overflow.empty(); ++iter)
+			this->overflow.erase(*iter);
+		return *this;
+	}
+	CCoordSet& operator&=(const CCoordSet& that)
+	//Removes all coords not also in 'that' from this.
+	{
+		this->wBitCount = 0;
+		for (UINT wX = 0; wX < this->wCols; ++wX)
+		{
+			UINT *pWord = &this->bits[wX * this->wColWords];
+			for (UINT wI = 0; wI < this->wColWords; ++wI, ++pWord)
+			{
+				if (wX < that.wCols && wI < that.wColWords)
+					*pWord &= that.bits[wX * that.wColWords + wI];
+				else
+					*pWord = 0;
+				this->wBitCount += CountBits(*pWord);
+			}
+		}
+		std::set<ROOMCOORD>::iterator iter = this->overflow.begin();
+		while (iter != this->overflow.end())
+		{
+			if (that.overflow.count(*iter))
+				++iter;
+			else
+				this->overflow.erase(iter++);
+		}
 		return *this;
 	}
 
 private:
-	CoordSet data;
+	static inline bool InBitboardRange(const UINT wX, const UINT wY)
+	{
+		return wX < MAX_BITBOARD_DIMENSION && wY < MAX_BITBOARD_DIMENSION;
+	}
+	inline bool InBitboard(const UINT wX, const UINT wY) const
+	{
+		return wX < this->wCols && wY < this->wColWords * 32;
+	}
+
+	void Fit(const UINT wX, const UINT wY)
+	//Grows the bitboard to include (wX,wY).
+	{
+		ASSERT(InBitboardRange(wX, wY));
+		if (InBitboard(wX, wY))
+			return;
+
+		const UINT wNewColWords = wY / 32 >= this->wColWords ? wY / 32 + 1 : this->wColWords;
+		const UINT wNewCols = wX >= this->wCols ? (wX | 7) + 1 : this->wCols; //a few columns at a time
+		if (wNewColWords == this->wColWords)
+		{
+			//Adding columns doesn't move the existing ones.
+			this->bits.resize(wNewCols * wNewColWords, 0);
+		} else {
+			std::vector<UINT> newBits(wNewCols * wNewColWords, 0);
+			for (UINT wCol = 0; wCol < this->wCols; ++wCol)
+				for (UINT wI = 0; wI < this->wColWords; ++wI)
+					newBits[wCol * wNewColWords + wI] = this->bits[wCol * this->wColWords + wI];
+			this->bits.swap(newBits);
+		}
+		this->wCols = wNewCols;
+		this->wColWords = wNewColWords;
+	}
+
+	bool FindNextBit(UINT wX, const UINT wY, ROOMCOORD &coord) const
+	//Finds the first coord in the bitboard at or after (wX,wY) in set order.
+	//
+	//Returns: whether there is one
+	{
+		UINT wFirstWord = wY / 32;
+		UINT mask = ~0u << (wY % 32);
+		for (; wX < this->wCols; ++wX, wFirstWord = 0, mask = ~0u)
+		{
+			const UINT *pCol = &this->bits[wX * this->wColWords];
+			for (UINT wI = wFirstWord; wI < this->wColWords; ++wI, mask = ~0u)
+			{
+				const UINT word = pCol[wI] & mask;
+				if (word)
+				{
+					coord.wX = wX;
+					coord.wY = wI * 32 + LowestBit(word);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	static inline UINT CountBits(UINT word)
+	{
+#ifdef __GNUC__
+		return __builtin_popcount(word);
+#else
+		word = word - ((word >> 1) & 0x55555555);
+		word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+		return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+	}
+
+	static inline UINT LowestBit(const UINT word)
+	//Returns: index of the lowest set bit in a non-zero word
+	{
+		ASSERT(word);
+#if defined(__GNUC__)
+		return __builtin_ctz(word);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, word);
+		return index;
+#else
+		static const BYTE deBruijnBits[32] = {
+			0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+			31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+		};
+		return deBruijnBits[((word & (0u - word)) * 0x077CB531u) >> 27];
+#endif
+	}
+
+	std::vector<UINT> bits;  //wColWords words for each of wCols columns, column by column
+	UINT wCols, wColWords;
+	UINT wBitCount;          //number of bits set
+	std::set<ROOMCOORD> overflow; //coords outside the bitboard's range
 };
 
 #endif //...#ifndef COORDSET_H
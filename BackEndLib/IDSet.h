@@ -28,6 +28,10 @@
 //IDSet.h
 //Declarations for CIDSet.
 //Class for managing a set of ID values.
+//
+//IDs are kept in a sorted vector.  Sets are mostly small, built up in order
+//and copied often, so this is more compact and quicker to copy and combine
+//than a node-based set.  Set operations are linear merges.
 
 #ifndef IDSET_H
 #define IDSET_H
@@ -35,117 +39,168 @@
 #include "Types.h"
 #include "IDList.h"
 
-#include <set>
+#include <algorithm>
+#include <iterator>
 #include <vector>
 
 class CIDSet
 {
 public:
-	typedef std::set<UINT> IDSet;
-	typedef IDSet::iterator iterator;
+	typedef std::vector<UINT> IDSet;
+	typedef IDSet::const_iterator iterator; //IDs can't be changed in place, as that could unsort them
 	typedef IDSet::const_iterator const_iterator;
 	typedef IDSet::const_reverse_iterator const_reverse_iterator;
 
 	CIDSet() {}
-	CIDSet(const CIDSet& that) {this->ids = that.ids;}
-	CIDSet(const std::vector<UINT>& idVector) {
-		const size_t size = idVector.size();
-		for (UINT i=0; i<size; ++i)
-			this->ids.insert(idVector[i]);
+	CIDSet(const CIDSet& that) : ids(that.ids) {}
+	CIDSet(const std::vector<UINT>& idVector) : ids(idVector) {
+		std::sort(this->ids.begin(), this->ids.end());
+		this->ids.erase(std::unique(this->ids.begin(), this->ids.end()), this->ids.end());
 	}
-	CIDSet(const UINT dwID) {this->ids.insert(dwID);}
+	CIDSet(const UINT dwID) : ids(1, dwID) {}
 
 	inline bool  empty() const {return this->ids.empty();}
-	inline bool  has(const UINT dwID) const {return this->ids.count(dwID) != 0;}
+	inline bool  has(const UINT dwID) const {
+		return std::binary_search(this->ids.begin(), this->ids.end(), dwID);
+	}
 	inline UINT  size() const {return this->ids.size();}
 
 	inline void  clear() {this->ids.clear();}
-	inline int   erase(const UINT dwID) {return this->ids.erase(dwID);}
-	inline iterator erase(const iterator iter) {
-#if defined _MSC_VER
-		return this->ids.erase(iter);
-#else
-		iterator newiter=iter;
-		++newiter;
+	inline int   erase(const UINT dwID) {
+		IDSet::iterator iter = std::lower_bound(this->ids.begin(), this->ids.end(), dwID);
+		if (iter == this->ids.end() || *iter != dwID)
+			return 0;
 		this->ids.erase(iter);
-		return newiter;
-#endif
+		return 1;
+	}
+	inline iterator erase(const iterator iter) {
+		//Returns the iterator following the erased ID.
+		const size_t index = iter - this->ids.begin();
+		this->ids.erase(this->ids.begin() + index);
+		return this->ids.begin() + index;
 	}
 
 	bool operator == (const CIDSet &Src) const {return this->ids == Src.ids;}
 	bool operator != (const CIDSet &Src) const {return this->ids != Src.ids;}
 	CIDSet& operator = (const CIDSet &Src) {
-		clear();
-		return operator+=(Src);
+		this->ids = Src.ids;
+		return *this;
 	}
 	CIDSet& operator += (const UINT dwID) {
-		this->ids.insert(dwID);
+		if (this->ids.empty() || dwID > this->ids.back())
+		{
+			//IDs are most often added in ascending order.
+			this->ids.push_back(dwID);
+		} else {
+			IDSet::iterator iter = std::lower_bound(this->ids.begin(), this->ids.end(), dwID);
+			if (*iter != dwID)
+				this->ids.insert(iter, dwID);
+		}
 		return *this;
 	}
 	CIDSet& operator += (const CIDSet &Src) {
-		for (const_iterator iter = Src.begin(); iter != Src.end(); ++iter)
-			this->ids.insert(*iter);
+		if (Src.ids.empty() || &Src == this)
+			return *this;
+		if (this->ids.empty() || Src.ids.front() > this->ids.back())
+		{
+			this->ids.insert(this->ids.end(), Src.ids.begin(), Src.ids.end());
+		} else {
+			IDSet merged;
+			merged.reserve(this->ids.size() + Src.ids.size());
+			std::set_union(this->ids.begin(), this->ids.end(),
+					Src.ids.begin(), Src.ids.end(), std::back_inserter(merged));
+			this->ids.swap(merged);
+		}
 		return *this;
 	}
 	CIDSet& operator += (const CIDList &Src) {
+		std::vector<UINT> listIDs;
 		IDNODE *pNode = Src.Get(0);
 		while (pNode)
 		{
-			this->ids.insert(pNode->dwID);
+			listIDs.push_back(pNode->dwID);
 			pNode = pNode->pNext;
 		}
-		return *this;
+		return operator+=(CIDSet(listIDs));
 	}
 	CIDSet& operator -= (const UINT dwID) {
-		this->ids.erase(dwID);
+		erase(dwID);
 		return *this;
 	}
 	CIDSet& operator -= (const CIDSet &Src) {
-		for (const_iterator iter = Src.begin(); iter != Src.end(); ++iter)
-			this->ids.erase(*iter);
+		if (&Src == this)
+		{
+			clear();
+			return *this;
+		}
+		//Compact the IDs not in Src to the front.
+		IDSet::iterator write = this->ids.begin();
+		const_iterator other = Src.ids.begin();
+		for (IDSet::iterator read = this->ids.begin(); read != this->ids.end(); ++read)
+		{
+			while (other != Src.ids.end() && *other < *read)
+				++other;
+			if (other == Src.ids.end() || *other != *read)
+				*write++ = *read;
+		}
+		this->ids.erase(write, this->ids.end());
 		return *this;
 	}
 
 	//Removes IDs from this set that aren't members of Filter.
 	void intersect(const CIDSet &Filter)
 	{
-		std::set<UINT> filteredIDs;
-		for (const_iterator iter = Filter.begin(); iter != Filter.end(); ++iter)
-			if (has(*iter))
-				filteredIDs.insert(*iter);
-		this->ids = filteredIDs;
+		if (&Filter == this)
+			return;
+		IDSet::iterator write = this->ids.begin();
+		const_iterator other = Filter.ids.begin();
+		for (IDSet::iterator read = this->ids.begin(); read != this->ids.end(); ++read)
+		{
+			while (other != Filter.ids.end() && *other < *read)
+				++other;
+			if (other == Filter.ids.end())
+				break;
+			if (*other == *read)
+				*write++ = *read;
+		}
+		this->ids.erase(write, this->ids.end());
 	}
 
 	//Does this set contain all IDs that a second set has.
 	bool contains(const CIDSet &against) const
 	{
-		for (const_iterator iter = against.begin(); iter != against.end(); ++iter)
-			if (!has(*iter))
-				return false;
-		return true;
+		if (against.size() > size())
+			return false;
+		return std::includes(this->ids.begin(), this->ids.end(),
+				against.ids.begin(), against.ids.end());
 	}
 	//Does this set contain any IDs that a second set has.
 	bool containsAny(const CIDSet &against) const
 	{
-		for (const_iterator iter = against.begin(); iter != against.end(); ++iter)
-			if (has(*iter))
+		const_iterator iter = this->ids.begin(), other = against.ids.begin();
+		while (iter != this->ids.end() && other != against.ids.end())
+		{
+			if (*iter < *other)
+				++iter;
+			else if (*other < *iter)
+				++other;
+			else
 				return true;
+		}
 		return false;
 	}
 
-	inline iterator begin() {return this->ids.begin();}
 	inline const_iterator begin() const {return this->ids.begin();}
-	inline iterator end() {return this->ids.end();}
 	inline const_iterator end() const {return this->ids.end();}
 	inline const_reverse_iterator rbegin() const {return this->ids.rbegin();}
 	inline const_reverse_iterator rend() const {return this->ids.rend();}
 
-	inline UINT getFirst() const {return size() ? *begin() : 0;}
-	inline UINT getLast() const {return size() ? *rbegin() : 0;}
-	inline UINT getMax() const {return size() ? *(this->ids.rbegin()) : 0;}
+	inline UINT getFirst() const {return size() ? this->ids.front() : 0;}
+	inline UINT getLast() const {return size() ? this->ids.back() : 0;}
+	inline UINT getMax() const {return size() ? this->ids.back() : 0;}
 
 private:
-	std::set<UINT> ids;
+	IDSet ids; //sorted, without duplicates
 };
 
 #endif //...#ifndef IDSET_H
@@ -27,7 +27,7 @@
 #include "EvilEyeGazeEffect.h"
 #include "RoomWidget.h"
 #include "DrodBitmapManager.h"
-#include "../DRODLib/EvilEye.h"
+#include "../DRODLib/DbRooms.h"
 #include "../DRODLib/GameConstants.h"
 #include <BackEndLib/Assert.h>
 
@@ -109,12 +109,12 @@ void CEvilEyeGazeEffect::UpdateOpacity(const Uint32& dwTimeElapsed)
 void CEvilEyeGazeEffect::DrawNewBeam()
 {
 	static SDL_Rect Dest = MAKE_SDL_RECT(0, 0, CDrodBitmapManager::CX_TILE, CDrodBitmapManager::CY_TILE);
-	UINT cx = this->wX, cy = this->wY;
-	int nDx = this->dx, nDy = this->dy;
-	bool bReflected = false;
+	const EYEGAZE& gaze = this->pRoomWidget->GetRoom()->GetEvilEyeGaze(
+			this->wX, this->wY, nGetO(this->dx, this->dy));
 	CCoordSet newGazeTiles;
-	while (CEvilEye::GetNextGaze(this->pRoomWidget->GetRoom(), cx, cy, nDx, nDy, bReflected))
+	for (UINT wIndex = 0; wIndex < gaze.wOpenSquares; ++wIndex)
 	{
+		const UINT cx = gaze.squares[wIndex].wX, cy = gaze.squares[wIndex].wY;
 		const int destX = this->pRoomWidget->GetX() + cx * CBitmapManager::CX_TILE;
 		const int destY = this->pRoomWidget->GetY() + cy * CBitmapManager::CY_TILE;
 		if (!this->gazeTiles.has(cx, cy))
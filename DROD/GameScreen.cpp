@@ -1317,6 +1317,15 @@ void CGameScreen::OnBetweenEvents()
 				}
 			}
 		}
+
+		//Load a neighboring room once the player has been idle for a while and
+		//nothing is being animated, so walking into it later is quick.
+		static const UINT prefetchIdleTime = 750; //ms
+		if (SDL_GetTicks() - GetTimeOfLastUserInput() >= prefetchIdleTime &&
+				!this->pRoomWidget->IsMoveAnimating() &&
+				!(this->pMoveQueueWidget && this->pMoveQueueWidget->IsAutoExecuting()) &&
+				!this->bIsDialogDisplayed && !this->bNeedToProcessDelayedQuestions)
+			this->pCurrentGame->PrefetchAdjacentRoom();
 	}
 
 	CRoomScreen::OnBetweenEvents();
@@ -32,11 +32,20 @@
 #include "CueEvents.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //
 //Public methods.
 //
 
+//*****************************************************************************************
+ULONGLONG CAumtlich::GetStateHash() const
+//Returns: a hash of this monster's game state, including whether it is frozen
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState, 0, 0,
+			0x03000000 | (this->bFrozen ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CAumtlich::Process(
 //Process a Aumtlich for movement.
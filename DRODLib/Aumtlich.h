@@ -43,6 +43,7 @@ public:
 		, bFrozen(false) {}
 	IMPLEMENT_CLONE_REPLICATE(CMonster, CAumtlich);
 	
+	virtual ULONGLONG GetStateHash() const;
 	virtual void Process(const int nLastCommand, CCueEvents &CueEvents);
 
 	static  bool GetNextGaze(CCueEvents &CueEvents, CAumtlich *pAumtlich, CDbRoom *pRoom,
@@ -48,11 +48,17 @@ How is briar processed:
  5. And process pressure plate pressing and depressing
 
 Damaged in SPECIFIC WAY:
- When a briar that belongs to a component (has briar root) is damaged then a flag is set that forces the briar data regeneration
+ When a briar that belongs to a component (has briar root) is damaged then the component is marked as changed and a flag is set that forces the briar data regeneration.
+ Removing a root also marks its component as changed, but doesn't set the flag.
 
 RECALCULATE ALL:
- 1. All briar data, except roots info, is prunned.
- 2. Then for every root its component is rebuilt
+ 1. All briar data of changed components, except roots info, is prunned. Other components are already as they would be rebuilt, so they are left alone.
+ 2. Then for every root of a changed component its component is rebuilt
+
+FRONTIER:
+ Expanding only does anything from briar tiles that aren't surrounded by briar of their own component, so each component also keeps a set of its other tiles (briarFrontier).
+ A tile is dropped from the frontier once it is found surrounded, and put back when anything is plotted beside it.
+ This keeps the cost of expanding proportional to the outside of a component rather than its area.
 
 EXPANSION RULES:
  1. Grow into all 8 directions
@@ -69,6 +75,7 @@ EXPANSION RULES:
 #include "GameConstants.h"
 #include "MonsterPiece.h"
 #include "RockGiant.h"
+#include "StateHash.h"
 #include "TileConstants.h"
 #include <BackEndLib/Assert.h>
 
@@ -122,6 +129,7 @@ bool CBriar::process()
 	room.Plot(wClosestX,wClosestY,T_BRIAR_DEAD);
 	edge.erase(wClosestX, wClosestY);
 	this->pBriars->briarComponents[this->wComponentIndex-1].insert(wClosestX, wClosestY);
+	this->pBriars->briarFrontier[this->wComponentIndex-1].insert(wClosestX, wClosestY);
 
 	this->bDone = true;
 	return false;
@@ -135,6 +143,7 @@ bool CBriar::process()
 CBriars::CBriars()
 	: pRoom(NULL)
 	, bRecalc(false)
+	, bSplit(false)
 	, bIsProcessing(false)
 {
 }
@@ -157,10 +166,12 @@ void CBriars::clear()
 
 	this->briarComponents.clear();
 	this->briarEdge.clear();
+	this->briarFrontier.clear();
 	this->briarIndices.Clear();
 	this->connectedBriars.clear();
 	this->pressurePlates.clear();
-	this->bRecalc = false;
+	this->changedComponents.clear();
+	this->bRecalc = this->bSplit = false;
 }
 
 //*****************************************************************************
@@ -187,9 +198,12 @@ void CBriars::setMembersForRoom(const CBriars& src, CDbRoom* pRoom)
 	this->briarIndices = src.briarIndices;
 	this->briarComponents = src.briarComponents;
 	this->briarEdge = src.briarEdge;
+	this->briarFrontier = src.briarFrontier;
 	this->connectedBriars = src.connectedBriars;
 	this->pressurePlates = src.pressurePlates;
+	this->changedComponents = src.changedComponents;
 	this->bRecalc = src.bRecalc;
+	this->bSplit = src.bSplit;
 }
 
 //*****************************************************************************
@@ -219,12 +233,20 @@ void CBriars::expand(
 	ASSERT(pCurrentGame);
 
 	//Expand each tile of the briar, if possible, according to the rules below.
+	//Tiles off the frontier are surrounded by this briar and can't expand.
 	CCoordSet& briar = this->briarComponents[wIndex-1];
-	CCoordSet *pBriar = &(this->briarComponents[wIndex-1]);
+	CCoordSet& frontier = this->briarFrontier[wIndex-1];
+	CCoordSet *pBriar = &frontier;
 	CCoordSet addedEdge, addedBriar, oldAddedBriar; //joining to stagnant briar tiles
 	do {
 		for (CCoordSet::const_iterator tile=pBriar->begin(); tile!=pBriar->end(); ++tile)
 		{
+			if (pBriar == &frontier && isSurrounded(tile->wX, tile->wY, wIndex))
+			{
+				frontier.erase(tile->wX, tile->wY);
+				continue;
+			}
+
 			//Expand from one tile to adjacent tiles.
 			bool bAdjacentPit = false, bBlocked;
 			const UINT wSrcTile = this->pRoom->GetTSquare(tile->wX,tile->wY);
@@ -425,6 +447,7 @@ void CBriars::expand(
 		edge += addedEdge;
 		addedEdge.clear();
 		briar += addedBriar;
+		frontier += addedBriar;
 		oldAddedBriar = addedBriar;
 		addedBriar.clear();
 		pBriar = &oldAddedBriar;
@@ -478,6 +501,24 @@ UINT CBriars::getNumSourcesWithIndex(const UINT index) const
 	return count;
 }
 
+//*****************************************************************************
+ULONGLONG CBriars::getStateHash() const
+//Returns: a hash of the briar roots' turn state.
+//Briar tiles themselves are covered by the room's tile hash.
+{
+	ULONGLONG hash = 0;
+	for (list<CBriar*>::const_iterator briar = this->briars.begin(); briar != this->briars.end(); ++briar)
+	{
+		const CBriar& source = **briar;
+		hash ^= StateHash::Key(StateHash::RoomState, (source.wY << 16) | source.wX,
+				source.bStuck ? 1 : 0, 1);
+	}
+	for (CCoordSet::const_iterator root = this->pendingRootRemovals.begin();
+			root != this->pendingRootRemovals.end(); ++root)
+		hash ^= StateHash::Key(StateHash::RoomState, (root->wY << 16) | root->wX, 0, 2);
+	return hash;
+}
+
 //*****************************************************************************
 void CBriars::initLiveTiles()
 {
@@ -518,6 +559,7 @@ void CBriars::initLiveTiles()
 		ASSERT(briar.wComponentIndex > 0);
 		this->briarEdge[briar.wComponentIndex-1] = edges;
 		this->briarComponents[briar.wComponentIndex-1] += dead;
+		this->briarFrontier[briar.wComponentIndex-1] += dead;
 	}
 }
 
@@ -533,6 +575,7 @@ void CBriars::insert(const UINT wX, const UINT wY, bool bConstructed)
 	//Each briar root starts with its own separate connected component of briar tiles.
 	this->briarComponents.push_back(CCoordSet(wX, wY));
 	this->briarEdge.push_back(CCoordSet());
+	this->briarFrontier.push_back(CCoordSet(wX, wY));
 	const UINT wIndex = this->briarComponents.size();
 	this->briarIndices.Add(wX, wY, wIndex);
 
@@ -580,7 +623,57 @@ void CBriars::insert(const UINT wX, const UINT wY, bool bConstructed)
 			this->briarEdge[wIndex - 1] += this->briarEdge[wAdjIndex - 1];
 			this->briarEdge[wAdjIndex - 1].clear();
 		}
+		this->briarFrontier[wIndex-1] += this->briarFrontier[wAdjIndex-1];
+		this->briarFrontier[wAdjIndex-1].clear();
+		if (this->changedComponents.erase(wAdjIndex))
+			this->changedComponents.insert(wIndex);
+	}
+}
+
+//*****************************************************************************
+bool CBriars::isSurrounded(
+//Returns: whether briar of the same component is all around (x,y) with no
+//holes under it, so expanding from (x,y) can't do anything
+//
+//Params:
+	const UINT wX, const UINT wY, //(in) briar tile
+	const UINT wIndex)            //(in) its component
+const
+{
+	for (UINT i=0; i<NUM_NEIGHBORS; ++i)
+	{
+		const UINT wAdjX = wX + nOX[i], wAdjY = wY + nOY[i];
+		if (!this->pRoom->IsValidColRow(wAdjX,wAdjY))
+			continue;
+		if (!bIsBriar(this->pRoom->GetTSquare(wAdjX,wAdjY)) ||
+				this->briarIndices.GetAt(wAdjX,wAdjY) != wIndex)
+			return false;
+		switch (this->pRoom->GetOSquare(wAdjX,wAdjY))
+		{
+			case T_PIT: case T_PIT_IMAGE: return false;
+			default: break;
+		}
 	}
+	return true;
+}
+
+//*****************************************************************************
+void CBriars::markFrontierNear(const UINT wX, const UINT wY)
+//Puts component tiles at and around (x,y) back on their component's frontier.
+{
+	if (this->briarComponents.empty())
+		return;
+
+	for (int nY = -1; nY <= 1; ++nY)
+		for (int nX = -1; nX <= 1; ++nX)
+		{
+			const UINT wAdjX = wX + nX, wAdjY = wY + nY;
+			if (!this->pRoom->IsValidColRow(wAdjX,wAdjY))
+				continue;
+			const UINT wIndex = getIndexAt(wAdjX,wAdjY);
+			if (wIndex && this->briarComponents[wIndex-1].has(wAdjX,wAdjY))
+				this->briarFrontier[wIndex-1].insert(wAdjX,wAdjY);
+		}
 }
 
 //*****************************************************************************
@@ -595,28 +688,34 @@ void CBriars::plotted(const UINT wX, const UINT wY, const UINT wTileNo)
 	for (briar = this->briars.begin(); briar != this->briars.end(); ++briar)
 		(*briar)->bStuck = false;
 
+	//Briar beside here might be able to expand again.
+	markFrontierNear(wX,wY);
+
 	//If a door closes here or the t-layer is modified (i.e. briar is overwritten),
 	//synch data structures for any briar that used to be here.
 	if (!bIsDoor(wTileNo) && TILE_LAYER[wTileNo] != 1) //t-layer plots affect briars
 		return;
 
-	vector<CCoordSet>::iterator tiles;
-	for (tiles = this->briarComponents.begin();
-			tiles != this->briarComponents.end(); ++tiles)
-		if (tiles->has(wX,wY))
+	UINT wIndex;
+	for (wIndex = this->briarComponents.size(); wIndex--; )
+		if (this->briarComponents[wIndex].has(wX,wY))
 		{
-			this->bRecalc = true; //when non-edge briar is cut, connected components must be recalced
+			//when non-edge briar is cut, its connected component must be recalced
+			this->changedComponents.insert(wIndex+1);
+			this->bSplit = true;
 
-			tiles->erase(wX,wY);
+			this->briarComponents[wIndex].erase(wX,wY);
+			this->briarFrontier[wIndex].erase(wX,wY);
 			this->briarIndices.Remove(wX,wY);
 		}
-	for (tiles = this->briarEdge.begin();
-			tiles != this->briarEdge.end(); ++tiles)
-		if (tiles->has(wX,wY))
+	for (wIndex = this->briarEdge.size(); wIndex--; )
+		if (this->briarEdge[wIndex].has(wX,wY))
 		{
-			this->bRecalc = true; //in some specific situations, two roots may have been connected only by an edge tile 
+			//in some specific situations, two roots may have been connected only by an edge tile
+			this->changedComponents.insert(wIndex+1);
+			this->bSplit = true;
 
-			tiles->erase(wX,wY);
+			this->briarEdge[wIndex].erase(wX,wY);
 			this->briarIndices.Remove(wX,wY);
 		}
 
@@ -645,81 +744,10 @@ void CBriars::process(
 	for (briar = this->briars.begin(); briar != this->briars.end(); ++briar)
 		(*briar)->bDone = false; //briar has not filled in a tile yet
 
-	if (this->bRecalc) //need to recompute connected components
+	if (this->bRecalc || this->bSplit) //need to recompute connected components
 	{
-		this->bRecalc = false;
-
-		//Determine which briar tiles are still connected to briar roots.
-		static CTileMask briarMask;
-		if (briarMask.empty())
-		{
-			briarMask.set(T_BRIAR_SOURCE);
-			briarMask.set(T_BRIAR_DEAD);
-			briarMask.set(T_BRIAR_LIVE);
-		}
-
-		//Keep old connected component info for reference while restructuring below.
-		CCoordIndex_T<USHORT> oldBriarIndices = this->briarIndices;
-		std::vector<CCoordSet> oldBriarComponents = this->briarComponents;
-		std::vector<CCoordSet> oldBriarEdges = this->briarEdge;
-
-		this->briarComponents.clear();
-		this->briarEdge.clear();
-		this->briarIndices.Clear();
-
-		//Recalculate each root's connected component.
-		CCoordSet preBriarComponent;
-		for (briar = this->briars.begin(); briar != this->briars.end(); ++briar)
-		{
-			CBriar *pBriar = *briar;
-			CBriar& briarObj = *pBriar;
-
-			//Is this root a part of a connected briar component just recalculated?
-			if (this->briarIndices.Exists(briarObj.wX, briarObj.wY))
-			{
-				//This briar root's connected component has already been
-				//calculated and is found joined to at least one other root.
-				briarObj.wComponentIndex = this->briarIndices.GetAt(briarObj.wX, briarObj.wY);
-				continue; //Nothing more needs to be done for it.
-			}
-
-			//Calculate this briar root's connected component.
-			const USHORT oldIndex = oldBriarIndices.GetAt(briarObj.wX, briarObj.wY);
-			CCoordSet oldBriarCoords = oldBriarComponents[oldIndex - 1];
-			oldBriarCoords += oldBriarEdges[oldIndex - 1];
-
-			briarObj.wComponentIndex = this->briarComponents.size()+1;
-			this->pRoom->GetConnected8NeighborTiles(briarObj.wX, briarObj.wY, briarMask, preBriarComponent, NULL, &oldBriarCoords);
-
-			//Sort tiles into filled and edge tiles.
-			CCoordSet edges, briarComponent;
-			
-			for (CCoordSet::const_iterator tile=preBriarComponent.begin(); tile!=preBriarComponent.end(); ++tile)
-			{
-				//Only tiles that were part of this root's component before
-				//recalculation should be included.  That is, no adjacent pieces
-				//not belonging to this component already should be attached now.
-				if (oldBriarIndices.GetAt(tile->wX, tile->wY) == oldIndex)
-				{
-					//Readd this tile to the connected component.
-					this->briarIndices.Add(tile->wX, tile->wY, briarObj.wComponentIndex);
-					briarComponent.insert(tile->wX, tile->wY);
-					if (this->pRoom->GetTSquare(tile->wX, tile->wY) == T_BRIAR_LIVE)
-						edges.insert(tile->wX, tile->wY);
-				}
-			}
-
-			//This is the current state of this briar root's connected component.
-			this->briarEdge.push_back(edges);
-
-			//Before we subtract edges from briarComponent, we need to remove
-			//all previous components from the coord set.
-			if (oldIndex)
-				edges -= oldBriarComponents[oldIndex-1];
-			briarComponent -= edges;
-
-			this->briarComponents.push_back(briarComponent);
-		}
+		recalc(this->bRecalc);
+		this->bRecalc = this->bSplit = false;
 	}
 
 	//Process all briar roots together in three synchronous steps.
@@ -772,6 +800,10 @@ void CBriars::process(
 			this->briarComponents[wIndex2-1].clear();
 			this->briarEdge[wIndex1-1] += this->briarEdge[wIndex2-1];
 			this->briarEdge[wIndex2-1].clear();
+			this->briarFrontier[wIndex1-1] += this->briarFrontier[wIndex2-1];
+			this->briarFrontier[wIndex2-1].clear();
+			if (this->changedComponents.erase(wIndex2))
+				this->changedComponents.insert(wIndex1);
 			this->briarIndices.Replace(wIndex2, wIndex1);
 			for (briar = this->briars.begin(); briar != this->briars.end(); ++briar)
 			{
@@ -820,6 +852,142 @@ void CBriars::process(
 
 }
 
+//*****************************************************************************
+void CBriars::recalc(
+//Recomputes which briar tiles are still connected to each root.
+//
+//Params:
+	const bool bAll) //(in) recompute every component, or only those that changed
+{
+	//Determine which briar tiles are still connected to briar roots.
+	CTileMask briarMask(T_BRIAR_SOURCE);
+	briarMask.set(T_BRIAR_DEAD);
+	briarMask.set(T_BRIAR_LIVE);
+
+	const UINT wOldCount = this->briarComponents.size();
+	std::set<UINT> changed;
+	if (bAll)
+	{
+		for (UINT wIndex = 1; wIndex <= wOldCount; ++wIndex)
+			changed.insert(wIndex);
+	} else {
+		changed.swap(this->changedComponents);
+	}
+	this->changedComponents.clear();
+
+	//Which component each root belonged to.
+	std::vector<UINT> oldRootIndices;
+	list<CBriar*>::const_iterator briar;
+	for (briar = this->briars.begin(); briar != this->briars.end(); ++briar)
+		oldRootIndices.push_back(getIndexAt((*briar)->wX, (*briar)->wY));
+
+	//Keep old connected component info for reference while restructuring below.
+	std::vector<CCoordSet> oldBriarComponents(wOldCount), oldBriarCoords(wOldCount), oldIndexed(wOldCount);
+	std::set<UINT>::const_iterator index;
+	for (index = changed.begin(); index != changed.end(); ++index)
+	{
+		const UINT wIndex = *index;
+		oldBriarComponents[wIndex-1] = this->briarComponents[wIndex-1];
+		oldBriarCoords[wIndex-1] = oldBriarComponents[wIndex-1];
+		oldBriarCoords[wIndex-1] += this->briarEdge[wIndex-1];
+		this->briarComponents[wIndex-1].clear();
+		this->briarEdge[wIndex-1].clear();
+		this->briarFrontier[wIndex-1].clear();
+
+		const CCoordSet& coords = oldBriarCoords[wIndex-1];
+		for (CCoordSet::const_iterator tile=coords.begin(); tile!=coords.end(); ++tile)
+			if (this->briarIndices.GetAt(tile->wX, tile->wY) == wIndex)
+			{
+				oldIndexed[wIndex-1].insert(tile->wX, tile->wY);
+				this->briarIndices.Remove(tile->wX, tile->wY);
+			}
+	}
+	if (bAll)
+		this->briarIndices.Clear();
+
+	//Recomputed components take the lowest free indices.
+	std::set<UINT> freeIndices;
+	UINT wIndex;
+	for (wIndex = 1; wIndex <= wOldCount; ++wIndex)
+		if (this->briarComponents[wIndex-1].empty() && this->briarEdge[wIndex-1].empty())
+			freeIndices.insert(wIndex);
+	UINT wRoot = 0;
+	for (briar = this->briars.begin(); briar != this->briars.end(); ++briar, ++wRoot)
+		if (!changed.count(oldRootIndices[wRoot]))
+			freeIndices.erase((*briar)->wComponentIndex);
+
+	//Recalculate the connected component of each root of a changed component.
+	CCoordSet preBriarComponent;
+	wRoot = 0;
+	for (briar = this->briars.begin(); briar != this->briars.end(); ++briar, ++wRoot)
+	{
+		CBriar& briarObj = **briar;
+		const UINT oldIndex = oldRootIndices[wRoot];
+		ASSERT(oldIndex);
+		if (!changed.count(oldIndex))
+			continue; //this component is unaffected
+
+		//Is this root a part of a connected briar component just recalculated?
+		if (this->briarIndices.Exists(briarObj.wX, briarObj.wY))
+		{
+			//This briar root's connected component has already been
+			//calculated and is found joined to at least one other root.
+			briarObj.wComponentIndex = this->briarIndices.GetAt(briarObj.wX, briarObj.wY);
+			continue; //Nothing more needs to be done for it.
+		}
+
+		//Calculate this briar root's connected component.
+		if (freeIndices.empty())
+		{
+			this->briarComponents.push_back(CCoordSet());
+			this->briarEdge.push_back(CCoordSet());
+			this->briarFrontier.push_back(CCoordSet());
+			briarObj.wComponentIndex = this->briarComponents.size();
+		} else {
+			briarObj.wComponentIndex = *freeIndices.begin();
+			freeIndices.erase(freeIndices.begin());
+		}
+		this->pRoom->GetConnected8NeighborTiles(briarObj.wX, briarObj.wY, briarMask,
+				preBriarComponent, NULL, &oldBriarCoords[oldIndex-1]);
+
+		//Sort tiles into filled and edge tiles.
+		CCoordSet edges, briarComponent;
+		for (CCoordSet::const_iterator tile=preBriarComponent.begin(); tile!=preBriarComponent.end(); ++tile)
+		{
+			//Only tiles that were part of this root's component before
+			//recalculation should be included.  That is, no adjacent pieces
+			//not belonging to this component already should be attached now.
+			if (oldIndexed[oldIndex-1].has(tile->wX, tile->wY))
+			{
+				//Readd this tile to the connected component.
+				this->briarIndices.Add(tile->wX, tile->wY, briarObj.wComponentIndex);
+				briarComponent.insert(tile->wX, tile->wY);
+				if (this->pRoom->GetTSquare(tile->wX, tile->wY) == T_BRIAR_LIVE)
+					edges.insert(tile->wX, tile->wY);
+			}
+		}
+
+		//This is the current state of this briar root's connected component.
+		this->briarEdge[briarObj.wComponentIndex-1] = edges;
+
+		//Before we subtract edges from briarComponent, we need to remove
+		//all previous components from the coord set.
+		edges -= oldBriarComponents[oldIndex-1];
+		briarComponent -= edges;
+
+		this->briarComponents[briarObj.wComponentIndex-1] = briarComponent;
+		this->briarFrontier[briarObj.wComponentIndex-1] = briarComponent;
+	}
+
+	//Drop trailing components no root uses.
+	for (wIndex = this->briarComponents.size(); wIndex && freeIndices.count(wIndex); --wIndex)
+	{
+		this->briarComponents.pop_back();
+		this->briarEdge.pop_back();
+		this->briarFrontier.pop_back();
+	}
+}
+
 //*****************************************************************************
 void CBriars::removeSource(const UINT wX, const UINT wY)
 //Removes briar root at (x,y).
@@ -840,7 +1008,13 @@ void CBriars::removeSource(const UINT wX, const UINT wY)
 		{
 			delete pBriar;
 			this->briars.erase(briar);
+
+			//The component must be recalced without this root the next time any is.
+			const UINT wIndex = getIndexAt(wX,wY);
+			if (wIndex)
+				this->changedComponents.insert(wIndex);
 			this->briarIndices.Remove(wX,wY);
+			markFrontierNear(wX,wY);
 			return;
 		}
 	}
@@ -32,6 +32,7 @@
 #include <BackEndLib/CoordStack.h>
 #include "CueEvents.h"
 #include <list>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -72,6 +73,7 @@ public:
 	const CCoordSet& getEdgeTilesFor(const UINT wX, const UINT wY) const;
 	UINT getIndexAt(const UINT wX, const UINT wY) const;
 	UINT getNumSourcesWithIndex(const UINT index) const;
+	ULONGLONG getStateHash() const;
 	void initLiveTiles();
 	void insert(const UINT wX, const UINT wY, bool bConstructed = false);
 	void plotted(const UINT wX, const UINT wY, const UINT wTileNo);
@@ -83,6 +85,9 @@ public:
 private:
 	void expand(CCueEvents &CueEvents, const UINT wIndex, CCoordSet &killedPuffs,
 			CCoordStack &powder_kegs);
+	bool isSurrounded(const UINT wX, const UINT wY, const UINT wIndex) const;
+	void markFrontierNear(const UINT wX, const UINT wY);
+	void recalc(const bool bAll);
 
 	friend class CBriar;
 	CDbRoom     *pRoom;
@@ -90,12 +95,15 @@ private:
 	CCoordIndex_T<USHORT>  briarIndices;    //quick access to which component is at what tile
 	std::vector<CCoordSet> briarComponents; //connected components
 	std::vector<CCoordSet> briarEdge;       //connected components
+	std::vector<CCoordSet> briarFrontier;   //component tiles that aren't surrounded by their own component
 	std::vector<CoordPair> connectedBriars; //tile pairs where two components connect
 	
 	CCoordSet pressurePlates;  //set of pressure plate tiles depressed on a turn
 	CCoordSet pendingRootRemovals;  //Brair roots that are pending removal
 
-	bool      bRecalc;         //indicates components must be reconstructed
+	std::set<UINT> changedComponents; //components that lost tiles or roots since they were computed
+	bool      bRecalc;         //indicates all components must be reconstructed
+	bool      bSplit;          //indicates changed components must be reconstructed
 	bool      bIsProcessing;   // Whether currently in the middle of briar processing
 };
 
@@ -34,18 +34,21 @@ const UINT NUM_NEIGHBORS = 4;
 const int dx[NUM_NEIGHBORS] = {0,1,0,-1};
 const int dy[NUM_NEIGHBORS] = {-1,0,1,0};
 
-CTileMask CBridge::bridgeMask;
+//*****************************************************************************
+static CTileMask GetBridgeMask()
+{
+	CTileMask mask(T_BRIDGE);
+	mask.set(T_BRIDGE_H);
+	mask.set(T_BRIDGE_V);
+	return mask;
+}
+
+const CTileMask CBridge::bridgeMask = GetBridgeMask();
 
 //*****************************************************************************
 CBridge::CBridge()
 	: pRoom(NULL)
 {
-	if (CBridge::bridgeMask.empty())
-	{
-		CBridge::bridgeMask.set(T_BRIDGE);
-		CBridge::bridgeMask.set(T_BRIDGE_H);
-		CBridge::bridgeMask.set(T_BRIDGE_V);
-	}
 }
 
 //*****************************************************************************
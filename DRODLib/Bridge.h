@@ -84,7 +84,7 @@ private:
 	CCoordSet ignoredTiles; // Used to avoid recalculating the same bridge over and over again while calling HandleBridgeAdded repeatedly
 	vector<UINT> droppingBridges; // Vector of bridge component indexes which are meant to fall
 
-	static CTileMask bridgeMask;
+	static const CTileMask bridgeMask;
 };
 
 #endif //...#ifndef BRIDGE_H
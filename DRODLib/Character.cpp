@@ -35,6 +35,8 @@
 #include "Serpent.h"
 #include "RockGiant.h"
 #include "RockGolem.h"
+#include "ScriptExpression.h"
+#include "StateHash.h"
 #include "../Texts/MIDs.h"
 
 #include <BackEndLib/Base64.h>
@@ -878,210 +880,17 @@ int CCharacter::parseExpression(
 //
 // factor = var | number | "(" expression ")"
 //
+//Expressions in script commands are compiled once by
+//CCharacterCommand::GetExpression instead.
+//
 //Params:
 	const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC, //[default=NULL]
 	const bool bExpectCloseParen) //[default=false] whether a close paren should mark the end of this (nested) expression
 {
 	ASSERT(pwStr);
 	ASSERT(pGame);
-	SKIP_WHITESPACE(pwStr, index);
-
-	bool bAdd = true; //otherwise subtract
-	if (pwStr[index] == W_t('+'))
-		++index;
-	else if (pwStr[index] == W_t('-'))
-	{
-		bAdd = false;
-		++index;
-	}
-
-	const int term = parseTerm(pwStr, index, pGame, pNPC);
-	int val = (bAdd ? term : -term);
-
-	SKIP_WHITESPACE(pwStr, index);
-	while (pwStr[index]!=0)
-	{
-		//Parse another term.
-		if (pwStr[index] == W_t('+'))
-		{
-			bAdd = true;
-			++index;
-		}
-		else if (pwStr[index] == W_t('-'))
-		{
-			bAdd = false;
-			++index;
-		}
-		else if (bExpectCloseParen && pwStr[index] == W_t(')')) //closing nested expression
-			return val; //caller will parse the close paren
-		else
-		{
-			//parse error -- return the current value
-			CFiles f;
-			string str = UnicodeToUTF8(pwStr + index);
-			str += ": Parse error (bad symbol)";
-			f.AppendErrorLog(str.c_str());
-			return val;
-		}
-
-		const int term = parseTerm(pwStr, index, pGame, pNPC);
-		val += (bAdd ? term : -term);
-	}
-
-	return val;
-}
-
-//*****************************************************************************
-int CCharacter::parseTerm(const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC)
-//Parse and evaluate a term in an expression.
-{
-	int val = parseFactor(pwStr, index, pGame, pNPC);
-
-	while (pwStr[index]!=0)
-	{
-		//Parse another term.
-		SKIP_WHITESPACE(pwStr, index);
-
-		bool bMultiply;
-		bool bMod = false;
-		if (pwStr[index] == W_t('*'))
-		{
-			bMultiply = true;
-			++index;
-		}
-		else if (pwStr[index] == W_t('/'))
-		{
-			bMultiply = false;
-			++index;
-		}
-		else if (pwStr[index] == W_t('%'))
-		{
-			bMod = true;
-			++index;
-		} else {
-			//no more factors in this term -- return result
-			return val;
-		}
-
-		const int factor = parseFactor(pwStr, index, pGame, pNPC);
-		if (bMod)
-		{
-			if (factor) //no mod by zero
-				val = val % factor;
-		}
-		else if (bMultiply)
-			val *= factor;
-		else {
-			if (factor) //no divide by zero
-				val /= factor;
-		}
-	}
-
-	return val;
-}
-
-//*****************************************************************************
-int CCharacter::parseFactor(const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC)
-//Parse and evaluate a term in an expression.
-{
-	SKIP_WHITESPACE(pwStr, index);
-
-	//A nested expression?
-	if (pwStr[index] == W_t('('))
-	{
-		++index;
-		int val = parseExpression(pwStr, index, pGame, pNPC, true); //recursive call
-		SKIP_WHITESPACE(pwStr, index);
-		if (pwStr[index] == W_t(')'))
-			++index;
-		else
-		{
-			//parse error -- return the current value
-			CFiles f;
-			string str = UnicodeToUTF8(pwStr);
-			str += ": Parse error (missing close parenthesis)";
-			f.AppendErrorLog(str.c_str());
-		}
-		return val;
-	}
-
-	//Number?
-	if (iswdigit(pwStr[index]))
-	{
-		int val = _Wtoi(pwStr + index);
-
-		//Parse past digits.
-		++index;
-		while (iswdigit(pwStr[index]))
-			++index;
-
-		if (iswalpha(pwStr[index])) //i.e. of form <digits><alphas>
-		{
-			//Invalid var name -- skip to end of it and return zero value.
-			while (CDbHold::IsVarCharValid(pwStr[index]))
-				++index;
-
-			CFiles f;
-			string str = UnicodeToUTF8(pwStr);
-			str += ": Parse error (invalid var name)";
-			f.AppendErrorLog(str.c_str());
-
-			return 0;
-		}
-
-		return val;
-	}
-
-	//Variable identifier?
-	if (pwStr[index] == W_t('_') || iswalpha(pwStr[index]) || pwStr[index] == W_t('.')) //valid first char
-	{
-		//Find spot where var identifier ends.
-		int endIndex = index + 1;
-		int spcTrail = 0;
-		while (CDbHold::IsVarCharValid(pwStr[endIndex]))
-		{
-			if (pwStr[endIndex] == W_t(' '))
-				++spcTrail;
-			else
-				spcTrail = 0;
-			++endIndex;
-		}
-
-		const WSTRING wVarName(pwStr + index, endIndex - index - spcTrail);
-		index = endIndex;
-
-		//Is it a predefined var?
-		int val = 0;
-		const ScriptVars::Predefined eVar = ScriptVars::parsePredefinedVar(wVarName);
-		if (eVar != ScriptVars::P_NoVar)
-		{
-			if (!ScriptVars::IsStringVar(eVar)) {
-				if (pNPC)
-					val = int(pNPC->getPredefinedVarInt(eVar));
-				else
-					val = pGame->getVar(eVar);
-			}
-		} else if (ScriptVars::IsCharacterLocalVar(wVarName)) {
-			val = pNPC ? pNPC->getLocalVarInt(wVarName) : 0;
-		} else {
-			//Is it a local hold var?
-			char *varName = pGame->pHold->getVarAccessToken(wVarName.c_str());
-			const UNPACKEDVARTYPE vType = pGame->stats.GetVarType(varName);
-			const bool bValidInt = vType == UVT_int || vType == UVT_uint || vType == UVT_unknown;
-			if (bValidInt)
-				val = pGame->stats.GetVar(varName, (int)0);
-			//else: unrecognized identifier -- just return a zero value
-		}
-		return val;
-	}
-
-	//Invalid identifier
-	CFiles f;
-	string str = UnicodeToUTF8(pwStr + index);
-	str += ": Parse error (invalid var name)";
-	f.AppendErrorLog(str.c_str());
-
-	return 0;
+	const CScriptExpression expression(pwStr, index, pGame->pHold, bExpectCloseParen);
+	return expression.Evaluate(pGame, pNPC);
 }
 
 //*****************************************************************************
@@ -1115,7 +924,7 @@ void CCharacter::Process(
 
 	//Sword cache must be cleared to avoid using state of the room from some other entity's
 	//turn and/or being blocked by this character's own weapon
-	this->swordsInRoom.Clear();
+	GetSimulationContext().swordsInRoom.Clear();
 
 	//Only character monsters taking up a single tile are implemented.
 	ASSERT(!bIsSerpentOrGentryii(GetResolvedIdentity()));
@@ -1217,7 +1026,7 @@ void CCharacter::Process(
 				this->wPrevX = this->wX = px;
 				this->wPrevY = this->wY = py;
 				ASSERT(!room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)]);
-				room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] = this;
+				room.SetMonsterSquare(this->wX, this->wY, this);
 				SetWeaponSheathed();
 
 				//Check for stepping on pressure plate.
@@ -2303,7 +2112,7 @@ void CCharacter::Process(
 				CFiredCharacterCommand *pSpeech = new CFiredCharacterCommand(this, &command,
 					pGame->wTurnNo, this->dwScriptID, this->wCurrentCommandIndex);
 				pSpeech->text = pGame->ExpandText(
-						(const WCHAR*)command.pSpeech->MessageText, this);
+						pGame->GetSimulationContext().GetDataSource().GetSpeechText(*command.pSpeech), this);
 
 				CueEvents.Add(CID_Speech, pSpeech);	//don't attach object to event
 				bProcessNextCommand = true;
@@ -2347,7 +2156,7 @@ void CCharacter::Process(
 				this->bYesNoQuestion = this->answerOptions.empty() || this->bIfBlock;
 				CDbSpeech *pSpeech = command.pSpeech;
 				ASSERT(pSpeech);
-				const WCHAR *pText = (const WCHAR*)pSpeech->MessageText;
+				const WCHAR *pText = pGame->GetSimulationContext().GetDataSource().GetSpeechText(*pSpeech);
 				WSTRING wstr = pGame->ExpandText(pText, this);
 				CMonsterMessage *pMessage = new CMonsterMessage(
 						this->bYesNoQuestion ? MMT_YESNO : MMT_MENU, wstr.c_str(), this);
@@ -2825,7 +2634,8 @@ void CCharacter::Process(
 				//Sets the room location text.
 				CDbSpeech *pSpeech = command.pSpeech;
 				ASSERT(pSpeech);
-				pGame->customRoomLocationText = pGame->ExpandText((const WCHAR*)pSpeech->MessageText, this);
+				pGame->customRoomLocationText = pGame->ExpandText(
+						pGame->GetSimulationContext().GetDataSource().GetSpeechText(*pSpeech), this);
 				CueEvents.Add(CID_RoomLocationTextUpdate);
 
 				bProcessNextCommand = true;
@@ -2838,7 +2648,8 @@ void CCharacter::Process(
 
 				CDbSpeech *pSpeech = command.pSpeech;
 				ASSERT(pSpeech);
-				const WSTRING text = pGame->ExpandText((const WCHAR*)pSpeech->MessageText, this);
+				const WSTRING text = pGame->ExpandText(
+						pGame->GetSimulationContext().GetDataSource().GetSpeechText(*pSpeech), this);
 				CDbMessageText *pText = new CDbMessageText();
 				*pText = text.c_str();
 				CColorText *pColorText = new CColorText(pText, px, py, pw, ph);
@@ -3103,7 +2914,7 @@ bool CCharacter::GetMovement(
 			const bool bGoalIsCurrent = this->goal.wX == wDestX && this->goal.wY == wDestY;
 			this->goal.wX = wDestX;
 			this->goal.wY = wDestY;
-			room.GetSwordCoords(this->swordsInRoom, true, false, this); //optimization
+			room.GetSwordCoords(GetSimulationContext().swordsInRoom, true, false, this); //optimization
 			if (bGoalIsCurrent && ConfirmPathWithNextMoveOpen()) {
 				bPathmapping = true;
 			} else {
@@ -3142,9 +2953,10 @@ bool CCharacter::GetMovement(
 bool CCharacter::ConfirmPathWithNextMoveOpen()
 {
 	//Previously mapped path may go through specially marked NPCs...
-	CMonster::calculatingPathmap = true;
+	CSimulationContext& context = GetSimulationContext();
+	context.bCalculatingPathmap = true;
 	const bool bRes = ConfirmPath();
-	CMonster::calculatingPathmap = false;
+	context.bCalculatingPathmap = false;
 
 	//...as long as the step to take now is open.
 	if (bRes) {
@@ -3311,6 +3123,50 @@ void CCharacter::FailedIfCondition()
 
 }
 
+//*****************************************************************************
+ULONGLONG CCharacter::GetStateHash() const
+//Returns: a hash of this NPC's game state, including script progress
+{
+	ULONGLONG hash = CPlayerDouble::GetStateHash() ^ StateHash::Key(StateHash::Monster,
+			0x80000000 | this->wCurrentCommandIndex, this->wTurnDelay,
+			(this->eImperative << 8) | (this->bVisible ? 1 : 0) |
+			(this->bScriptDone ? 2 : 0) | (this->bReplaced ? 4 : 0));
+
+	hash ^= StateHash::Key(StateHash::MonsterState, this->wLogicalIdentity,
+			(this->movementIQ << 16) | this->eDisplayMode,
+			(this->bSafeToPlayer ? 0x1 : 0) | (this->bSwordSafeToPlayer ? 0x2 : 0) |
+			(this->bEndWhenKilled ? 0x4 : 0) | (this->bNotPushable ? 0x8 : 0) |
+			(this->bPushableByBody ? 0x10 : 0) | (this->bPushableByWeapon ? 0x20 : 0) |
+			(this->bStunnable ? 0x40 : 0) | (this->bBrainPathmapObstacle ? 0x80 : 0) |
+			(this->bNPCPathmapObstacle ? 0x100 : 0) | (this->bWeaponOverride ? 0x200 : 0) |
+			(this->bMovingRelative ? 0x400 : 0) | (this->bWaitingForCueEvent ? 0x800 : 0) |
+			(this->bIfBlock ? 0x1000 : 0) | (this->bParseIfElseAsCondition ? 0x2000 : 0) |
+			(this->bGlobal ? 0x4000 : 0) | (this->bYesNoQuestion ? 0x8000 : 0) |
+			(this->bWasPushed ? 0x10000 : 0) | (this->bPreventMoveAfterPush ? 0x20000 : 0) |
+			0x80000000);
+	hash ^= StateHash::Key(StateHash::MonsterState, 0x80000000 | this->wJumpLabel,
+			(this->wYRel << 16) | this->wXRel, this->worldMapID);
+	hash ^= StateHash::Key(StateHash::MonsterState, this->paramX ^ (this->paramY << 16),
+			this->paramW ^ (this->paramH << 16), 0x40000000 | this->paramF);
+
+	//Containers are hashed in order, so equal contents give equal hashes.
+	ULONGLONG listHash = 0;
+	for (vector<UINT>::const_iterator jump = this->jumpStack.begin();
+			jump != this->jumpStack.end(); ++jump)
+		listHash = StateHash::Mix(listHash ^ *jump);
+	for (CIDSet::const_iterator answer = this->answerOptions.begin();
+			answer != this->answerOptions.end(); ++answer)
+		listHash = StateHash::Mix(listHash ^ (0x100000000ULL | *answer));
+	for (LocalScriptMap::const_iterator var = this->localScriptVars.begin();
+			var != this->localScriptVars.end(); ++var)
+	{
+		listHash = StateHash::Bytes(var->first.c_str(), var->first.size() * sizeof(WCHAR), listHash);
+		listHash = StateHash::Bytes(var->second.c_str(), var->second.size() * sizeof(WCHAR), listHash);
+	}
+
+	return hash ^ StateHash::Mix(listHash);
+}
+
 //*****************************************************************************
 UINT CCharacter::GetResolvedIdentity() const
 //Returns: what identity the NPC should take.
@@ -3544,8 +3400,6 @@ bool CCharacter::DoesVarSatisfy(const CCharacterCommand& command, CCurrentGame *
 	const UINT varIndex = command.x;
 
 	//Get variable.
-	CDbPackedVars& stats = pGame->stats;
-	char holdVarName[11] = "v";
 	UNPACKEDVARTYPE vType = UVT_int;
 
 	const bool bPredefinedVar = varIndex >= UINT(ScriptVars::FirstPredefinedVar);
@@ -3560,13 +3414,8 @@ bool CCharacter::DoesVarSatisfy(const CCharacterCommand& command, CCurrentGame *
 		}
 		if (!bLocalVar)
 		{
-			//Get local hold var.
-			char varID[10];
-			_itoa(varIndex, varID, 10);
-			strcat(holdVarName, varID);
-
 			//Enforce basic type checking.
-			vType = stats.GetVarType(holdVarName);
+			vType = pGame->GetHoldVarType(varIndex);
 			bValidInt = vType == UVT_int || vType == UVT_uint || vType == UVT_unknown;
 		}
 	}
@@ -3575,8 +3424,7 @@ bool CCharacter::DoesVarSatisfy(const CCharacterCommand& command, CCurrentGame *
 	if (!operand && !command.label.empty() && command.y != ScriptVars::EqualsText)
 	{
 		//Operand is not just an integer, but a text expression.
-		UINT index=0;
-		operand = parseExpression(command.label.c_str(), index, pGame, this);
+		operand = command.GetExpression(pGame->pHold).Evaluate(pGame, this);
 	}
 
 	int x=0;
@@ -3587,7 +3435,7 @@ bool CCharacter::DoesVarSatisfy(const CCharacterCommand& command, CCurrentGame *
 		} else if (bLocalVar) {
 			x = getLocalVarInt(localVarName);
 		} else {
-			x = stats.GetVar(holdVarName, (int)0);
+			x = pGame->GetHoldVarInt(varIndex);
 		}
 	}
 
@@ -3609,7 +3457,11 @@ bool CCharacter::DoesVarSatisfy(const CCharacterCommand& command, CCurrentGame *
 				wStr = getLocalVarString(localVarName);
 			} else {
 				if (vType == UVT_wchar_string)
-					wStr = stats.GetVar(holdVarName, wszEmpty);
+				{
+					char holdVarName[12];
+					CCurrentGame::GetHoldVarAccessToken(varIndex, holdVarName);
+					wStr = pGame->stats.GetVar(holdVarName, wszEmpty);
+				}
 			}
 			const WSTRING operand = pGame->ExpandText(command.label.c_str(), this);
 			return wStr == operand;
@@ -3656,7 +3508,7 @@ void CCharacter::SetVariable(const CCharacterCommand& command, CCurrentGame* pGa
 			strcat(varName, varID);
 
 			//Enforce basic type checking.
-			const UNPACKEDVARTYPE vType = stats.GetVarType(varName);
+			const UNPACKEDVARTYPE vType = pGame->GetHoldVarType(varIndex);
 			bValidInt = vType == UVT_int || vType == UVT_uint || vType == UVT_unknown;
 		}
 	}
@@ -3668,8 +3520,7 @@ void CCharacter::SetVariable(const CCharacterCommand& command, CCurrentGame* pGa
 	if (!operand && !command.label.empty() && bSetNumber)
 	{
 		//Operand is not just an integer, but a text expression.
-		UINT index=0;
-		operand = parseExpression(command.label.c_str(), index, pGame, this);
+		operand = command.GetExpression(pGame->pHold).Evaluate(pGame, this);
 	}
 
 	int x=0;
@@ -3681,28 +3532,28 @@ void CCharacter::SetVariable(const CCharacterCommand& command, CCurrentGame* pGa
 		break;
 		case ScriptVars::Inc:
 			if (bValidInt)
-				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : stats.GetVar(varName, (int)0);
+				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : pGame->GetHoldVarInt(varIndex);
 			addWithClamp(x, operand);
 		break;
 		case ScriptVars::Dec:
 			if (bValidInt)
-				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : stats.GetVar(varName, (int)0);
+				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : pGame->GetHoldVarInt(varIndex);
 			addWithClamp(x, -operand);
 		break;
 		case ScriptVars::MultiplyBy:
 			if (bValidInt)
-				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : stats.GetVar(varName, (int)0);
+				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : pGame->GetHoldVarInt(varIndex);
 			multWithClamp(x, operand);
 		break;
 		case ScriptVars::DivideBy:
 			if (bValidInt)
-				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : stats.GetVar(varName, (int)0);
+				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : pGame->GetHoldVarInt(varIndex);
 			if (operand)
 				x /= operand;
 		break;
 		case ScriptVars::Mod:
 			if (bValidInt)
-				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : stats.GetVar(varName, (int)0);
+				x = bPredefinedVar ? predefinedVarVal : bLocalVar ? getLocalVarInt(localVarName) : pGame->GetHoldVarInt(varIndex);
 			if (operand)
 				x = x % operand;
 		break;
@@ -3737,7 +3588,7 @@ void CCharacter::SetVariable(const CCharacterCommand& command, CCurrentGame* pGa
 			_itoW(int(x), wIntText, 10);
 			SetLocalVar(localVarName, wIntText);
 		} else {
-			stats.SetVar(varName, x);
+			pGame->SetHoldVar(varIndex, x);
 		}
 	}
 }
@@ -4209,7 +4060,7 @@ const
 	//Check for monster at square.
 	CMonster *pMonster = room.GetMonsterAtSquare(wCol, wRow);
 	if (pMonster && pMonster->wType != M_FLUFFBABY) {
-		if (!CMonster::calculatingPathmap || pMonster->IsNPCPathmapObstacle()){
+		if (!GetSimulationContext().bCalculatingPathmap || pMonster->IsNPCPathmapObstacle()){
 			const int dx = (int)wCol - (int)this->wX;
 			const int dy = (int)wRow - (int)this->wY;
 
@@ -4226,8 +4077,8 @@ const
 		return true;
 
 	//Can't step on any swords.
-	if (!this->swordsInRoom.empty()) {
-		if (this->swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
+	if (!GetSimulationContext().swordsInRoom.empty()) {
+		if (GetSimulationContext().swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
 			return true;
 	} else {
 		//Check for player's sword at square.
@@ -4546,7 +4397,11 @@ void CCharacter::SetCurrentGame(
 	//If this NPC is a custom character with no script,
 	//then use the default script for this custom character type.
 	if (this->pCustomChar && this->commands.empty())
-		LoadCommands(this->pCustomChar->ExtraVars, this->commands);
+	{
+		ASSERT(pSetCurrentGame->pHold);
+		pSetCurrentGame->GetSimulationContext().GetDataSource().GetCustomCharacterScript(
+				pSetCurrentGame->pHold->dwHoldID, *this->pCustomChar, this->commands);
+	}
 
 	//Global scripts started without commands should be flagged as done
 	//and removed on room exit
@@ -5119,7 +4974,7 @@ void CCharacter::Disappear()
 	this->bVisible = false;
 	this->bWeaponSheathed = true;
 	ASSERT(room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] == this);
-	room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] = NULL;
+	room.SetMonsterSquare(this->wX, this->wY, NULL);
 }
 
 //*****************************************************************************
@@ -5277,7 +5132,7 @@ void CCharacter::TeleportCharacter(
 	if (this->bVisible)
 	{
 		ASSERT(room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] == this);
-		room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] = NULL;
+		room.SetMonsterSquare(this->wX, this->wY, NULL);
 	}
 
 	CCoordSet coords(this->wX, this->wY);
@@ -5290,7 +5145,7 @@ void CCharacter::TeleportCharacter(
 	if (this->bVisible)
 	{
 		ASSERT(!room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)]);
-		room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] = this;
+		room.SetMonsterSquare(this->wX, this->wY, this);
 		SetWeaponSheathed();
 
 		//Check for stepping on pressure plate.
@@ -114,6 +114,7 @@ public:
 	virtual UINT   GetIdentity() const {return this->wIdentity;}
 	virtual UINT   GetResolvedIdentity() const;
 	UINT           GetNextSpeechID();
+	virtual ULONGLONG GetStateHash() const;
 	bool           HasSpecialDeath() const;
 	virtual bool   HasSword() const;
 
@@ -166,8 +167,6 @@ public:
 	virtual bool   OnAnswer(int nCommand, CCueEvents &CueEvents);
 	virtual bool   OnStabbed(CCueEvents &CueEvents, const UINT /*wX*/=-1, const UINT /*wY*/=-1, WeaponType weaponType=WT_Sword);
 	static int     parseExpression(const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC=NULL, const bool bExpectCloseParen=false);
-	static int     parseTerm(const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC);
-	static int     parseFactor(const WCHAR *pwStr, UINT& index, CCurrentGame *pGame, CCharacter *pNPC);
 	virtual void   Process(const int nLastCommand, CCueEvents &CueEvents);
 	virtual void   PushInDirection(int dx, int dy, bool bStun, CCueEvents &CueEvents);
 
@@ -1,5 +1,7 @@
 #include "CharacterCommand.h"
+#include "DbHolds.h"
 #include "DbSpeech.h"
+#include "ScriptExpression.h"
 #include <BackEndLib/Ports.h>
 
 #include "../Texts/MIDs.h"
@@ -21,19 +23,24 @@ CImageOverlay::~CImageOverlay() { }
 CCharacterCommand::CCharacterCommand()
 	: command((CharCommand)0)
 	, x(0), y(0), w(0), h(0), flags(0), pSpeech(NULL)
+	, pExpression(NULL)
 {}
 
 CCharacterCommand::CCharacterCommand(const CCharacterCommand& that, const bool bReplicateData)
 	: command(that.command)
 	, x(that.x), y(that.y), w(that.w), h(that.h), flags(that.flags), label(that.label), pSpeech(NULL)
+	, pExpression(NULL)
 {
 	if (that.pSpeech)
 		this->pSpeech = new CDbSpeech(*that.pSpeech, bReplicateData);
+	if (that.pExpression)
+		this->pExpression = new CScriptExpression(*that.pExpression);
 }
 
 CCharacterCommand::~CCharacterCommand()
 {
 	delete this->pSpeech;
+	delete this->pExpression;
 }
 
 CCharacterCommand& CCharacterCommand::operator=(const CCharacterCommand& that)
@@ -51,6 +58,21 @@ void CCharacterCommand::swap(CCharacterCommand &that) {
 	std::swap(flags, that.flags);
 	std::swap(label, that.label);
 	std::swap(pSpeech, that.pSpeech);
+	std::swap(pExpression, that.pExpression);
+}
+
+//*****************************************************************************
+const CScriptExpression& CCharacterCommand::GetExpression(const CDbHold *pHold) const
+//Returns: the label compiled as an expression with pHold's vars.
+//It is compiled the first time, and again only if the label has been edited.
+{
+	if (!this->pExpression || !this->pExpression->IsCompiledFrom(this->label, pHold))
+	{
+		delete this->pExpression;
+		UINT index = 0;
+		this->pExpression = new CScriptExpression(this->label.c_str(), index, pHold);
+	}
+	return *this->pExpression;
 }
 
 //*****************************************************************************
@@ -163,7 +163,9 @@ namespace ScriptFlag
 	static const UINT WMI_NOLABEL    = 0x00000010; //disabled area with no label shown
 };
 
+class CDbHold;
 class CDbSpeech;
+class CScriptExpression;
 class CCharacterCommand
 {
 public:
@@ -274,6 +276,8 @@ public:
 	WSTRING label;    //goto identifier
 	CDbSpeech *pSpeech;
 
+	const CScriptExpression& GetExpression(const CDbHold *pHold) const;
+
 	bool IsMusicCommand() const {
 		switch (command) {
 			case CC_SetMusic:
@@ -283,6 +287,9 @@ public:
 				return false;
 		}
 	}
+
+private:
+	mutable CScriptExpression *pExpression; //label compiled by GetExpression
 };
 
 class CDbMessageText;
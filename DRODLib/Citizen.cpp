@@ -29,6 +29,7 @@
 #include "Station.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 const UINT STUCK_THRESHOLD = 10; //# of turns a citizen waits in a jam to get unstuck
 
@@ -42,6 +43,8 @@ CCitizen::CCitizen(CCurrentGame *pSetCurrentGame,
 	, nStationType(-1)
 	, nVisitingStation(-1)
 	, wTurnsStuck(0)
+	, wNoStationX(UINT(-1)), wNoStationY(UINT(-1))
+	, dwNoStationPathsVersion(0)
 {
 }
 
@@ -111,7 +114,7 @@ const
 		return true;
 
 	//Can't step on any swords.
-	if (this->swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
+	if (GetSimulationContext().swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
 		return true;
 
 	//Player can never be stepped on.
@@ -172,6 +175,19 @@ bool CCitizen::GetGoal(UINT& wX, UINT& wY) const
 	return true;
 }
 
+//******************************************************************************
+ULONGLONG CCitizen::GetStateHash() const
+//Returns: a hash of this citizen's game state, including its station route
+{
+	ULONGLONG hash = CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->nStationType, this->nVisitingStation,
+			0x04000000 | (this->wTurnsStuck << 2) | (this->bDone ? 1 : 0) | (this->bHasSupply ? 2 : 0));
+	if (!this->visitingSequence.empty())
+		hash ^= StateHash::Bytes(&this->visitingSequence[0],
+				this->visitingSequence.size() * sizeof(int), 0x04000000);
+	return hash;
+}
+
 //******************************************************************************
 void CCitizen::Process(
 //Process a citizen for movement.
@@ -218,7 +234,7 @@ bool CCitizen::CalcPathAndAdvance(CCueEvents& CueEvents)
 	if (!bGoalIsCurrent ||
 			nDist(this->wX, this->wY, this->goal.wX, this->goal.wY) != 1)
 	{
-		room.GetSwordCoords(this->swordsInRoom, true); //speed optimization
+		room.GetSwordCoords(GetSimulationContext().swordsInRoom, true); //speed optimization
 		if (!bGoalIsCurrent || !ConfirmPath())
 		{
 			//If it's not, search for a (new) path to the goal.
@@ -330,8 +346,15 @@ void CCitizen::GotoStation(CCueEvents &CueEvents)
 	//If ready, choose a station to move to.
 	if (this->nVisitingStation == -1)
 	{
+		//Nothing to do while still where no station could be reached from.
+		if (this->visitingSequence.empty() && this->wX == this->wNoStationX &&
+				this->wY == this->wNoStationY &&
+				room.dwStationPathsVersion == this->dwNoStationPathsVersion)
+			return;
+
 		//Find closest unvisited station.
 		UINT wDist, wBestDistance = (UINT)-1, wBestIndex = 0;
+		bool bMayReach = false; //whether a station's reachability depends on dynamic obstacles
 
 		UINT n=wNumStations;
 		while (n--)
@@ -340,6 +363,8 @@ void CCitizen::GotoStation(CCueEvents &CueEvents)
 				continue; //not visiting stations of this set
 			if (sequenceOfStation(n) >= 0)
 				continue; //station is already in route -- doesn't need to be added again
+			if (!bMayReach && stations[n]->IsNearPathmap(this->wX, this->wY))
+				bMayReach = true;
 			wDist = stations[n]->GetDistanceFrom(this->wX, this->wY);
 			if (!wDist) continue;
 			if (wDist < wBestDistance || (wDist == wBestDistance &&
@@ -354,7 +379,16 @@ void CCitizen::GotoStation(CCueEvents &CueEvents)
 		{
 			//No new station was accessible.
 			if (this->visitingSequence.empty())
+			{
+				if (!bMayReach)
+				{
+					//Don't search again until something changes.
+					this->wNoStationX = this->wX;
+					this->wNoStationY = this->wY;
+					this->dwNoStationPathsVersion = room.dwStationPathsVersion;
+				}
 				return; //search for one next turn
+			}
 			this->nVisitingStation = 0; //Begin route again from the beginning.
 		} else {
 			//Extend route -- go visit new station.
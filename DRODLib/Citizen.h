@@ -47,6 +47,7 @@ public:
 
 	virtual bool CheckForDamage(CCueEvents& CueEvents);
 	virtual bool DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsTileObstacle(const UINT wTileNo) const;
 	bool GetGoal(UINT& wX, UINT& wY) const;
 	virtual void Process(const int nLastCommand, CCueEvents &CueEvents);
@@ -77,6 +78,10 @@ private:
 	std::vector<int> visitingSequence; //station route
 	int nVisitingStation; //which station in sequence is being visited
 	UINT wTurnsStuck;  //# of consecutive turns moving to a station has failed
+
+	//Where no station could be reached from, until station path maps change.
+	UINT wNoStationX, wNoStationY;
+	UINT dwNoStationPathsVersion;
 };
 
 #endif //...#ifndef CITIZEN_H
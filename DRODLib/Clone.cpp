@@ -28,6 +28,7 @@
 #include "Swordsman.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //
 //Public methods.
@@ -196,6 +197,14 @@ bool CClone::OnStabbed(CCueEvents& CueEvents, const UINT wX, const UINT wY, Weap
 	return true;
 }
 
+//*****************************************************************************************
+ULONGLONG CClone::GetStateHash() const
+//Returns: a hash of this clone's game state
+{
+	return CPlayerDouble::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->wCreationIndex, 0, 0x05000000);
+}
+
 //*****************************************************************************************
 void CClone::Process(
 //Process a clone for movement.
@@ -44,6 +44,7 @@ public:
 	virtual bool CanDropTrapdoor(const UINT oTile) const;
   virtual bool CanWadeInShallowWater() const;
 	virtual UINT GetIdentity() const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsFlying() const;
 	virtual bool IsMonsterTarget() const;
   virtual bool IsSwimming() const;
@@ -28,6 +28,7 @@
 
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //*****************************************************************************
 bool CConstruct::CanDropTrapdoor(const UINT oTile) const {
@@ -165,6 +166,14 @@ bool CConstruct::KillIfOnOremites(CCueEvents &CueEvents)
 	return false;
 }
 
+//*****************************************************************************************
+ULONGLONG CConstruct::GetStateHash() const
+//Returns: a hash of this monster's game state, including when it was disabled
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->wTurnDisabled, 0, 0x0C000000 | (this->bOremiteDamage ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CConstruct::Process(
 //Process movement turn.
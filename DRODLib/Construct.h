@@ -43,6 +43,7 @@ public:
 	virtual bool CanDropTrapdoor(const UINT oTile) const;
 	virtual bool CanPushObjects() const;
 	virtual bool DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsTileObstacle(const UINT wTileNo) const;
 	bool         KillIfOnOremites(CCueEvents &CueEvents);
 	void         ResetOremiteDamage() {this->bOremiteDamage = false;}
@@ -77,41 +77,34 @@ void CCueEvents::SetMembers(const CCueEvents& Src)
 
 	//Copy all data
 
-	this->wEventCount = Src.wEventCount;
-	this->wNextPrivateDataIndex = Src.wNextPrivateDataIndex;
-	this->wNextCID = Src.wNextCID;
-
-	for (UINT wCID=CUEEVENT_COUNT; wCID--; )
+	this->wNextPrivateData = Src.wNextPrivateData;
+	memcpy(this->firedBits, Src.firedBits, sizeof(this->firedBits));
+	this->firedCIDs = Src.firedCIDs;
+	for (vector<CUEEVENT_ID>::const_iterator cid = this->firedCIDs.begin();
+			cid != this->firedCIDs.end(); ++cid)
 	{
-		this->barrIsCIDSet[wCID] = Src.barrIsCIDSet[wCID];
-
-		vector<CID_PRIVDATA_NODE>::const_iterator pSeek = Src.CIDPrivateData[wCID].begin();
-		while (pSeek != Src.CIDPrivateData[wCID].end())
-		{
-			ASSERT(pSeek->pvPrivateData);
-
-			this->CIDPrivateData[wCID].push_back(CID_PRIVDATA_NODE(false, pSeek->pvPrivateData));
-			++pSeek;
-		}
+		this->firstPrivateData[*cid] = Src.firstPrivateData[*cid];
+		this->lastPrivateData[*cid] = Src.lastPrivateData[*cid];
+		this->privateDataCount[*cid] = Src.privateDataCount[*cid];
 	}
+
+	//Node indices are kept so the links stay valid.
+	this->privateData = Src.privateData;
+	for (vector<CID_PRIVDATA_NODE>::iterator pSeek = this->privateData.begin();
+			pSeek != this->privateData.end(); ++pSeek)
+		pSeek->bIsAttached = false;
 }
 
 //***************************************************************************************
 void CCueEvents::Clear()
 //Frees resources and resets members.
 {
-	//Delete private data and nodes to track it.
-	for (UINT wCID=CUEEVENT_COUNT; wCID--; )
+	//Delete private data.
+	for (vector<CID_PRIVDATA_NODE>::const_iterator pSeek = this->privateData.begin();
+			pSeek != this->privateData.end(); ++pSeek)
 	{
-		vector<CID_PRIVDATA_NODE>::iterator pSeek = this->CIDPrivateData[wCID].begin();
-		while (pSeek != this->CIDPrivateData[wCID].end())
-		{
-			ASSERT(pSeek->pvPrivateData);
-			if (pSeek->bIsAttached)
-				delete pSeek->pvPrivateData;
-			++pSeek;
-		}
-		//this->CIDPrivateData[wCID].clear();	//cleared in Zero below
+		if (pSeek->bIsAttached)
+			delete pSeek->pvPrivateData;
 	}
 
 	//Zero all the members.
@@ -122,33 +115,35 @@ void CCueEvents::Clear()
 void CCueEvents::ClearEvent(const CUEEVENT_ID eCID, const bool bDeleteAttached)	//[default=true]
 //Resets members for specified cue event.
 {
-	if (bDeleteAttached)
-	{
-		//Delete attached data objects.
-		vector<CID_PRIVDATA_NODE>::iterator pSeek = this->CIDPrivateData[eCID].begin();
-		while (pSeek != this->CIDPrivateData[eCID].end())
-		{
-			ASSERT(pSeek->pvPrivateData);
-			if (pSeek->bIsAttached)
-				delete pSeek->pvPrivateData;
-			++pSeek;
-		}
-	}
-	this->CIDPrivateData[eCID].clear();
+	ASSERT(IS_VALID_CID(eCID));
+	if (!HasOccurred(eCID))
+		return;
 
-	//Reset any iteration through this event's members.
-	if (this->wNextCID == (UINT)eCID)
+	//Remove this event's private data.
+	for (UINT wNode = this->firstPrivateData[eCID]; wNode != NO_PRIVDATA_NODE; )
 	{
-		this->wNextPrivateDataIndex = 0;
-		this->wNextCID = (UINT)-1;
+		CID_PRIVDATA_NODE& node = this->privateData[wNode];
+		ASSERT(node.pvPrivateData);
+		if (bDeleteAttached && node.bIsAttached)
+			delete node.pvPrivateData;
+		node.pvPrivateData = NULL;
+
+		//Reset any iteration through this event's members.
+		if (this->wNextPrivateData == wNode)
+			this->wNextPrivateData = NO_PRIVDATA_NODE;
+
+		wNode = node.wNext;
 	}
 
 	//Reset flags for this event.
-	if (this->barrIsCIDSet[eCID])
-	{
-		this->barrIsCIDSet[eCID] = false;
-		--this->wEventCount;
-	}
+	this->firedBits[eCID / 32] &= ~(1u << (eCID % 32));
+	for (vector<CUEEVENT_ID>::iterator cid = this->firedCIDs.begin();
+			cid != this->firedCIDs.end(); ++cid)
+		if (*cid == eCID)
+		{
+			this->firedCIDs.erase(cid);
+			break;
+		}
 }
 
 //***************************************************************************************
@@ -162,7 +157,7 @@ UINT CCueEvents::GetOccurrenceCount(
 //The count.  Will be 0 if cue event has not occurred.
 const
 {
-	return this->CIDPrivateData[eCID].size();
+	return HasOccurred(eCID) ? this->privateDataCount[eCID] : 0;
 }
 
 //***************************************************************************************
@@ -185,16 +180,26 @@ void CCueEvents::Add(
 	ASSERT(!(pvPrivateData == NULL && bIsAttached));
 
 	//Set CID flag.
-	if (!this->barrIsCIDSet[eCID])
+	if (!HasOccurred(eCID))
 	{
-		this->barrIsCIDSet[eCID] = true;
-		++this->wEventCount;
+		this->firedBits[eCID / 32] |= 1u << (eCID % 32);
+		this->firedCIDs.push_back(eCID);
+		this->firstPrivateData[eCID] = this->lastPrivateData[eCID] = NO_PRIVDATA_NODE;
+		this->privateDataCount[eCID] = 0;
 	}
 
 	//Add private data.
 	if (pvPrivateData)
-		this->CIDPrivateData[eCID].push_back(
-				CID_PRIVDATA_NODE(bIsAttached, pvPrivateData));
+	{
+		const UINT wNode = this->privateData.size();
+		this->privateData.push_back(CID_PRIVDATA_NODE(eCID, bIsAttached, pvPrivateData));
+		if (this->lastPrivateData[eCID] == NO_PRIVDATA_NODE)
+			this->firstPrivateData[eCID] = wNode;
+		else
+			this->privateData[this->lastPrivateData[eCID]].wNext = wNode;
+		this->lastPrivateData[eCID] = wNode;
+		++this->privateDataCount[eCID];
+	}
 }
 
 //***************************************************************************************
@@ -208,19 +213,16 @@ const CAttachableObject* CCueEvents::GetFirstPrivateData(
 //Returns:
 //First private data pointer or NULL if there is no private data associated with cue event.
 {
-	vector<CID_PRIVDATA_NODE>::const_iterator pFirst = this->CIDPrivateData[eCID].begin();
-	if (pFirst != this->CIDPrivateData[eCID].end())
+	if (HasOccurred(eCID) && this->firstPrivateData[eCID] != NO_PRIVDATA_NODE)
 	{
-		ASSERT(this->barrIsCIDSet[eCID]); //If I found private data then the event should be set.
-		ASSERT(pFirst->pvPrivateData);
+		const CID_PRIVDATA_NODE& first = this->privateData[this->firstPrivateData[eCID]];
+		ASSERT(first.pvPrivateData);
 
-		this->wNextCID = eCID;
-		this->wNextPrivateDataIndex = 1;
-		return pFirst->pvPrivateData;
+		this->wNextPrivateData = first.wNext;
+		return first.pvPrivateData;
 	}
 
-	this->wNextPrivateDataIndex = 0;
-	this->wNextCID = (UINT)-1;
+	this->wNextPrivateData = NO_PRIVDATA_NODE;
 	return NULL;
 }
 
@@ -233,14 +235,13 @@ const CAttachableObject* CCueEvents::GetNextPrivateData()
 //Private data pointer or NULL if there are no more.
 {
 	//Check whether there are any more private data left.
-	if (this->wNextCID == (UINT)-1) return NULL;
-	if (this->wNextPrivateDataIndex >= this->CIDPrivateData[this->wNextCID].size())
+	if (this->wNextPrivateData == NO_PRIVDATA_NODE)
 		return NULL;
 
-	CID_PRIVDATA_NODE *pCurrent = &(this->CIDPrivateData[this->wNextCID]
-			[this->wNextPrivateDataIndex++]);
-	ASSERT(pCurrent->pvPrivateData);
-	return pCurrent->pvPrivateData;
+	const CID_PRIVDATA_NODE& current = this->privateData[this->wNextPrivateData];
+	ASSERT(current.pvPrivateData);
+	this->wNextPrivateData = current.wNext;
+	return current.pvPrivateData;
 }
 
 //***************************************************************************************
@@ -258,8 +259,7 @@ const
 	//Each iteration checks for presence of one CID from
 	for (UINT wCIDI = 0; wCIDI < wCIDArrayCount; ++wCIDI)
 	{
-		ASSERT(IS_VALID_CID(peCIDArray[wCIDI]));
-		if (this->barrIsCIDSet[peCIDArray[wCIDI]])
+		if (HasOccurred(peCIDArray[wCIDI]))
 			//Found one from the list--any remaining IDs are ignored.
 			return true;
 	}
@@ -283,16 +283,15 @@ const
 	ASSERT(IS_VALID_CID(eCID));
 	ASSERT(pvPrivateData);
 
-	vector<CID_PRIVDATA_NODE>::const_iterator pSeek = this->CIDPrivateData[eCID].begin();
-	const vector<CID_PRIVDATA_NODE>::const_iterator pSeekEnd = this->CIDPrivateData[eCID].end();
+	if (!HasOccurred(eCID))
+		return false;
 
 	//Each iteration checks on private data for a matching pointer.
-	while (pSeek != pSeekEnd)
+	for (UINT wNode = this->firstPrivateData[eCID]; wNode != NO_PRIVDATA_NODE;
+			wNode = this->privateData[wNode].wNext)
 	{
-		ASSERT(this->barrIsCIDSet[eCID]);
-		if (pSeek->pvPrivateData == pvPrivateData)
+		if (this->privateData[wNode].pvPrivateData == pvPrivateData)
 			return true; //Found it.
-		++pSeek;
 	}
 
 	//Didn't find it.
@@ -313,21 +312,34 @@ bool CCueEvents::Remove(
 	ASSERT(IS_VALID_CID(eCID));
 	ASSERT(pvPrivateData);
 
-	vector<CID_PRIVDATA_NODE>::iterator pSeek = this->CIDPrivateData[eCID].begin();
-	const vector<CID_PRIVDATA_NODE>::const_iterator pSeekEnd = this->CIDPrivateData[eCID].end();
+	if (!HasOccurred(eCID))
+		return false;
 
 	//Each iteration checks on private data for a matching pointer.
-	while (pSeek != pSeekEnd)
+	UINT wPrev = NO_PRIVDATA_NODE;
+	for (UINT wNode = this->firstPrivateData[eCID]; wNode != NO_PRIVDATA_NODE;
+			wPrev = wNode, wNode = this->privateData[wNode].wNext)
 	{
-		ASSERT(this->barrIsCIDSet[eCID]);
-		if (pSeek->pvPrivateData == pvPrivateData)
-		{
-			if (pSeek->bIsAttached)
-				delete pSeek->pvPrivateData;
-			this->CIDPrivateData[eCID].erase(pSeek);
-			return true; //Found it.
-		}
-		++pSeek;
+		CID_PRIVDATA_NODE& node = this->privateData[wNode];
+		if (node.pvPrivateData != pvPrivateData)
+			continue;
+
+		if (node.bIsAttached)
+			delete node.pvPrivateData;
+		node.pvPrivateData = NULL;
+
+		//Unlink the node.  Its slot isn't reused until the next Clear().
+		if (wPrev == NO_PRIVDATA_NODE)
+			this->firstPrivateData[eCID] = node.wNext;
+		else
+			this->privateData[wPrev].wNext = node.wNext;
+		if (this->lastPrivateData[eCID] == wNode)
+			this->lastPrivateData[eCID] = wPrev;
+		--this->privateDataCount[eCID];
+
+		if (this->wNextPrivateData == wNode)
+			this->wNextPrivateData = node.wNext;
+		return true; //Found it.
 	}
 
 	//Didn't find it.
@@ -341,16 +353,10 @@ bool CCueEvents::Remove(
 //***************************************************************************************
 void CCueEvents::Zero()
 //Zero all the members.
+//List storage is kept for reuse.
 {
-	ASSERT(sizeof(this->barrIsCIDSet) ==
-			sizeof(this->barrIsCIDSet[0]) * CUEEVENT_COUNT);
-	ASSERT(sizeof(this->CIDPrivateData) ==
-			sizeof(this->CIDPrivateData[0]) * CUEEVENT_COUNT);
-
-	this->wNextPrivateDataIndex = 0;
-	this->wNextCID = (UINT)-1;
-	memset(this->barrIsCIDSet, 0, sizeof(this->barrIsCIDSet));
-	for (UINT wCID=CUEEVENT_COUNT; wCID--; )
-		this->CIDPrivateData[wCID].clear();
-	this->wEventCount = 0;
+	this->wNextPrivateData = NO_PRIVDATA_NODE;
+	memset(this->firedBits, 0, sizeof(this->firedBits)); //a few words
+	this->firedCIDs.clear();
+	this->privateData.clear();
 }
@@ -872,13 +872,21 @@ class CAttachableObject;
 
 //
 //Linked list node for storing private data.
+//Nodes for all events are kept in one list in the order they were added, and
+//nodes for the same event are linked by index.
+const UINT NO_PRIVDATA_NODE = (UINT)-1;
 struct CID_PRIVDATA_NODE
 {
-	CID_PRIVDATA_NODE(const bool bIsAttached, const CAttachableObject *pvPrivateData)
-		: bIsAttached(bIsAttached), pvPrivateData(pvPrivateData) { }
+	CID_PRIVDATA_NODE(const CUEEVENT_ID eCID, const bool bIsAttached,
+			const CAttachableObject *pvPrivateData)
+		: eCID(eCID), bIsAttached(bIsAttached), pvPrivateData(pvPrivateData)
+		, wNext(NO_PRIVDATA_NODE)
+	{ }
 
+	CUEEVENT_ID eCID;
 	bool bIsAttached;
-	const CAttachableObject *pvPrivateData;
+	const CAttachableObject *pvPrivateData; //NULL once removed
+	UINT wNext;  //next node for the same event
 };
 
 //******************************************************************************************
@@ -895,20 +903,27 @@ public:
 	void		ClearEvent(const CUEEVENT_ID eCID, const bool bDeleteAttached=true);
 	const CAttachableObject* GetFirstPrivateData(const CUEEVENT_ID eCID);
 	const CAttachableObject* GetNextPrivateData();
-	inline UINT GetEventCount() const {return this->wEventCount;}
+	inline UINT GetEventCount() const {return this->firedCIDs.size();}
 	UINT     GetOccurrenceCount(const CUEEVENT_ID eCID) const;
-	inline bool HasOccurred(const CUEEVENT_ID eCID) const {ASSERT(IS_VALID_CID(eCID)); return this->barrIsCIDSet[eCID];}
+	inline bool HasOccurred(const CUEEVENT_ID eCID) const {ASSERT(IS_VALID_CID(eCID));
+			return (this->firedBits[eCID / 32] & (1u << (eCID % 32))) != 0;}
 	bool     HasOccurredWith(const CUEEVENT_ID eCID, const CAttachableObject *pvPrivateData) const;
 	bool     HasAnyOccurred(const UINT wCIDArrayCount, const CUEEVENT_ID *peCIDArray) const;
 	bool     Remove(const CUEEVENT_ID eCID, const CAttachableObject *pvPrivateData);
 
 protected:
-	UINT     wNextPrivateDataIndex, wNextCID;
-
-	bool           barrIsCIDSet[CUEEVENT_COUNT];
-	vector<CID_PRIVDATA_NODE>  CIDPrivateData[CUEEVENT_COUNT];
-
-	UINT     wEventCount;
+	UINT     wNextPrivateData;  //node GetNextPrivateData() returns next
+
+	//A typical turn sets only a few events, so only the events that occurred
+	//are visited when clearing, copying or iterating.
+	UINT     firedBits[(CUEEVENT_COUNT + 31) / 32]; //which events have occurred
+	vector<CUEEVENT_ID> firedCIDs;          //events that have occurred, in order
+	vector<CID_PRIVDATA_NODE> privateData;  //private data of all events, in order added;
+	                                        //storage is kept when cleared
+
+	//Per event, valid only once the event has occurred.
+	UINT     firstPrivateData[CUEEVENT_COUNT], lastPrivateData[CUEEVENT_COUNT];
+	UINT     privateDataCount[CUEEVENT_COUNT];
 
 private:
 	void     Zero();
@@ -52,6 +52,7 @@
 #include "TileConstants.h"
 #include "NetInterface.h"
 #include "SettingsKeys.h"
+#include "StateHash.h"
 #include "Waterskipper.h"
 
 #include "../Texts/MIDs.h"
@@ -140,6 +141,8 @@ CCurrentGame::CCurrentGame()
 	, pLevel(NULL)
 	, pHold(NULL)
 	, bNoSaves(false) // Clear() does not set this
+	, dwAdjacentRoomsLoadedFor(0)
+	, bIsSnapshot(false)
 	, pSnapshotGame(NULL)
 {
 	//Zero resource members before calling Clear().
@@ -154,7 +157,8 @@ CCurrentGame::CCurrentGame()
 CCurrentGame::~CCurrentGame()
 //Destructor.
 {
-	if (this->bIsDemoRecording)
+	//Snapshots retain the recording state for restoration only.
+	if (this->bIsDemoRecording && !this->bIsSnapshot)
 	{
 		if (!EndDemoRecording())
 		{
@@ -165,6 +169,13 @@ CCurrentGame::~CCurrentGame()
 
 	if (this->Commands.IsFrozen()) this->Commands.Unfreeze();
 
+	if (this->bIsSnapshot)
+	{
+		//The hold and level are owned by the game this snapshot was taken from.
+		this->pLevel = NULL;
+		this->pHold = NULL;
+	}
+
 	Clear();
 }
 
@@ -350,12 +361,14 @@ void CCurrentGame::Clear(
 	const bool bNewGame)  //(in)   whether new game is starting [default=true]
 {
 	CDbSavedGame::Clear(bNewGame);  //Resets the Explored and Conquered room lists.
+	ResetHoldVarSlots();
 
 	delete this->pRoom;
 	this->pRoom = NULL;
 
 	delete this->pLevel;
 	this->pLevel = NULL;
+	ClearLoadedRooms();
 
 	if (bNewGame)
 	{
@@ -563,16 +576,16 @@ WSTRING CCurrentGame::ExpandText(const WCHAR* wText,
 						if (varID)
 						{
 							//Yes -- get its value, if defined.
-							char *varName = this->pHold->getVarAccessToken(wEscapeStr.c_str());
-							const UNPACKEDVARTYPE vType = this->stats.GetVarType(varName);
+							const UNPACKEDVARTYPE vType = GetHoldVarType(varID);
 							const bool bExistingIntValue = vType == UVT_int || vType == UVT_uint;
 							if (bExistingIntValue)
 							{
 								//Integer.
-								const int nVal = this->stats.GetVar(varName, int(0));
-								wStr += _itoW(nVal, wIntText, 10);
+								wStr += _itoW(GetHoldVarInt(varID), wIntText, 10);
 							} else if (vType == UVT_wchar_string || vType == UVT_unknown) {
 								//A text string.
+								char varName[12];
+								GetHoldVarAccessToken(varID, varName);
 								wStr += this->stats.GetVar(varName, wszEmpty);
 							}
 						} else {
@@ -628,13 +641,7 @@ UINT CCurrentGame::GetNextImageOverlayID()
 //*****************************************************************************
 WSTRING CCurrentGame::getTextForInputCommandKey(InputCommands::DCMD id) const
 {
-	ASSERT(id < InputCommands::DCMD_Count);
-
-	const CDbPackedVars settings = g_pTheDB->GetCurrentPlayerSettings();
-	const InputCommands::DCMD eCommand = InputCommands::DCMD(
-			settings.GetVar(InputCommands::COMMANDNAME_ARRAY[id], 0));
-
-	return g_pTheDB->GetMessageText(KeyToMID(eCommand));
+	return this->simulation.GetDataSource().GetInputCommandKeyText(id);
 }
 
 //*****************************************************************************
@@ -682,6 +689,51 @@ const
 	return dwSum;
 }
 
+//*****************************************************************************
+ULONGLONG CCurrentGame::GetStateHash(
+//Gets a 64-bit hash of the current game state.
+//
+//Unlike GetChecksum(), this covers the room's tiles and turn state (e.g.,
+//burning fuses), every monster (in processing order) with its type-specific
+//state, the player, game and script vars, and the turn counters, so two games
+//in different states will almost never hash alike.  Tiles and vars are hashed
+//incrementally as they change, so this is cheap to call every turn.  The value is only meaningful within one build of DRODLib, and
+//must not be stored in the DB.
+//
+//Note that the saved level stats include elapsed play time.
+//
+//Params:
+	const bool bExactTurn) //(in) if false, only the point in the spawn cycle
+	                       //is hashed instead of the turn counters, so the same
+	                       //position reached on different turns can hash alike.
+	                       //Scripts that count absolute turns aren't accounted
+	                       //for then. [default=true]
+//
+//Returns:
+//The hash.
+const
+{
+	ASSERT(this->pRoom);
+	ULONGLONG hash = this->pRoom->GetTileHash() ^ this->pRoom->GetTurnStateHash();
+
+	UINT wIndex = 0;
+	for (const CMonster *pMonster = this->pRoom->pFirstMonster; pMonster != NULL;
+			pMonster = pMonster->pNext)
+		hash ^= StateHash::Mix(pMonster->GetStateHash() + wIndex++);
+
+	hash ^= this->swordsman.GetStateHash();
+	hash ^= this->stats.GetHash();
+	const UINT wTurnNo = bExactTurn ? this->wTurnNo : 0;
+	const UINT wSpawnCycle = bExactTurn ? this->wSpawnCycleCount :
+			this->wSpawnCycleCount % TURNS_PER_CYCLE;
+	hash ^= StateHash::Key(StateHash::Game, this->pRoom->dwRoomID,
+			wTurnNo, (wSpawnCycle << 1) | (this->bHalfTurn ? 1 : 0));
+	hash ^= StateHash::Key(StateHash::Game, 0x80000000 | this->UnansweredQuestions.size(),
+			this->dwCutScene);
+
+	return hash;
+}
+
 //*****************************************************************************
 void CCurrentGame::GetLevelStats(CDbLevel *pLevel)
 //Extract stats for this level from packed vars.
@@ -892,6 +944,64 @@ WSTRING CCurrentGame::getStringVar(const UINT varIndex) const
 	}
 }
 
+//*****************************************************************************
+void CCurrentGame::GetHoldVarAccessToken(
+//Writes the name a hold var is stored under in stats.
+//
+//Params:
+	const UINT dwVarID, //(in)
+	char *varName)      //(out) room for at least 12 chars
+{
+	varName[0] = 'v';
+	_itoa(dwVarID, varName + 1, 10);
+}
+
+//*****************************************************************************
+const CCurrentGame::HOLDVARSLOT& CCurrentGame::GetHoldVarSlot(const UINT dwVarID) const
+//Returns: the slot for this hold var, with its value read from stats if needed
+{
+	if (this->dwHoldVarSlotsVersion != this->stats.GetVersion())
+		ResetHoldVarSlots(); //stats were changed directly
+
+	if (dwVarID >= this->holdVarSlots.size())
+		this->holdVarSlots.resize(dwVarID + 1);
+	HOLDVARSLOT& slot = this->holdVarSlots[dwVarID];
+	if (!slot.bLoaded)
+	{
+		char varName[12];
+		GetHoldVarAccessToken(dwVarID, varName);
+		slot.eType = this->stats.GetVarType(varName);
+		if (slot.eType == UVT_int || slot.eType == UVT_uint)
+			slot.nValue = this->stats.GetVar(varName, (int)0);
+		slot.bLoaded = true;
+	}
+	return slot;
+}
+
+//*****************************************************************************
+void CCurrentGame::ResetHoldVarSlots() const
+//Empties the hold var slots, so values are read from stats again as they are used.
+{
+	this->holdVarSlots.clear();
+	this->dwHoldVarSlotsVersion = this->stats.GetVersion();
+}
+
+//*****************************************************************************
+void CCurrentGame::SetHoldVar(const UINT dwVarID, const int nValue)
+//Sets an integer hold var.
+{
+	GetHoldVarSlot(dwVarID); //bring the slots up to date before stats change
+
+	char varName[12];
+	GetHoldVarAccessToken(dwVarID, varName);
+	this->stats.SetVar(varName, nValue);
+
+	HOLDVARSLOT& slot = this->holdVarSlots[dwVarID];
+	slot.eType = UVT_int;
+	slot.nValue = nValue;
+	this->dwHoldVarSlotsVersion = this->stats.GetVersion();
+}
+
 //*****************************************************************************
 void CCurrentGame::ProcessCommandSetVar(
 //Called when some predefined variables are changed,
@@ -1012,7 +1122,7 @@ bool CCurrentGame::IsCurrentLevelComplete() const
 {
 	ASSERT(this->pLevel);
 	CIDSet requiredRooms;
-	this->pLevel->GetRequiredRooms(requiredRooms);
+	this->simulation.GetDataSource().GetRequiredRooms(this->pLevel->dwLevelID, requiredRooms);
 	return CDbSavedGame::ConqueredRooms.contains(requiredRooms);
 }
 
@@ -1277,7 +1387,8 @@ bool CCurrentGame::IsRoomAtCoordsConquered(
 //True if it has, false if it hasn't.
 const
 {
-	const UINT dwRoomID = this->pLevel->GetRoomIDAtCoords(dwRoomX, dwRoomY);
+	const UINT dwRoomID = this->simulation.GetDataSource().GetRoomIDAtCoords(
+			*this->pLevel, dwRoomX, dwRoomY);
 	return CDbSavedGame::ConqueredRooms.has(dwRoomID);
 }
 
@@ -1292,7 +1403,8 @@ const
 //Returns:
 //True if it has, false if it hasn't.
 {
-	const UINT dwRoomID = this->pLevel->GetRoomIDAtCoords(dwRoomX, dwRoomY);
+	const UINT dwRoomID = this->simulation.GetDataSource().GetRoomIDAtCoords(
+			*this->pLevel, dwRoomX, dwRoomY);
 	return CDbSavedGame::ExploredRooms.has(dwRoomID);
 }
 
@@ -1919,6 +2031,39 @@ bool CCurrentGame::PlayCommandsToTurn(
 	return this->wTurnNo == wEndTurnNo;
 }
 
+//*****************************************************************************
+bool CCurrentGame::PrefetchAdjacentRoom()
+//Loads one room next to the current room that hasn't been loaded yet, so that
+//leaving the current room that way doesn't have to wait for it to load.
+//Call repeatedly while idle until all adjacent rooms are loaded.  Once they
+//are, further calls return at once until another room is entered.
+//
+//Returns: whether a room was loaded
+{
+	if (!this->pRoom || !this->pLevel)
+		return false;
+	if (this->dwAdjacentRoomsLoadedFor == this->pRoom->dwRoomID)
+		return false;
+
+	static const int dx[4] = {0, 1, 0, -1};
+	static const int dy[4] = {-1, 0, 1, 0};
+	const CGameDataSource& source = this->simulation.GetDataSource();
+	for (UINT wI = 0; wI < 4; ++wI)
+	{
+		const UINT dwRoomX = this->pRoom->dwRoomX + dx[wI];
+		const UINT dwRoomY = this->pRoom->dwRoomY + dy[wI];
+		const UINT dwRoomID = source.GetRoomIDAtCoords(*this->pLevel, dwRoomX, dwRoomY);
+		if (!dwRoomID || this->loadedRooms.count(dwRoomID))
+			continue;
+
+		this->loadedRooms[dwRoomID] = source.GetRoomAtCoords(*this->pLevel, dwRoomX, dwRoomY);
+		return true;
+	}
+
+	this->dwAdjacentRoomsLoadedFor = this->pRoom->dwRoomID;
+	return false;
+}
+
 //*****************************************************************************
 void CCurrentGame::PostProcessCharacter(CCharacter* pCharacter, CCueEvents& CueEvents)
 //Call after processing a character's turn.
@@ -2165,7 +2310,7 @@ void CCurrentGame::ProcessCommand(
 			{
 				//If play in room stopped, then room processing won't take place
 				//and outstanding data must be cleaned up here.
-				CPlatform::clearFallTiles();
+				this->simulation.fallTiles.clear();
 				UpdatePrevCoords(); //monsters are no longer moving from previous position
 			} else {
 				//When player becomes an enemy target this turn, brain pathmap needs to be updated.
@@ -2274,7 +2419,10 @@ void CCurrentGame::ProcessCommand(
 		FlagChallengesCompleted(CueEvents);
 
 	//Should never have anything left unprocessed at end of turn.
-	ASSERT(!CPlatform::fallTilesPending());
+	ASSERT(this->simulation.fallTiles.empty());
+
+	//Weapons stay put until the next command.
+	this->pRoom->SettleWeaponSquares();
 
 	//Make a queue of periodic game snapshots that can be retrieved to reduce
 	//in-game rewind/replay time.
@@ -2309,7 +2457,7 @@ void CCurrentGame::ProcessCheckpointActivation(CCueEvents& CueEvents)
 void CCurrentGame::SnapshotGameState()
 {
 	this->dwComputationTime = 0; //reset before saving snapshot
-	CCurrentGame *pNewSnapshot = new CCurrentGame(*this);
+	CCurrentGame *pNewSnapshot = new CCurrentGame(*this, true);
 	if (pNewSnapshot)
 	{
 		pNewSnapshot->pSnapshotGame = this->pSnapshotGame;
@@ -2480,7 +2628,7 @@ void CCurrentGame::ProcessReactionToPlayerMove(int nCommand, CCueEvents& CueEven
 	this->pRoom->ExplodeStabbedPowderKegs(CueEvents);
 
 	//Check for stuff falling as a result of monster moves now.
-	if (CPlatform::fallTilesPending())
+	if (!this->simulation.fallTiles.empty())
 		CPlatform::checkForFalling(this->pRoom, CueEvents);
 
 	ResolveSimultaneousTarstuffStabs(CueEvents);
@@ -4862,6 +5010,17 @@ bool CCurrentGame::CanSwitchToClone() const
 	return true;
 }
 
+//*****************************************************************************
+void CCurrentGame::ClearLoadedRooms()
+//Frees the rooms kept as loaded from the DB.
+{
+	for (map<UINT, CDbRoom*>::const_iterator room = this->loadedRooms.begin();
+			room != this->loadedRooms.end(); ++room)
+		delete room->second;
+	this->loadedRooms.clear();
+	this->dwAdjacentRoomsLoadedFor = 0;
+}
+
 //*****************************************************************************
 void CCurrentGame::DeleteLeakyCueEvents(CCueEvents &CueEvents)
 //Deletes objects allocated on the heap and connected to cue events
@@ -4939,6 +5098,30 @@ void CCurrentGame::FlagChallengesCompleted(CCueEvents& CueEvents)
 	WriteCompletedChallengeDemo(!this->wTurnNo ? challengesCompleted : set<WSTRING>());
 }
 
+//*****************************************************************************
+CDbRoom* CCurrentGame::GetRoomAtCoords(
+//Returns: new room at the given coords on the current level, as loaded from the
+//DB, or NULL if there is none.  Caller must delete it.
+//
+//Params:
+	const UINT dwRoomX, const UINT dwRoomY) //(in) coords of room
+{
+	ASSERT(this->pLevel);
+	const CGameDataSource& source = this->simulation.GetDataSource();
+	const UINT dwRoomID = source.GetRoomIDAtCoords(*this->pLevel, dwRoomX, dwRoomY);
+	if (!dwRoomID)
+		return NULL;
+
+	CDbRoom* &pLoadedRoom = this->loadedRooms[dwRoomID];
+	if (!pLoadedRoom)
+	{
+		pLoadedRoom = source.GetRoomAtCoords(*this->pLevel, dwRoomX, dwRoomY);
+		if (!pLoadedRoom)
+			return NULL;
+	}
+	return new CDbRoom(*pLoadedRoom);
+}
+
 //***************************************************************************************
 bool CCurrentGame::IsSwordsmanTired()
 //Returns: Whether swordsman has just finished a long job
@@ -5152,7 +5335,7 @@ bool CCurrentGame::PlayerCanExitRoom(
 	}
 
 	//Attempt to load room.
-	pNewRoom = this->pLevel->GetRoomAtCoords(dwNewRoomX, dwNewRoomY);
+	pNewRoom = GetRoomAtCoords(dwNewRoomX, dwNewRoomY);
 	if (!pNewRoom)
 		return false;
 
@@ -5184,11 +5367,11 @@ bool CCurrentGame::PlayerCanExitRoom(
 	this->wTurnNo = wTurnNo_;
 
 	if (pNewRoom->bCheckForHoldCompletion && !this->bHoldCompleted) {
-		this->bHoldCompleted = g_pTheDB->Holds.IsHoldCompleted(this->pHold->dwHoldID, g_pTheDB->GetPlayerID());
+		this->bHoldCompleted = this->simulation.GetDataSource().IsHoldCompleted(this->pHold->dwHoldID);
 		pNewRoom->bCheckForHoldCompletion = false;
 	}
 	if (pNewRoom->bCheckForHoldMastery && !this->bHoldMastered) {
-		this->bHoldMastered = g_pTheDB->Holds.IsHoldMastered(this->pHold->dwHoldID, g_pTheDB->GetPlayerID());
+		this->bHoldMastered = this->simulation.GetDataSource().IsHoldMastered(this->pHold->dwHoldID);
 		pNewRoom->bCheckForHoldMastery = false;
 	}
 
@@ -5427,7 +5610,9 @@ void CCurrentGame::ProcessMonsters(
 	bool bBrainCheck = this->pRoom->wBrainCount == 0; //for brains
 
 	//Each iteration processes one monster.
-	for (CMonster *pMonster = this->pRoom->pFirstMonster; pMonster != NULL; pMonster = pMonster->pNext)
+	CMonster *pMonster;
+	this->pRoom->StartMonsterProcessing();
+	while ((pMonster = this->pRoom->GetNextMonsterToProcess()) != NULL)
 	{
 		this->pRoom->ClearPushStates();
 
@@ -5465,8 +5650,10 @@ void CCurrentGame::ProcessMonsters(
 	}
 
 	//Process all monsters again to remove Stun checks added this turn
-	for (CMonster *pMonster = this->pRoom->pFirstMonster; pMonster != NULL; pMonster = pMonster->pNext)
+	const vector<CMonster*>& monsters = this->pRoom->GetMonstersInProcessOrder();
+	for (vector<CMonster*>::const_iterator m = monsters.begin(); m != monsters.end(); ++m)
 	{
+		pMonster = *m;
 		if (pMonster->stunned)
 		{
 			//Monsters are stunned for this turn and next full turn
@@ -6645,19 +6832,43 @@ void CCurrentGame::SaveExitedLevelStats()
 }
 
 //***************************************************************************************
-void CCurrentGame::SetMembers(const CCurrentGame &Src)
+void CCurrentGame::SetMembers(
 //Performs deep copy.
+//
+//Params:
+	const CCurrentGame &Src,
+	const bool bSnapshot) //(in) [default=false] when set, make a lightweight copy
+	                      //for rewinding play within the current room:
+	                      //the hold and level are borrowed from Src, and the
+	                      //command list is not copied (it is retained by the
+	                      //live game when a snapshot is restored)
 {
-	CDbSavedGame::operator=(Src);
+	CDbSavedGame::SetMembers(Src, !bSnapshot);
+	ResetHoldVarSlots();
 
 	ASSERT(Src.pHold);
-	if (this->pHold)
-		delete this->pHold;
-	this->pHold = new CDbHold(*Src.pHold);
 	ASSERT(Src.pLevel);
-	if (this->pLevel)
-		delete this->pLevel;
-	this->pLevel = new CDbLevel(*Src.pLevel);
+	if (bSnapshot)
+	{
+		ASSERT(!this->pHold && !this->pLevel);
+		this->pHold = Src.pHold;
+		this->pLevel = Src.pLevel;
+	} else {
+		//When restoring from a snapshot, the hold and level are already shared.
+		if (this->pHold != Src.pHold)
+		{
+			delete this->pHold;
+			this->pHold = new CDbHold(*Src.pHold);
+		}
+		if (this->pLevel != Src.pLevel)
+		{
+			delete this->pLevel;
+			this->pLevel = new CDbLevel(*Src.pLevel);
+		}
+	}
+	//Scratch state isn't copied, but hold data is read from the same place.
+	this->simulation.SetDataSource(&Src.simulation.GetDataSource());
+
 	ASSERT(Src.pRoom);
 	if (this->pRoom)
 		delete this->pRoom;
@@ -6988,6 +7199,8 @@ void CCurrentGame::SetMembersAfterRoomLoad(
 	this->roomSpeech.clear();
 
 	StashPersistingEvents(CueEvents);
+
+	this->pRoom->SettleWeaponSquares();
 }
 
 //*****************************************************************************
@@ -7150,7 +7363,7 @@ bool CCurrentGame::SetRoomAtCoords(
 //stay loaded.
 {
 	//Load new room.
-	CDbRoom *pNewRoom = this->pLevel->GetRoomAtCoords(dwRoomX, dwRoomY);
+	CDbRoom *pNewRoom = GetRoomAtCoords(dwRoomX, dwRoomY);
 	if (!pNewRoom)
 		return false;
 
@@ -7456,10 +7669,11 @@ void CCurrentGame::UpdateHoldMastery(CCueEvents& CueEvents)
 		return; //nothing to do
 
 	const UINT holdID = this->pHold->dwHoldID;
-	this->bHoldMastered = g_pTheDB->Holds.IsHoldMastered(holdID, this->dwPlayerID); //already known
+	this->bHoldMastered = this->simulation.GetDataSource().IsHoldMastered(holdID); //already known
 
-	//New mastery?
-	if (!this->bHoldMastered) {
+	//New mastery?  Scanning reads the player's saved games, and a mastery that
+	//can't be saved isn't reported.
+	if (!this->bHoldMastered && !this->bNoSaves) {
 		this->bHoldMastered = g_pTheDB->Holds.ScanForNewHoldMastery(holdID, this->dwPlayerID, true); //no need to recheck for mastery save
 		if (this->bHoldMastered) {
 			CueEvents.Add(CID_HoldMastered);
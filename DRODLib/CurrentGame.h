@@ -47,8 +47,10 @@
 //CID_TarDestroyed, do not require handling, but can be used to cue sound and graphical
 //effects.
 //
-//Multiple instances of CCurrentGame may be open simultaneously, but don't access
-//CCurrentGame instances on different threads.
+//Multiple instances of CCurrentGame may be open simultaneously.  Separate instances
+//may be stepped on different threads, provided each one's simulation context reads
+//hold data through a thread-safe source (see SimulationContext.h) and the DB is not
+//otherwise in use meanwhile.  Don't access one instance from more than one thread.
 //
 //DOES MY NEW METHOD GO IN CDbRoom OR CCurrentGame?
 //
@@ -82,6 +84,7 @@
 #include "Monster.h"
 #include "MonsterMessage.h"
 #include "RoomData.h"
+#include "SimulationContext.h"
 #include "Swordsman.h"
 #include <BackEndLib/Assert.h>
 #include <BackEndLib/AttachableObject.h>
@@ -164,11 +167,14 @@ class CCurrentGame : public CDbSavedGame
 {
 protected:
 	friend class CDb;
+	friend class CRoomSolver;
+	friend class CGameDataSnapshot;
 	CCurrentGame();
-	CCurrentGame(const CCurrentGame &Src)
+	CCurrentGame(const CCurrentGame &Src, const bool bSnapshot=false)
 		: CDbSavedGame(false), pRoom(NULL), pLevel(NULL),
-		  pHold(NULL), pEntrance(NULL), pSnapshotGame(NULL)
-	{SetMembers(Src);}
+		  pHold(NULL), pEntrance(NULL), dwAdjacentRoomsLoadedFor(0),
+		  bIsSnapshot(bSnapshot), pSnapshotGame(NULL)
+	{SetMembers(Src, bSnapshot);}
 
 public:
 	~CCurrentGame();
@@ -193,8 +199,12 @@ public:
 	void     FreezeCommands();
 	UINT     GetAutoSaveOptions() const {return this->dwAutoSaveOptions;}
 	UINT     GetChecksum() const;
+	ULONGLONG GetStateHash(const bool bExactTurn=true) const;
 	int      GetCutSceneStartTurn() const {return this->cutSceneStartTurn;}
 	const CEntity* GetDyingEntity() const {return this->pDyingEntity;}
+	static void GetHoldVarAccessToken(const UINT dwVarID, char *varName);
+	int      GetHoldVarInt(const UINT dwVarID) const {return GetHoldVarSlot(dwVarID).nValue;}
+	UNPACKEDVARTYPE GetHoldVarType(const UINT dwVarID) const {return GetHoldVarSlot(dwVarID).eType;}
 	const CEntity* GetKillingEntity() const {return this->pKillingEntity;}
 	void     GetLevelStats(CDbLevel *pLevel);
 	MusicData GetMusic() const { return music; }
@@ -202,6 +212,7 @@ public:
 	UINT     GetNextImageOverlayID();
 	UINT     GetRoomExitDirection(const UINT wMoveO) const;
 	WSTRING  GetScrollTextAt(const UINT wX, const UINT wY);
+	CSimulationContext& GetSimulationContext() const {return this->simulation;}
 	CEntity* getSpeakingEntity(CFiredCharacterCommand* pFiredCommand);
 	bool     GetSwordsman(UINT& wSX, UINT& wSY, const bool bIncludeNonTarget=false) const;
 	UINT     GetSwordMovement() const
@@ -231,6 +242,7 @@ public:
 	bool     IsRoomAtCoordsConquered(const UINT dwRoomX, const UINT dwRoomY) const;
 	bool     IsRoomAtCoordsExplored(const UINT dwRoomX, const UINT dwRoomY) const;
 	static bool IsSupportedPlayerRole(const UINT wType);
+	void     SetHoldVar(const UINT dwVarID, const int nValue);
 	bool     ShouldSaveRoomBegin(const UINT dwRoomID) const;
 	bool     LoadFromHold(const UINT dwHoldID, CCueEvents &CueEvents);
 	bool     LoadFromLevelEntrance(const UINT dwEntranceID,	CCueEvents &CueEvents);
@@ -246,6 +258,7 @@ public:
 	bool     PlayCommandsToTurn(const UINT wEndTurnNo, CCueEvents &CueEvents);
 	bool     PlayerEnteredTunnel(const UINT wOTileNo, const UINT wMoveO, UINT wRole = M_NONE) const;
 	void     PostProcessCharacter(CCharacter* pCharacter, CCueEvents& CueEvents);
+	bool     PrefetchAdjacentRoom();
 	void     ProcessCommandSetVar(const UINT itemID, UINT newVal);
 	void     ProcessCommand(int nCommand, CCueEvents &CueEvents,
 			UINT wX=(UINT)-1, UINT wY=(UINT)-1);
@@ -373,11 +386,13 @@ private:
 	void     BlowHorn(CCueEvents &CueEvents, const UINT wSummonType,
 						const UINT wHornX, const UINT wHornY);
 	bool     CanSwitchToClone() const;
+	void     ClearLoadedRooms();
 	bool     ContinueQueuingTemporalSplitMoves() const;
 	void     DeleteLeakyCueEvents(CCueEvents &CueEvents);
 	void     DrankPotion(CCueEvents &CueEvents, const UINT wDoubleType,
 							const UINT wPotionX, const UINT wPotionY);
 	void     FlagChallengesCompleted(CCueEvents &CueEvents);
+	CDbRoom* GetRoomAtCoords(const UINT dwRoomX, const UINT dwRoomY);
 	bool     IsActivatingTemporalSplit() const;
 	bool     IsSwordsmanTired();
 	void     LoadNewRoomForExit(const UINT dwNewSX, const UINT dwNewSY,
@@ -409,12 +424,13 @@ private:
 	bool     RemoveInvalidCommand(const CCueEvents& CueEvents);
 	void     RemoveClearedImageOverlays(const int clearLayers);
 	void     ResetCutSceneStartTurn() { cutSceneStartTurn = -1; }
+	void     ResetHoldVarSlots() const;
 	void     ResetPendingTemporalSplit(CCueEvents& CueEvents);
 	void     ResetTemporalSplitQueuingIfInvalid(CCueEvents& CueEvents);
 	void     ResolveSimultaneousTarstuffStabs(CCueEvents &CueEvents);
 	void     RoomEntranceAsserts();
 	void     SaveExitedLevelStats();
-	void     SetMembers(const CCurrentGame &Src);
+	void     SetMembers(const CCurrentGame &Src, const bool bSnapshot=false);
 	void     SetMembersAfterRoomLoad(CCueEvents &CueEvents, const bool bResetCommands=true, const bool bInitialEntrance=true);
 	void     SetPlayerMood(CCueEvents &CueEvents);
 	void     SetPlayerToRoomStart();
@@ -464,6 +480,30 @@ private:
 	bool     bNoSaves;   //don't save anything to DB when set (e.g., for dummy game sessions)
 	bool     bWasRoomConqueredAtTurnStart;
 
+	mutable CSimulationContext simulation; //per-game scratch state for room objects
+
+	//Rooms as loaded from the DB, by room ID, or NULL if a room failed to load.
+	//Rooms are entered as copies of these, so going back to a room, or into one
+	//prefetched by PrefetchAdjacentRoom, doesn't read and unpack it again.
+	map<UINT, CDbRoom*> loadedRooms;
+	UINT     dwAdjacentRoomsLoadedFor; //room whose adjacent rooms are all loaded
+
+	//Values of hold vars indexed by var ID, read from stats the first time they
+	//are used.  Vars set through SetHoldVar are written to stats as well, so
+	//stats always has every value for saving.  Any other change to stats
+	//empties the slots.
+	struct HOLDVARSLOT
+	{
+		HOLDVARSLOT() : bLoaded(false), eType(UVT_unknown), nValue(0) { }
+		bool bLoaded;
+		UNPACKEDVARTYPE eType;
+		int nValue; //for integer types, else 0
+	};
+	const HOLDVARSLOT& GetHoldVarSlot(const UINT dwVarID) const;
+	mutable vector<HOLDVARSLOT> holdVarSlots;
+	mutable UINT dwHoldVarSlotsVersion; //version of stats the slots were read from
+
+	bool     bIsSnapshot; //borrows hold and level from the game it was taken from
 	CCurrentGame *pSnapshotGame; //for optimized room rewinds
 	UINT dwComputationTime; //time required to process game moves up to this point
 	UINT dwComputationTimePerSnapshot; //real movement computation time between game state snapshots
@@ -186,6 +186,18 @@ SOURCE=.\SettingsKeys.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\SimulationContext.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\SimulationContext.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\StateHash.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Swordsman.cpp
 # End Source File
 # Begin Source File
@@ -360,6 +372,22 @@ SOURCE=.\ImportInfo.cpp
 
 SOURCE=.\ImportInfo.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\ReplayVerifier.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\ReplayVerifier.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\RoomSolver.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\RoomSolver.h
+# End Source File
 # End Group
 # Begin Group "Monsters"
 
@@ -562,6 +590,14 @@ SOURCE=.\MonsterPiece.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\MonsterPool.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\MonsterPool.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Neather.cpp
 # End Source File
 # Begin Source File
@@ -626,6 +662,14 @@ SOURCE=.\RockGolem.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ScriptExpression.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\ScriptExpression.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Seep.cpp
 # End Source File
 # Begin Source File
@@ -375,8 +375,16 @@ typedef map<UINT,RoomOwnership> roomMap;
 
 typedef map<UINT,UINT> idMap;
 
+//Room fields queried during play, so they needn't be read from the DB each turn.
+struct LevelRoomInfo {
+	CIDSet requiredRoomIDs, secretRoomIDs;
+	map<ROOMCOORD,UINT> roomAtCoords;
+};
+typedef map<UINT,LevelRoomInfo> levelInfoMap;
+
 holdMap holdIndex; //hold -> levels + data
 levelMap levelIndex; //level -> rooms
+levelInfoMap levelRoomInfoIndex; //level -> room info; built when first queried
 roomMap roomIndex; //room -> saved games + demos
 idMap demoIndex; //demo -> saved game
 idMap demosHoldIndex; //demo -> hold
@@ -464,6 +472,7 @@ void CDb::addRoomToLevel(const UINT roomID, const UINT levelID)
 	levelMap::iterator level = levelIndex.find(levelID);
 	ASSERT(level != levelIndex.end());
 	level->second += roomID;
+	levelRoomInfoIndex.erase(levelID);
 }
 
 //*****************************************************************************
@@ -521,6 +530,7 @@ void CDb::deleteLevel(const UINT levelID)
 //Remove level from index.
 {
 	CDbBase::DirtyHold();
+	levelRoomInfoIndex.erase(levelID);
 	levelMap::iterator levelIter = levelIndex.find(levelID);
 	if (levelIter != levelIndex.end())
 	{
@@ -552,6 +562,7 @@ void CDb::deleteRoom(const UINT roomID)
 			levelMap::iterator level = levelIndex.find(levelID);
 			ASSERT(level != levelIndex.end());
 			level->second -= roomID;
+			levelRoomInfoIndex.erase(levelID);
 		}
 	}
 }
@@ -650,6 +661,69 @@ CIDSet CDb::getRoomsInLevel(const UINT levelID)
 	return levelIter->second;
 }
 
+//*****************************************************************************
+static const LevelRoomInfo& getLevelRoomInfo(const UINT levelID)
+//Returns: cached info on the rooms in this level, read from the DB if not cached
+{
+	levelInfoMap::const_iterator found = levelRoomInfoIndex.find(levelID);
+	if (found != levelRoomInfoIndex.end())
+		return found->second;
+
+	LevelRoomInfo& info = levelRoomInfoIndex[levelID];
+	const CIDSet roomsInLevel = CDb::getRoomsInLevel(levelID);
+	c4_View RoomsView;
+	for (CIDSet::const_iterator room = roomsInLevel.begin(); room != roomsInLevel.end(); ++room)
+	{
+		const UINT roomRowI = CDb::LookupRowByPrimaryKey(*room, V_Rooms, RoomsView);
+		if (roomRowI == ROW_NO_MATCH)
+		{
+			ASSERT(!"No matching room.");
+			continue;
+		}
+		c4_RowRef row = RoomsView[roomRowI];
+		if (p_IsRequired(row) != 0)
+			info.requiredRoomIDs += *room;
+		if (p_IsSecret(row) != 0)
+			info.secretRoomIDs += *room;
+
+		//If two rooms somehow share coords, the first one is found, as in CDbRooms::FindIDAtCoords.
+		const ROOMCOORD coords(UINT(p_RoomX(row)), UINT(p_RoomY(row)));
+		if (!info.roomAtCoords.count(coords))
+			info.roomAtCoords[coords] = *room;
+	}
+	return info;
+}
+
+//*****************************************************************************
+CIDSet CDb::getRequiredRoomsInLevel(const UINT levelID)
+//Returns: set of roomIDs in this level required to complete it
+{
+	return getLevelRoomInfo(levelID).requiredRoomIDs;
+}
+
+//*****************************************************************************
+UINT CDb::getRoomIDAtCoords(const UINT levelID, const UINT roomX, const UINT roomY)
+//Returns: ID of room in this level at the given coords, or 0 if none
+{
+	const LevelRoomInfo& info = getLevelRoomInfo(levelID);
+	map<ROOMCOORD,UINT>::const_iterator found = info.roomAtCoords.find(ROOMCOORD(roomX, roomY));
+	return found != info.roomAtCoords.end() ? found->second : 0;
+}
+
+//*****************************************************************************
+map<ROOMCOORD,UINT> CDb::getRoomCoordsInLevel(const UINT levelID)
+//Returns: the ID of the room at each room coord in this level
+{
+	return getLevelRoomInfo(levelID).roomAtCoords;
+}
+
+//*****************************************************************************
+CIDSet CDb::getSecretRoomsInLevel(const UINT levelID)
+//Returns: set of secret roomIDs in this level
+{
+	return getLevelRoomInfo(levelID).secretRoomIDs;
+}
+
 //*****************************************************************************
 UINT CDb::getSavedGameOfDemo(const UINT demoID)
 //Returns: savedGameID that this demo is tied to
@@ -731,9 +805,15 @@ void CDb::moveRoom(const UINT roomID, const UINT fromLevelID, const UINT toLevel
 //Updates room-level indexing when room might have changed levels.
 {
 	CDbBase::DirtyHold();
+
+	//The room's coords and flags may be changing too.
+	levelRoomInfoIndex.erase(toLevelID);
+
 	if (fromLevelID == toLevelID)
 		return; //room is in the same level as before
 
+	levelRoomInfoIndex.erase(fromLevelID);
+
 	//Remove room index from previous level.
 	levelMap::iterator level = levelIndex.find(fromLevelID);
 	ASSERT(level != levelIndex.end());
@@ -776,6 +856,7 @@ void CDb::resetIndex()
 {
 	holdIndex.clear();
 	levelIndex.clear();
+	levelRoomInfoIndex.clear();
 	roomIndex.clear();
 	demoIndex.clear();
 	demosHoldIndex.clear();
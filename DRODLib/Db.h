@@ -116,12 +116,16 @@ public:
 	static CIDSet getDemosInRoom(const UINT roomID);
 	static UINT   getHoldOfDemo(const UINT demoID);
 	static CIDSet getLevelsInHold(const UINT holdID);
+	static CIDSet getRequiredRoomsInLevel(const UINT levelID);
+	static UINT   getRoomIDAtCoords(const UINT levelID, const UINT roomX, const UINT roomY);
+	static map<ROOMCOORD,UINT> getRoomCoordsInLevel(const UINT levelID);
 	static CIDSet getRoomsInHold(const UINT holdID);
 	static CIDSet getRoomsInLevel(const UINT levelID);
 	static UINT   getSavedGameOfDemo(const UINT demoID);
 	static CIDSet getSavedGamesInHold(const UINT holdID);
 	static CIDSet getSavedGamesInLevel(const UINT levelID);
 	static CIDSet getSavedGamesInRoom(const UINT roomID);
+	static CIDSet getSecretRoomsInLevel(const UINT levelID);
 	static bool   holdExists(const UINT holdID);
 	static bool   levelExists(const UINT levelID);
 	static void   moveData(const UINT dataID, const UINT fromHoldID, const UINT toHoldID);
@@ -1478,9 +1478,13 @@ void CDbBase::deleteMessages(const CIDSet& messageIDs, const CIDSet& rowIDs)
 			message != messageIndex.end(); ++message)
 	{
 		//Correct row index for each messageTextID belonging to this messageID.
+		//Rows keep their order when shifted down, so the new row indices
+		//may be gathered in order and replace the old ones all at once.
 		CIDSet& ids = message->second;
-		CIDSet::iterator messageTextRow = ids.begin();
-		while (messageTextRow != ids.end())
+		vector<UINT> newRows;
+		newRows.reserve(ids.size());
+		for (CIDSet::const_iterator messageTextRow = ids.begin();
+				messageTextRow != ids.end(); ++messageTextRow)
 		{
 			//Tally how many rows before this row have been deleted.
 			const UINT oldRow = *messageTextRow;
@@ -1492,17 +1496,11 @@ void CDbBase::deleteMessages(const CIDSet& messageIDs, const CIDSet& rowIDs)
 					break; //no more rows before the old row have been deleted
 			}
 
-			if (rowOffset)
-			{
-				//We can replace a value in this set with a lower value this way.
-				messageTextRow = ids.erase(messageTextRow); //increments iterator
-				ASSERT(oldRow >= rowOffset);
-				ASSERT(!ids.has(oldRow - rowOffset)); //this row index shouldn't already be present in the set
-				ids += (oldRow - rowOffset);
-			} else {
-				++messageTextRow; //this messageText's row index has not changed
-			}
+			ASSERT(oldRow >= rowOffset);
+			ASSERT(newRows.empty() || newRows.back() < oldRow - rowOffset); //row indices stay distinct
+			newRows.push_back(oldRow - rowOffset);
 		}
+		ids = CIDSet(newRows);
 	}
 }
 
@@ -1168,27 +1168,48 @@ bool CDbDemo::Test(
 //True if demo was able to be completely processed, false if not. 
 const
 {
-	bool bSuccess = true;
+	CCueEvents CueEvents;
+	CCurrentGame *pGame = LoadTestGame(CueEvents, bConsiderHoldCompleted, bConsiderHoldMastered);
+	if (!pGame)
+		return false;
+
+	const bool bSuccess = TestGame(pGame, CueEvents, DemoStats);
+	delete pGame;
+	return bSuccess;
+}
 
+//*****************************************************************************
+CCurrentGame* CDbDemo::LoadTestGame(
+//Loads the saved game for this demo, ready to be replayed by TestGame().
+//All DB access needed to test a demo happens here.
+//
+//Params:
+	CCueEvents &CueEvents, //(out) Cue events generated on entering the room.
+	const bool bConsiderHoldCompleted,  //(in) if true, assumes the hold has been completed for this demo [default=false]
+	const bool bConsiderHoldMastered)  //(in) if true, assumes the hold is mastered for this demo [default=false]
+//
+//Returns:
+//New game object the caller must delete, or NULL if the demo can't be tested.
+const
+{
 	ASSERT(CDbBase::IsOpen());
 	ASSERT(this->dwSavedGameID);
 
 	//Load current game from saved game with option to restore from beginning
 	//of room without playing commands.
-	CCueEvents CueEvents;
 	CCurrentGame *pGame = g_pTheDB->GetSavedCurrentGame(this->dwSavedGameID, CueEvents, true,
 			true); //don't save anything to DB during playback
 	if (!pGame)
 	{
 		ASSERT(!"Saved game for demo couldn't be loaded.");
-		return false;
+		return NULL;
 	}
 	if (!pGame->bIsGameActive)
 	{
 		//Left the room on turn zero, e.g. stairs at the entrance.  Old versions of DROD
 		//sometimes recorded demos in this situation, but they're always invalid.
 		delete pGame;
-		return false;
+		return NULL;
 	}
 
 	//Verify that the player's entrance into the room still exists.
@@ -1196,23 +1217,16 @@ const
 	if (!pGame->IsPlayerEntranceValid())
 	{
 		delete pGame;
-		return false;
+		return NULL;
 	}
 
-	UINT wEndTurn = this->wEndTurnNo;
-	const UINT numCommands = pGame->Commands.Count();
-	if (numCommands < this->wEndTurnNo + 1)
+	if (!pGame->Commands.Count() && this->wEndTurnNo > 0)
 	{
-		//This could happen if saved game for demo was invalidated and truncated.
-		//Perform demo test as best as possible (i.e. while play sequence is valid).
-		if (!numCommands && this->wEndTurnNo > 0)
-		{
-			//Invalid demo state invariant.
-			delete pGame;
-			return false;
-		}
-		wEndTurn = numCommands ? numCommands - 1 : 0;
+		//Invalid demo state invariant.
+		delete pGame;
+		return NULL;
 	}
+
 	pGame->SetAutoSaveOptions(ASO_NONE); //No auto-saving for playback.
 	pGame->SetComputationTimePerSnapshot(UINT(-1)); //don't take snapshots on test
 	if (bConsiderHoldCompleted)
@@ -1220,6 +1234,36 @@ const
 	if (bConsiderHoldMastered)
 		pGame->bHoldMastered = true;
 
+	return pGame;
+}
+
+//*****************************************************************************
+bool CDbDemo::TestGame(
+//Tests this demo against a game returned by LoadTestGame(), running all the
+//commands without UI interaction.  The game is left in its final state and
+//is not deleted.
+//
+//Params:
+	CCurrentGame *pGame,   //(in/out) Game loaded for this demo.
+	CCueEvents &CueEvents, //(in/out) Cue events generated when the game was loaded.
+	CIDList &DemoStats)    //(out) Returned containing statistics about things that happened.
+//
+//Returns:
+//True if demo was able to be completely processed, false if not.
+const
+{
+	ASSERT(pGame);
+	bool bSuccess = true;
+
+	UINT wEndTurn = this->wEndTurnNo;
+	const UINT numCommands = pGame->Commands.Count();
+	if (numCommands < this->wEndTurnNo + 1)
+	{
+		//This could happen if saved game for demo was invalidated and truncated.
+		//Perform demo test as best as possible (i.e. while play sequence is valid).
+		wEndTurn = numCommands ? numCommands - 1 : 0;
+	}
+
 	//Check for room conquered cue event which could have occurred on first
 	//step into room.
 	bool bWasRoomConquered = CueEvents.HasOccurred(CID_ConquerRoom);
@@ -1344,7 +1388,6 @@ const
 	}
 
 	pGame->UnfreezeCommands();
-	delete pGame;
 	return bSuccess;
 }
 
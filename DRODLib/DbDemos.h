@@ -101,11 +101,16 @@ public:
 	void        SetFlag(const DemoFlag eFlag, const bool bSet=true);
 
 	bool        Load(const UINT dwDemoID, const bool bQuick=false);
+	CCurrentGame * LoadTestGame(CCueEvents &CueEvents,
+			const bool bConsiderHoldCompleted=false,
+			const bool bConsiderHoldMastered=false) const;
 	virtual MESSAGE_ID   SetProperty(const PROPTYPE pType, char* const str,
 			CImportInfo &info, bool &bSaveRecord);
 	bool        Test(CIDList &DemoStats,
 			const bool bConsiderHoldCompleted=false,
 			const bool bConsiderHoldMastered=false) const;
+	bool        TestGame(CCurrentGame *pGame, CCueEvents &CueEvents,
+			CIDList &DemoStats) const;
 	virtual bool   Update();
 
 	UINT       dwDemoID;
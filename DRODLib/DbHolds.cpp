@@ -1134,16 +1134,13 @@ void CDbHolds::GetRooms(const UINT dwHoldID, HoldStats& stats) const
 	stats.requiredRooms.clear();
 	stats.secretRooms.clear();
 
-	//Get all rooms in hold.
-	CIDSet roomsInHold = CDb::getRoomsInHold(dwHoldID);
-	for (CIDSet::const_iterator room = roomsInHold.begin(); room != roomsInHold.end(); ++room)
+	//Get all rooms in hold, level by level.
+	const CIDSet levelsInHold = CDb::getLevelsInHold(dwHoldID);
+	for (CIDSet::const_iterator level = levelsInHold.begin(); level != levelsInHold.end(); ++level)
 	{
-		//Tally stats for room.
-		stats.rooms += *room;
-		if (CDbRoom::IsRequired(*room))
-			stats.requiredRooms += *room;
-		if (CDbRoom::IsSecret(*room))
-			stats.secretRooms += *room;
+		stats.rooms += CDb::getRoomsInLevel(*level);
+		stats.requiredRooms += CDb::getRequiredRoomsInLevel(*level);
+		stats.secretRooms += CDb::getSecretRoomsInLevel(*level);
 	}
 }
 
@@ -1784,6 +1781,7 @@ UINT CDbHold::AddVar(const WCHAR* pwszName)
 
 	const UINT dwNewVarID = ++this->dwVarID;
 	this->vars.push_back(HoldVar(dwNewVarID, pwszName));
+	this->varIDs.insert(std::make_pair(WSTRING(pwszName), dwNewVarID));
 	return dwNewVarID;
 }
 
@@ -1840,6 +1838,7 @@ bool CDbHold::DeleteVar(const UINT dwVarID)
 		if (var->dwVarID == dwVarID)
 		{
 			this->vars.erase(var);
+			IndexVarNames();
 			return true;
 		}
 	return false;
@@ -2413,6 +2412,7 @@ bool CDbHold::LoadVars(
 		GetWString(name, VarNameTextBytes);
 		const UINT varID = (UINT)(p_VarID(row));
 		this->vars.push_back(HoldVar(varID, name.c_str()));
+		this->varIDs.insert(std::make_pair(name, varID));
 
 		//In-play optimization: not kept current during hold var editing
 		if (ScriptVars::IsCharacterLocalVar(name))
@@ -2627,10 +2627,11 @@ void CDbHold::getStats(RoomStats& stats) const
 //*****************************************************************************
 char* CDbHold::getVarAccessToken(const WCHAR* pName) const
 //Returns: pointer to the text string used to access the variable
-//with this name in the hold's packed vars
+//with this name in the hold's packed vars.
+//The string is overwritten by the next call on this hold.
 {
-	static char varName[12];
-	memset(varName, 0, 12 * sizeof(char)); //reset string
+	char *varName = this->varAccessToken;
+	memset(varName, 0, sizeof(this->varAccessToken)); //reset string
 	varName[0] = 'v';
 	const UINT dwVarID = GetVarID(pName);
 
@@ -2691,11 +2692,8 @@ UINT CDbHold::GetVarID(const WCHAR* pwszName) const
 {
 	if (!pwszName)
 		return 0;
-	for (vector<HoldVar>::const_iterator var = this->vars.begin();
-			var != this->vars.end(); ++var)
-		if (!var->varNameText.compare(pwszName))
-			return var->dwVarID;
-	return 0;
+	map<WSTRING, UINT>::const_iterator var = this->varIDs.find(pwszName);
+	return var != this->varIDs.end() ? var->second : 0;
 }
 
 //*****************************************************************************
@@ -2816,6 +2814,7 @@ bool CDbHold::RenameVar(const UINT dwVarID, const WSTRING& newName)
 
 			//New name is unique.  Assign it.
 			var->varNameText = newName;
+			IndexVarNames();
 			return true;
 		}
 	return false; //ID not found
@@ -3222,6 +3221,7 @@ bool CDbHold::SetMembers(
 	}
 	this->vars = Src.vars;
 	this->localScriptVars = Src.localScriptVars;
+	this->varIDs = Src.varIDs;
 	this->worldMaps = Src.worldMaps;
 	for (vector<HoldCharacter*>::const_iterator chIter = Src.characters.begin();
 			chIter != Src.characters.end(); ++chIter)
@@ -3629,6 +3629,8 @@ MESSAGE_ID CDbHold::SetProperty(
 				case P_End:
 					//Finish processing
 					this->vars.push_back(info.importVar);
+					this->varIDs.insert(std::make_pair(
+							WSTRING(info.importVar.varNameText), info.importVar.dwVarID));
 					info.importVar.clear();
 					break;
 				default:
@@ -4114,6 +4116,7 @@ void CDbHold::Clear()
 	ClearEntrances();
 	this->vars.clear();
 	this->localScriptVars.clear();
+	this->varIDs.clear();
 
 	for (vector<HoldCharacter*>::iterator chIt=this->characters.begin();
 			chIt!=this->characters.end(); ++chIt)
@@ -4135,3 +4138,14 @@ void CDbHold::ClearEntrances()
 		delete this->Entrances[wIndex];
 	this->Entrances.clear();
 }
+
+//*****************************************************************************
+void CDbHold::IndexVarNames()
+//Rebuilds the index of var IDs by name.
+//Where names repeat, the first var in the list is found, as when it was searched.
+{
+	this->varIDs.clear();
+	for (vector<HoldVar>::const_iterator var = this->vars.begin();
+			var != this->vars.end(); ++var)
+		this->varIDs.insert(std::make_pair(var->varNameText, var->dwVarID));
+}
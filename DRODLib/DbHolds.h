@@ -179,6 +179,7 @@ public:
 private:
 	void     Clear();
 	void     ClearEntrances();
+	void     IndexVarNames();
 	UINT     GetLocalID(const HoldStatus eStatusMatching, const CIDSet& playerIDs, UINT& matchedPlayerID) const;
 	UINT     GetNewCharacterID();
 	bool     LoadCharacters(c4_View &CharsView);
@@ -205,6 +206,9 @@ private:
 	vector<UINT> deletedSpeechIDs; //speech IDs to be deleted on Update
 
 	map<UINT, WSTRING> localScriptVars; //in-game optimization: IDs and names of local script vars
+	map<WSTRING, UINT> varIDs;          //IDs of vars by name, kept current with vars
+
+	mutable char varAccessToken[12]; //text returned by getVarAccessToken
 };
 
 //******************************************************************************************
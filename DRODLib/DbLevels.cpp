@@ -288,12 +288,7 @@ void CDbLevels::GetRequiredRooms(
 	UINT levelID,
 	CIDSet& requiredRooms) //(out)
 {
-	requiredRooms.clear();
-
-	CIDSet roomsInLevel = CDb::getRoomsInLevel(levelID);
-	for (CIDSet::const_iterator iter = roomsInLevel.begin(); iter != roomsInLevel.end(); ++iter)
-		if (CDbRoom::IsRequired(*iter))
-			requiredRooms += *iter;
+	requiredRooms = CDb::getRequiredRoomsInLevel(levelID);
 }
 
 //*****************************************************************************
@@ -30,10 +30,28 @@
 
 #include "DbPackedVars.h"
 #include "SettingsKeys.h"
+#include "StateHash.h"
 
 #include <BackEndLib/StretchyBuffer.h>
 #include <BackEndLib/Ports.h>
 
+//Packed buffer layout helpers.  Sizes are little-endian in the packed format.
+static inline void AppendUINT(std::vector<BYTE>& buffer, const UINT val)
+{
+	buffer.push_back(BYTE(val));
+	buffer.push_back(BYTE(val >> 8));
+	buffer.push_back(BYTE(val >> 16));
+	buffer.push_back(BYTE(val >> 24));
+}
+static inline UINT ReadUINT(const BYTE *pRead)
+{
+	return UINT(pRead[0]) | (UINT(pRead[1]) << 8) | (UINT(pRead[2]) << 16) | (UINT(pRead[3]) << 24);
+}
+
+//Arena space no longer used is reclaimed once it is at least this large
+//and over half of the arena.
+static const UINT MIN_UNUSED_BYTES_TO_COMPACT = 1024;
+
 //
 //Public methods.
 //
@@ -44,7 +62,7 @@ CDbPackedVars::CDbPackedVars(
 //
 //Params:
 	const BYTE *pBuf) //(in) Buffer containing packed variables.
-	: bOldFormat(false)
+	: bOldFormat(false), dwVersion(0)
 {
 	UnpackBuffer(pBuf, 1);
 }
@@ -53,13 +71,12 @@ CDbPackedVars::CDbPackedVars(
 CDbPackedVars::~CDbPackedVars()
 //Destructor.
 {
-	Clear();
 }
 
 //*******************************************************************************************
 CDbPackedVars::CDbPackedVars(const CDbPackedVars& Src)
 //Copy constructor.
-	: bOldFormat(false)
+	: bOldFormat(false), dwVersion(0)
 {
 	SetMembers(Src);
 }
@@ -68,50 +85,70 @@ CDbPackedVars::CDbPackedVars(const CDbPackedVars& Src)
 void CDbPackedVars::Clear()
 //Zeroes member vars and frees resources associated with this object.
 {
-	for (std::map <string, UNPACKEDVAR*>::const_iterator i = this->vars.begin();
-			i != this->vars.end();	++i)
-		delete i->second;
-	this->vars.clear();
-	this->varIter = this->vars.end();
-	this->lastQueryIter = this->vars.end();
+	this->arena.clear();
+	this->entries.clear();
+	this->dwUnusedBytes = 0;
+	this->bPackedLayout = true;
+	this->wIterIndex = 0;
+	this->wLastQueryIndex = 0;
+	this->hash = 0;
+	++this->dwVersion;
 }
 
 //*******************************************************************************************
 UNPACKEDVAR* CDbPackedVars::GetFirst()
 //API to retrieve the first var in the set.
 {
-	this->varIter = this->vars.begin();
+	this->wIterIndex = 0;
 	return GetNext();
 }
 
 //*******************************************************************************************
 UNPACKEDVAR* CDbPackedVars::GetNext()
+//Returns: the next var in the set, or NULL if there are no more.
+//The var returned is overwritten by the next call.
 {
-	if (this->varIter == this->vars.end())
+	if (this->wIterIndex >= this->entries.size())
 		return NULL;
-	return (this->varIter++)->second;
+
+	const VARENTRY& entry = this->entries[this->wIterIndex++];
+	this->iterVar.name = GetName(entry);
+	this->iterVar.pValue = &this->arena[entry.dwValue];
+	this->iterVar.dwValueSize = entry.dwValueSize;
+	this->iterVar.eType = entry.eType;
+	return &this->iterVar;
 }
 
 //*******************************************************************************************
 void CDbPackedVars::SetMembers(const CDbPackedVars &Src)
 {
-	Clear();
-
-	//Each iteration copies one unpacked var.
-	for (std::map <string, UNPACKEDVAR*>::const_iterator i = Src.vars.begin();
-			i != Src.vars.end();	++i)
-	{
-		UNPACKEDVAR *pSrcVar = i->second;
-		SetVar(pSrcVar->name.c_str(), pSrcVar->pValue, pSrcVar->dwValueSize, pSrcVar->eType);
-	}
+	//The arena and index are position independent, so they are copied as they are.
+	this->arena = Src.arena;
+	this->entries = Src.entries;
+	this->dwUnusedBytes = Src.dwUnusedBytes;
+	this->bPackedLayout = Src.bPackedLayout;
+	this->wIterIndex = 0;
+	this->wLastQueryIndex = 0;
+	this->hash = Src.hash;
+	++this->dwVersion;
 }
 
 //*******************************************************************************************
 void CDbPackedVars::Unset(const char *pszVarName)
 {
-	this->vars.erase(pszVarName);
-
-	this->varIter = this->vars.end(); //invalidate
+	const UINT wIndex = FindVarIndex(pszVarName);
+	if (wIndex >= this->entries.size() || strcmp(GetName(this->entries[wIndex]), pszVarName))
+		return;
+
+	const VARENTRY& entry = this->entries[wIndex];
+	this->hash ^= GetVarHash(entry);
+	++this->dwVersion;
+	this->dwUnusedBytes += entry.dwValue + entry.dwValueSize - entry.dwRecord;
+	this->entries.erase(this->entries.begin() + wIndex);
+	this->bPackedLayout = false;
+
+	this->wIterIndex = this->entries.size(); //invalidate
+	this->wLastQueryIndex = 0;
 }
 
 //*******************************************************************************************
@@ -127,9 +164,9 @@ void * CDbPackedVars::GetVar(
 //Pointer to variable value.
 {
 	//Find var with matching name.
-	const UNPACKEDVAR *pFoundVar = FindVarByName(pszVarName);
+	const VARENTRY *pFoundVar = FindVarByName(pszVarName);
 	if (pFoundVar)
-		return pFoundVar->pValue;
+		return const_cast<BYTE*>(&this->arena[pFoundVar->dwValue]);
 	return (void *) pNotFoundValue;
 }
 int CDbPackedVars::GetVar(const char *pszVarName, int nNotFoundValue) const
@@ -138,7 +175,8 @@ int CDbPackedVars::GetVar(const char *pszVarName, int nNotFoundValue) const
 	const int *pnRet = (int *)GetVar(pszVarName, (void *)NULL);
 	if (pnRet)
 	{
-		int nRet(*pnRet);
+		int nRet;
+		memcpy(&nRet, pnRet, sizeof(nRet)); //values in the arena are not aligned
 #if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
 		LittleToBig(&nRet);
 #endif
@@ -153,7 +191,8 @@ UINT CDbPackedVars::GetVar(const char *pszVarName, UINT wNotFoundValue) const
 	const UINT *pwRet = (UINT *) GetVar(pszVarName, (void *)NULL);
 	if (pwRet)
 	{
-		UINT wRet(*pwRet);
+		UINT wRet;
+		memcpy(&wRet, pwRet, sizeof(wRet)); //values in the arena are not aligned
 #if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
 		LittleToBig(&wRet);
 #endif
@@ -231,7 +270,8 @@ bool CDbPackedVars::GetVar(const char *pszVarName, bool bNotFoundValue) const
 
 		//Handle old data size (UINT).
 		ASSERT(GetVarValueSize(pszVarName)==sizeof(UINT));
-		UINT wRet(*((UINT*)pucRet)); //recast what's being pointed at to 4-byte value
+		UINT wRet;
+		memcpy(&wRet, pucRet, sizeof(wRet)); //values in the arena are not aligned
 #if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
 		LittleToBig(&wRet);
 #endif
@@ -259,34 +299,66 @@ void* CDbPackedVars::SetVar(
 	const UNPACKEDVARTYPE eSetType)   //(in) Type of var.
 //
 //Returns:
-//Pointer to memory where value was stored or NULL if not successful.
+//Pointer to memory where value was stored.
 {
-	bool bSuccess = true;
+	ASSERT(pszVarName);
 
-	//Try to get an existing unpacked var with matching name,
-	UNPACKEDVAR *pVar = FindVarByName(pszVarName);
-	if (!pVar) //No existing var of same name.
+	//A value from this arena is copied out first, as the arena may move.
+	std::vector<BYTE> valueCopy;
+	if (!this->arena.empty() && (const BYTE*)pValue >= &this->arena[0] &&
+			(const BYTE*)pValue < &this->arena[0] + this->arena.size())
 	{
-		//Create new var and add to list.
-		pVar = new UNPACKEDVAR(pszVarName, NULL, 0, eSetType);
-		this->vars[pVar->name] = pVar;
+		valueCopy.assign((const BYTE*)pValue, (const BYTE*)pValue + dwValueSize);
+		pValue = &valueCopy[0];
 	}
 
-	//Set value of var.
-	delete[] (char*)pVar->pValue;
-	pVar->pValue = new BYTE[dwValueSize];
-	if (!pVar->pValue) {bSuccess=false; goto Cleanup;}
-	memcpy(pVar->pValue, pValue, dwValueSize);
-	pVar->dwValueSize = dwValueSize;
-	pVar->eType = eSetType;
-
-Cleanup:
-	if (!bSuccess) 
+	const UINT wIndex = FindVarIndex(pszVarName);
+	if (wIndex < this->entries.size() && !strcmp(GetName(this->entries[wIndex]), pszVarName))
 	{
-		Clear();
-		return NULL;
+		VARENTRY& entry = this->entries[wIndex];
+		this->hash ^= GetVarHash(entry);
+		if (entry.dwValueSize == dwValueSize)
+		{
+			//Overwrite the value where it is.
+			if (dwValueSize)
+				memcpy(&this->arena[entry.dwValue], pValue, dwValueSize);
+			if (entry.eType != eSetType)
+			{
+				entry.eType = eSetType;
+				if (this->bPackedLayout)
+				{
+					//Keep the type in the record current.
+					const UINT dwType = entry.dwValue - 2*sizeof(UINT);
+					int nType = static_cast<int>(eSetType);
+#if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
+					LittleToBig(&nType);
+#endif
+					memcpy(&this->arena[dwType], &nType, sizeof(int));
+				}
+			}
+		} else {
+			//Write a new record for the var at the end.
+			this->dwUnusedBytes += entry.dwValue + entry.dwValueSize - entry.dwRecord;
+			AppendRecord(this->arena, pszVarName, pValue, dwValueSize, eSetType, entry);
+			this->bPackedLayout = false;
+		}
+	} else {
+		//Add new var.
+		VARENTRY entry;
+		AppendRecord(this->arena, pszVarName, pValue, dwValueSize, eSetType, entry);
+		if (wIndex < this->entries.size())
+			this->bPackedLayout = false; //record is not in name order
+		this->entries.insert(this->entries.begin() + wIndex, entry);
 	}
-	return pVar->pValue;
+	this->hash ^= GetVarHash(this->entries[wIndex]);
+	++this->dwVersion;
+	this->wLastQueryIndex = wIndex;
+
+	if (this->dwUnusedBytes >= MIN_UNUSED_BYTES_TO_COMPACT &&
+			this->dwUnusedBytes > this->arena.size() / 2)
+		Compact();
+
+	return &this->arena[this->entries[wIndex].dwValue];
 }
 
 //*******************************************************************************************
@@ -300,25 +372,36 @@ const
 //Returns:
 //Pointer to new buffer which caller must delete.
 {
+	if (this->bPackedLayout)
+	{
+		//The arena is already in the packed format.  Append end code.
+		dwBufferSize = this->arena.size() + sizeof(UINT);
+		BYTE *pBuf = new BYTE[dwBufferSize];
+		if (!this->arena.empty())
+			memcpy(pBuf, &this->arena[0], this->arena.size());
+		memset(pBuf + this->arena.size(), 0, sizeof(UINT));
+		return pBuf;
+	}
+
 	CStretchyBuffer PackedBuf;
 
 	//Each iteration packs one var into buffer.
-	for (std::map <string, UNPACKEDVAR*>::const_iterator i = this->vars.begin();
-			i != this->vars.end();	++i)
+	for (std::vector<VARENTRY>::const_iterator entry = this->entries.begin();
+			entry != this->entries.end(); ++entry)
 	{
-		UNPACKEDVAR *pReadVar = i->second;
-		PackedBuf += (UINT) pReadVar->name.size() + 1;
-		PackedBuf += pReadVar->name.c_str();
+		const char *pszName = GetName(*entry);
+		PackedBuf += (UINT) strlen(pszName) + 1;
+		PackedBuf += pszName;
 		PackedBuf += (BYTE)0; //null terminate var name
 
 		//Store variable type.
-		PackedBuf += static_cast<int>(pReadVar->eType);
+		PackedBuf += static_cast<int>(entry->eType);
 
 		//Store variable data size.
-		PackedBuf += pReadVar->dwValueSize;
+		PackedBuf += entry->dwValueSize;
 
 		//Store variable data.
-		PackedBuf.Append((const BYTE *) pReadVar->pValue, pReadVar->dwValueSize);    
+		PackedBuf.Append(&this->arena[entry->dwValue], entry->dwValueSize);
 	}
 
 	//Append end code to buffer.
@@ -331,7 +414,7 @@ const
 UNPACKEDVARTYPE CDbPackedVars::GetVarType(const char *pszVarName) const
 //Returns: type of var, or UVT_unknown if no match
 {
-	UNPACKEDVAR *pVar = FindVarByName(pszVarName);
+	const VARENTRY *pVar = FindVarByName(pszVarName);
 	return pVar ? pVar->eType : UVT_unknown;
 }
 
@@ -346,12 +429,7 @@ const
 //Returns:
 //The size or 0 if no match.
 {
-	//Since this method is called only following a successful call to FindVarByName,
-	//which sets the query iterator, now rewind the increment on this iterator
-	//so the find operation below may be performed quickly.
-	--this->lastQueryIter;
-
-	UNPACKEDVAR *pVar = FindVarByName(pszVarName);
+	const VARENTRY *pVar = FindVarByName(pszVarName);
 	return pVar ? pVar->dwValueSize : 0;
 }
 
@@ -359,6 +437,44 @@ const
 //Private methods.
 //
 
+//*******************************************************************************************
+void CDbPackedVars::AppendRecord(
+//Appends a var's record in the packed format to a buffer.
+//
+//Params:
+	std::vector<BYTE>& buffer,   //(in/out)
+	const char *pszVarName, const void *pValue, const UINT dwValueSize,
+	const UNPACKEDVARTYPE eType, //(in) var
+	VARENTRY& entry)             //(out) where the record was written
+{
+	const UINT dwNameSize = strlen(pszVarName) + 1;
+	entry.dwRecord = buffer.size();
+	entry.dwValueSize = dwValueSize;
+	entry.eType = eType;
+
+	AppendUINT(buffer, dwNameSize);
+	buffer.insert(buffer.end(), pszVarName, pszVarName + dwNameSize);
+	AppendUINT(buffer, UINT(static_cast<int>(eType)));
+	AppendUINT(buffer, dwValueSize);
+	entry.dwValue = buffer.size();
+	buffer.insert(buffer.end(), (const BYTE*)pValue, (const BYTE*)pValue + dwValueSize);
+}
+
+//*******************************************************************************************
+void CDbPackedVars::Compact()
+//Rewrites the arena with only the records in use, in name order.
+{
+	std::vector<BYTE> compacted;
+	compacted.reserve(this->arena.size() - this->dwUnusedBytes);
+	for (std::vector<VARENTRY>::iterator entry = this->entries.begin();
+			entry != this->entries.end(); ++entry)
+		AppendRecord(compacted, GetName(*entry), &this->arena[entry->dwValue],
+				entry->dwValueSize, entry->eType, *entry);
+	this->arena.swap(compacted);
+	this->dwUnusedBytes = 0;
+	this->bPackedLayout = true;
+}
+
 //*******************************************************************************************
 bool CDbPackedVars::UnpackBuffer(
 //Unpacks variables in buffer into member vars that can be easily accessed.
@@ -371,8 +487,8 @@ bool CDbPackedVars::UnpackBuffer(
 //True if successful, false if not.
 {
 	bool bSuccess=true;
-	UINT wVarNameSize = 0;
-	UNPACKEDVAR *pNewVar = NULL;
+	bool bSorted=true;
+	UINT dwEnd, wVarNameSize;
 
 	//Packed variable buffer format is:
 	//{VarNameSize1 UINT}{VarName1 SZ}{VarType1 int}{VarValueSize1 UINT}{VarValue1}
@@ -387,72 +503,87 @@ bool CDbPackedVars::UnpackBuffer(
 	if (bufSize == 0) goto Cleanup;  //Success--nothing to unpack.
 	if (!pRead) goto Cleanup; //Success--nothing to unpack.
 
-	//Each iteration unpacks one variable.
-	memcpy(&wVarNameSize, pRead, sizeof(UINT));
-	pRead += sizeof(UINT);
-#if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
-	LittleToBig(&wVarNameSize);
-#endif
+	//Index each variable where it is in the buffer.
+	wVarNameSize = ReadUINT(pRead);
 	while (wVarNameSize != 0)
 	{
 		ASSERT(wVarNameSize < 256); //256 = reasonable limit to var name size.
 		if (wVarNameSize >= 256) {bSuccess=false; goto Cleanup;} //more robust
-		
+
+		VARENTRY entry;
+		entry.dwRecord = UINT(pRead - pBuf);
+		pRead += sizeof(UINT);
+
 		//Get var name.
-		char *pszName = new char[wVarNameSize];
-		if (!pszName) {bSuccess=false; goto Cleanup;}
-		memcpy(pszName, pRead, wVarNameSize);
+		const char *pszName = (const char*)pRead;
 		ASSERT(pszName[wVarNameSize - 1] == '\0'); //Var name s/b null-terminated.
 		if (pszName[wVarNameSize - 1] != '\0') {bSuccess=false; goto Cleanup;}
 		pRead += wVarNameSize;
 
-		//Create new packed var.
-		pNewVar = new UNPACKEDVAR(pszName);
-		delete[] pszName;
-
 		if (this->bOldFormat)
 		{
 			//No explicit var type specified in the old format.  Look up by name.
-			pNewVar->eType = Get1_6VarType(pNewVar->name.c_str());
+			entry.eType = Get1_6VarType(pszName);
 		} else {
 			//Get type of value.
-			memcpy(&pNewVar->eType, pRead, sizeof(int));
-#if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
-			LittleToBig((int *)(&pNewVar->eType));
-#endif
+			entry.eType = UNPACKEDVARTYPE(int(ReadUINT(pRead)));
 			pRead += sizeof(int);
 		}
 
 		//Get size of value.
-		memcpy(&pNewVar->dwValueSize, pRead, sizeof(UINT));
-#if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
-		LittleToBig(&pNewVar->dwValueSize);
-#endif
+		entry.dwValueSize = ReadUINT(pRead);
 		pRead += sizeof(UINT);
 
-		//Copy value to new unpacked var.
-		pNewVar->pValue = new char[pNewVar->dwValueSize];
-		if (!pNewVar->pValue) {bSuccess=false; goto Cleanup;}
-		memcpy(pNewVar->pValue, pRead, pNewVar->dwValueSize);
-		pRead += pNewVar->dwValueSize;
+		entry.dwValue = UINT(pRead - pBuf);
+		pRead += entry.dwValueSize;
 
-		this->vars[pNewVar->name] = pNewVar;
+		if (!this->entries.empty() &&
+				strcmp((const char*)pBuf + this->entries.back().dwRecord + sizeof(UINT), pszName) >= 0)
+			bSorted = false;
+		this->entries.push_back(entry);
 
 		//Get size of next variable name or end code.
-		memcpy(&wVarNameSize, pRead, sizeof(UINT));
-#if (GAME_BYTEORDER == GAME_BYTEORDER_BIG)
-		LittleToBig(&wVarNameSize);
-#endif
-		pRead += sizeof(UINT);
+		wVarNameSize = ReadUINT(pRead);
 	} //...unpack next var in buffer.
 
+	//Copy the records as they are.
+	dwEnd = UINT(pRead - pBuf);
+	this->arena.assign(pBuf, pRead);
+
+	if (!bSorted)
+	{
+		//Sort the index.  Where a name repeats, the last value is kept.
+		std::vector<VARENTRY> unsorted;
+		unsorted.swap(this->entries);
+		for (std::vector<VARENTRY>::const_iterator entry = unsorted.begin();
+				entry != unsorted.end(); ++entry)
+		{
+			const char *pszName = GetName(*entry);
+			const UINT wIndex = FindVarIndex(pszName);
+			if (wIndex < this->entries.size() && !strcmp(GetName(this->entries[wIndex]), pszName))
+			{
+				const VARENTRY& replaced = this->entries[wIndex];
+				this->dwUnusedBytes += replaced.dwValue + replaced.dwValueSize - replaced.dwRecord;
+				this->entries[wIndex] = *entry;
+			} else {
+				this->entries.insert(this->entries.begin() + wIndex, *entry);
+			}
+		}
+	}
+	this->bPackedLayout = bSorted && !this->bOldFormat;
+	ASSERT(dwEnd == this->arena.size());
+
+	for (std::vector<VARENTRY>::const_iterator entry = this->entries.begin();
+			entry != this->entries.end(); ++entry)
+		this->hash ^= GetVarHash(*entry);
+
 Cleanup:
 	if (!bSuccess) Clear();
 	return bSuccess;
 }
 
 //*******************************************************************************************
-UNPACKEDVAR *CDbPackedVars::FindVarByName(
+const CDbPackedVars::VARENTRY* CDbPackedVars::FindVarByName(
 //Finds an unpacked variable in list that matches specified name.
 //
 //Params:
@@ -460,21 +591,55 @@ UNPACKEDVAR *CDbPackedVars::FindVarByName(
 const
 //
 //Returns:
-//Pointer to unpacked var if a match is found, otherwise NULL.
+//Pointer to the var's entry if a match is found, otherwise NULL.
 {
 	//If a previous name lookup was performed, then there's a high probability
-	//that the next thing looked up is the successor to this query.
-	if (this->lastQueryIter != this->vars.end())
-		if (++this->lastQueryIter != this->vars.end())
-			if (!strcmp(this->lastQueryIter->first.c_str(), pszVarName))
-				return this->lastQueryIter->second;
-
-	this->lastQueryIter = this->vars.find(pszVarName);
-	if (this->lastQueryIter != this->vars.end())
-		return this->lastQueryIter->second;
+	//that the next thing looked up is the same var or its successor.
+	const UINT wSize = this->entries.size();
+	UINT wIndex = this->wLastQueryIndex;
+	if (wIndex < wSize && !strcmp(GetName(this->entries[wIndex]), pszVarName))
+		return &this->entries[wIndex];
+	if (++wIndex < wSize && !strcmp(GetName(this->entries[wIndex]), pszVarName))
+	{
+		this->wLastQueryIndex = wIndex;
+		return &this->entries[wIndex];
+	}
+
+	wIndex = FindVarIndex(pszVarName);
+	if (wIndex < wSize && !strcmp(GetName(this->entries[wIndex]), pszVarName))
+	{
+		this->wLastQueryIndex = wIndex;
+		return &this->entries[wIndex];
+	}
 	return NULL; //No match.
 }
 
+//*******************************************************************************************
+UINT CDbPackedVars::FindVarIndex(const char *pszVarName) const
+//Returns: index of the first entry whose name is not less than pszVarName
+{
+	UINT wLow = 0, wHigh = this->entries.size();
+	while (wLow < wHigh)
+	{
+		const UINT wMid = (wLow + wHigh) / 2;
+		if (strcmp(GetName(this->entries[wMid]), pszVarName) < 0)
+			wLow = wMid + 1;
+		else
+			wHigh = wMid;
+	}
+	return wLow;
+}
+
+//*******************************************************************************************
+ULONGLONG CDbPackedVars::GetVarHash(const VARENTRY& entry) const
+//Returns: state hash key for this var's name and value
+{
+	const char *pszName = GetName(entry);
+	const ULONGLONG nameHash = StateHash::Bytes(pszName, strlen(pszName));
+	return StateHash::Bytes(entry.dwValueSize ? &this->arena[entry.dwValue] : NULL,
+			entry.dwValueSize, nameHash ^ StateHash::Key(StateHash::Var, entry.eType));
+}
+
 //*******************************************************************************************
 UNPACKEDVARTYPE CDbPackedVars::Get1_6VarType(const char *pszVarName) const
 //Given the name of 1.6 variable name, returns the variable type.
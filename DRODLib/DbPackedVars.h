@@ -35,7 +35,7 @@
 //a new SetVar() or use the general-purpose SetVar(const void *, UINT) method.
 //
 //To retrieve a variable, call one of the GetVar() methods.  Returned pointers are only
-//good until CDbPackedVars goes out of scope or Clear() is called.
+//good until CDbPackedVars goes out of scope or a var is set, unset or cleared.
 //
 //To pack all the current variables into a single buffer, that can be stored in
 //a database field, call GetPackedBuffer().
@@ -44,6 +44,14 @@
 //where your calling code is starting from you may wish to use the "const byte *" or
 //"c4_BytesRef &" assignment operators.  Unpacking the byte buffer will result in the
 //variables that were stored in the buffer to become accessible through the class methods.
+//
+//STORAGE
+//
+//Vars are kept in one arena in the packed buffer format, with an index of the vars
+//sorted by name.  Unpacking copies the buffer into the arena in one piece, and copying
+//a CDbPackedVars copies the arena and index as they are.  A value that changes size is
+//written again at the end of the arena, and the arena is compacted when over half of
+//it is no longer used.
 
 #ifndef DBPACKEDVARS_H
 #define DBPACKEDVARS_H
@@ -55,6 +63,7 @@
 
 #include <cstring>
 #include <map>
+#include <vector>
 
 #include <mk4.h>
 
@@ -72,16 +81,10 @@ enum UNPACKEDVARTYPE
     UVT_unknown
 };
 
+//A var as returned by GetFirst() and GetNext().
 struct UNPACKEDVAR
 {
-	UNPACKEDVAR(const char* pszName, void* pValue=NULL, const UINT dwValueSize=0, UNPACKEDVARTYPE eType=UVT_byte)
-		: pValue(pValue), dwValueSize(dwValueSize), eType(eType)
-	{ASSERT(pszName);  this->name = pszName;}
-	~UNPACKEDVAR() {
-		delete[] (char*)this->pValue;
-	}
-
-	bool operator <(const UNPACKEDVAR& that) const {return this->name < that.name;}
+	UNPACKEDVAR() : pValue(NULL), dwValueSize(0), eType(UVT_byte) { }
 	string          name;
 	void *          pValue;
 	UINT           dwValueSize;
@@ -91,7 +94,7 @@ struct UNPACKEDVAR
 class CDbPackedVars
 {
 public:
-	CDbPackedVars() : bOldFormat(false) {Clear();}
+	CDbPackedVars() : bOldFormat(false), dwVersion(0) {Clear();}
 	CDbPackedVars(const CDbPackedVars& Src);
 	CDbPackedVars(const BYTE *pBuf);
 	~CDbPackedVars();
@@ -117,7 +120,9 @@ public:
 		return FindVarByName(pszVarName)!=NULL;
 	}
 	UNPACKEDVAR*   GetFirst();
+	ULONGLONG      GetHash() const {return this->hash;}
 	UNPACKEDVAR*   GetNext();
+	UINT           GetVersion() const {return this->dwVersion;}
 	BYTE *         GetPackedBuffer(UINT &dwBufferSize) const;
 	void *         GetVar(const char *pszVarName, const void *pNotFoundValue = NULL) const;
 	const char *   GetVar(const char *pszVarName, const char *pszNotFoundValue = NULL) const;
@@ -184,15 +189,39 @@ public:
 	bool*         SetVar(const char *pszVarName, bool bValue);
 
 private:
+	//Where a var's record is in the arena.
+	struct VARENTRY
+	{
+		UINT dwRecord;    //offset of the record
+		UINT dwValue;     //offset of the value in the record
+		UINT dwValueSize;
+		UNPACKEDVARTYPE eType;
+	};
+
+	static void     AppendRecord(std::vector<BYTE>& buffer, const char *pszVarName,
+			const void *pValue, const UINT dwValueSize, const UNPACKEDVARTYPE eType,
+			VARENTRY& entry);
+	void            Compact();
 	UNPACKEDVARTYPE	Get1_6VarType(const char *pszVarName) const;
+	const char *    GetName(const VARENTRY& entry) const
+			{return (const char*)&this->arena[entry.dwRecord + sizeof(UINT)];}
 	void            SetMembers(const CDbPackedVars &Src);
-	UNPACKEDVAR *   FindVarByName(const char *pszVarName) const;
+	const VARENTRY* FindVarByName(const char *pszVarName) const;
+	UINT            FindVarIndex(const char *pszVarName) const;
+	ULONGLONG       GetVarHash(const VARENTRY& entry) const;
 	bool            UnpackBuffer(const BYTE *pBuf, const UINT bufSize);
 
-	std::map <string, UNPACKEDVAR*> vars;
-	std::map <string, UNPACKEDVAR*>::iterator varIter;
-	mutable std::map <string, UNPACKEDVAR*>::const_iterator lastQueryIter;
+	std::vector<BYTE> arena;       //var records, in the packed buffer format
+	std::vector<VARENTRY> entries; //sorted by var name
+	UINT dwUnusedBytes; //in records that are no longer used
+	bool bPackedLayout; //whether the arena is just the records in entries, in order,
+	                    //so it can be packed as is
+	UINT wIterIndex;    //for GetNext()
+	UNPACKEDVAR iterVar;
+	mutable UINT wLastQueryIndex;
 	bool bOldFormat;	//indicates newer eType var field should be ignored
+	ULONGLONG hash;  //XOR of GetVarHash() for all vars, kept current as vars change
+	UINT dwVersion;  //changes each time vars are changed
 };
 
 #endif //...#ifndef DBEXTRAVARS_H
@@ -50,6 +50,7 @@
 #include "Stalwart.h"
 #include "TemporalClone.h"
 #include "Platform.h"
+#include "StateHash.h"
 #include "../Texts/MIDs.h"
 #include <BackEndLib/Base64.h>
 #include <BackEndLib/Exception.h>
@@ -645,20 +646,7 @@ UINT CDbRooms::FindIDAtCoords(
 {
 	ASSERT(IsOpen());	//Ensure rooms view is open.
 
-	CIDSet roomsInLevel = CDb::getRoomsInLevel(dwLevelID);
-	c4_View RoomsView;
-
-	//Scan through rooms in level to find matching room.
-	for (CIDSet::const_iterator room = roomsInLevel.begin(); room != roomsInLevel.end(); ++room)
-	{
-		const UINT roomRowI = LookupRowByPrimaryKey(*room, V_Rooms, RoomsView);
-		c4_RowRef row = RoomsView[roomRowI];
-		if (dwRoomX == (UINT) p_RoomX(row) && dwRoomY == (UINT) p_RoomY(row))
-			return p_RoomID(row); //Found it.
-	}
-
-	//No match.
-	return 0;
+	return CDb::getRoomIDAtCoords(dwLevelID, dwRoomX, dwRoomY);
 }
 
 //*****************************************************************************
@@ -856,6 +844,14 @@ CDbRoom::CDbRoom(const CDbRoom &Src,
 	, tLayer(NULL)
 	, pMonsterSquares(NULL)
 	, pCurrentGame(NULL)
+	, wMonsterRowWords(0)
+	, dwGeometryVersion(0)
+	, dwEyeGazesVersion(0)
+	, wNextMonsterIndex(0)
+	, bWeaponSquaresSettled(false)
+	, dwMonsterMutations(0)
+	, wSettledTurnNo(UINT(-1))
+	, dwSettledMutations(0)
 //Constructor.
 {
 	for (int n=NumMovementTypes; n--; )
@@ -876,6 +872,14 @@ CDbRoom::CDbRoom()
 	, tLayer(NULL)
 	, pMonsterSquares(NULL)
 	, pCurrentGame(NULL)
+	, wMonsterRowWords(0)
+	, dwGeometryVersion(0)
+	, dwEyeGazesVersion(0)
+	, wNextMonsterIndex(0)
+	, bWeaponSquaresSettled(false)
+	, dwMonsterMutations(0)
+	, wSettledTurnNo(UINT(-1))
+	, dwSettledMutations(0)
 //Constructor.
 {
 	for (int n=0; n<NumMovementTypes; ++n)
@@ -1591,8 +1595,7 @@ MESSAGE_ID CDbRoom::SetProperty(
 					//Finish processing
 					ASSERT(!this->pMonsterSquares[ARRAYINDEX(pImportPiece->wX,
 							pImportPiece->wY)]);
-					this->pMonsterSquares[ARRAYINDEX(pImportPiece->wX,
-							pImportPiece->wY)] = pImportPiece;
+					SetMonsterSquare(pImportPiece->wX, pImportPiece->wY, pImportPiece);
 					pImportMonster->Pieces.push_back(pImportPiece);
 					pImportPiece = NULL;
 					break;
@@ -1847,6 +1850,8 @@ void CDbRoom::ReflectSquare(const bool bHoriz, UINT &wSquare) const
 void CDbRoom::ReflectX()
 //Reflects everything in the room in the X direction.
 {
+	InvalidateTileHash();
+
 	//Reflect room tiles.
 	UINT wX, wRefX, wY, wSize;
 	UINT wSquare, wSquare2;
@@ -2009,6 +2014,8 @@ void CDbRoom::ReflectX()
 void CDbRoom::ReflectY()
 //Reflects everything in the room in the Y direction.
 {
+	InvalidateTileHash();
+
 	//Reflect room tiles.
 	UINT wX, wY, wRefY, wSize;
 	UINT wSquare, wSquare2;
@@ -3315,7 +3322,7 @@ bool CDbRoom::KillMonsterAtSquare(
 void CDbRoom::RemoveMonsterFromTileArray(CMonster* pMonster)
 {
 	if (pMonster == this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)])
-		this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)] = NULL;
+		SetMonsterSquare(pMonster->wX, pMonster->wY, NULL);
 }
 
 //*****************************************************************************
@@ -3413,8 +3420,8 @@ void CDbRoom::MoveMonster(
 	ASSERT(this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)]==pMonster);
 	ASSERT(!this->pMonsterSquares[ARRAYINDEX(wDestX,wDestY)]);
 
-	this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)] = NULL;
-	this->pMonsterSquares[ARRAYINDEX(wDestX,wDestY)] = const_cast<CMonster*>(pMonster);
+	SetMonsterSquare(pMonster->wX, pMonster->wY, NULL);
+	SetMonsterSquare(wDestX, wDestY, const_cast<CMonster*>(pMonster));
 }
 
 //*****************************************************************************
@@ -3457,6 +3464,13 @@ CMonster* CDbRoom::AddNewMonster(
 	return pNew;
 }
 
+//*****************************************************************************
+static inline bool bMonsterMayHoldWeapon(const CMonster *pMonster)
+//Returns: whether a monster's type allows it to hold a weapon at some point
+{
+	return bEntityHasSword(pMonster->wType) || pMonster->wType == M_CHARACTER;
+}
+
 //*****************************************************************************
 void CDbRoom::LinkMonster(
 //Sets monster's room position and adds to monster lists and array.
@@ -3469,6 +3483,7 @@ void CDbRoom::LinkMonster(
 	//Find location in list to put monster at.  List is sorted by process sequence.
 	CMonster *pSeek = this->pFirstMonster, *pLastPrecedingMonster=NULL;
 	const UINT wProcessSequence = pMonster->GetProcessSequence();
+	UINT wIndex = 0;
 
 	while (pSeek)
 	{
@@ -3479,6 +3494,25 @@ void CDbRoom::LinkMonster(
 			break; //new temporal clones go before others, not after
 		pLastPrecedingMonster = pSeek;
 		pSeek = pSeek->pNext;
+		++wIndex;
+	}
+
+	//Add monster to array at the same place.
+	//If it goes before the monster being processed, the walk's place shifts too.
+	ASSERT(wIndex <= this->monsterOrder.size());
+	this->monsterOrder.insert(this->monsterOrder.begin() + wIndex, pMonster);
+	if (wIndex < this->wNextMonsterIndex)
+		++this->wNextMonsterIndex;
+
+	//Weapon holders are kept in the same order.
+	++this->dwMonsterMutations;
+	if (bMonsterMayHoldWeapon(pMonster))
+	{
+		UINT wArmedIndex = 0;
+		for (UINT wI = 0; wI < wIndex; ++wI)
+			if (bMonsterMayHoldWeapon(this->monsterOrder[wI]))
+				++wArmedIndex;
+		this->armedMonsters.insert(this->armedMonsters.begin() + wArmedIndex, pMonster);
 	}
 
 	//Add monster to list.
@@ -3556,6 +3590,25 @@ void CDbRoom::UnlinkMonster(
 	if (pMonster->pNext) pMonster->pNext->pPrevious = pMonster->pPrevious;
 	if (pMonster == this->pLastMonster) this->pLastMonster = pMonster->pPrevious;
 	if (pMonster == this->pFirstMonster) this->pFirstMonster = pMonster->pNext;
+
+	vector<CMonster*>::iterator pos = std::find(this->monsterOrder.begin(),
+			this->monsterOrder.end(), pMonster);
+	if (pos != this->monsterOrder.end())
+	{
+		const UINT wIndex = UINT(pos - this->monsterOrder.begin());
+		this->monsterOrder.erase(pos);
+		if (wIndex < this->wNextMonsterIndex)
+			--this->wNextMonsterIndex; //the walk continues with the monster after it
+	}
+
+	++this->dwMonsterMutations;
+	if (bMonsterMayHoldWeapon(pMonster))
+	{
+		vector<CMonster*>::iterator armed = std::find(this->armedMonsters.begin(),
+				this->armedMonsters.end(), pMonster);
+		if (armed != this->armedMonsters.end())
+			this->armedMonsters.erase(armed);
+	}
 }
 
 //*****************************************************************************
@@ -3711,7 +3764,38 @@ void CDbRoom::SetMonsterSquare(CMonster *pMonster)
 //Set monster array pointer.
 {
 	ASSERT(!this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)]);
-	this->pMonsterSquares[ARRAYINDEX(pMonster->wX,pMonster->wY)] = pMonster;
+	SetMonsterSquare(pMonster->wX, pMonster->wY, pMonster);
+}
+
+//*****************************************************************************
+void CDbRoom::SetMonsterSquare(
+//Set monster array pointer, keeping track of which squares are occupied.
+//
+//Params:
+	const UINT wX, const UINT wY, //(in) square
+	CMonster *pMonster)           //(in) monster or piece on it, or NULL for none
+{
+	this->pMonsterSquares[ARRAYINDEX(wX,wY)] = pMonster;
+
+	UINT &bits = this->monsterRowBits[wY * this->wMonsterRowWords + wX / 32];
+	const UINT bit = 1u << (wX % 32);
+	if (pMonster)
+		bits |= bit;
+	else
+		bits &= ~bit;
+}
+
+//*****************************************************************************
+void CDbRoom::SwapMonsterSquares(
+//Swap the monster array pointers of two squares.
+//
+//Params:
+	const UINT wX1, const UINT wY1, //(in) squares
+	const UINT wX2, const UINT wY2)
+{
+	CMonster *pMonster1 = this->pMonsterSquares[ARRAYINDEX(wX1,wY1)];
+	SetMonsterSquare(wX1, wY1, this->pMonsterSquares[ARRAYINDEX(wX2,wY2)]);
+	SetMonsterSquare(wX2, wY2, pMonster1);
 }
 
 //*****************************************************************************
@@ -3761,11 +3845,12 @@ const
 
 	for (UINT y=wTop; y<=wBottom; ++y)
 	{
-		CMonster **pMonsters = &(this->pMonsterSquares[ARRAYINDEX(wLeft,y)]);
-		for (UINT x=wLeft; x<=wRight; ++x)
+		//Only occupied squares need to be checked.
+		for (UINT x=wLeft; FindMonsterSquareInRow(x, y, wRight); ++x)
 		{
-			CMonster *pMonster = *pMonsters;
-			if (pMonster && pMonster->IsAlive() && (bConsiderPieces || !pMonster->IsPiece())) {
+			CMonster *pMonster = this->pMonsterSquares[ARRAYINDEX(x,y)];
+			ASSERT(pMonster);
+			if (pMonster->IsAlive() && (bConsiderPieces || !pMonster->IsPiece())) {
 				if (!(bIsBeethroDouble(pMonster->wType) ||
 					pMonster->wType == M_HALPH || pMonster->wType == M_HALPH2 ||
 					pMonster->wType == M_STALWART || pMonster->wType == M_STALWART2 ||
@@ -3774,7 +3859,6 @@ const
 					return true;
 				}
 			}
-			++pMonsters;
 		}
 	}
 
@@ -3808,10 +3892,12 @@ const
 	ASSERT(wRight < this->wRoomCols && wBottom < this->wRoomRows);
 	for (UINT y=wTop; y<=wBottom; ++y)
 	{
-		pMonsters = &(this->pMonsterSquares[ARRAYINDEX(wLeft,y)]);
-		for (UINT x=wLeft; x<=wRight; ++x)
+		//Only occupied squares need to be checked.
+		for (UINT x=wLeft; FindMonsterSquareInRow(x, y, wRight); ++x)
 		{
-			if (*pMonsters && (*pMonsters)->IsAlive())
+			pMonsters = &(this->pMonsterSquares[ARRAYINDEX(x,y)]);
+			ASSERT(*pMonsters);
+			if ((*pMonsters)->IsAlive())
 			{
 				if ((*pMonsters)->wType == wBaseType) {
 					if (wBaseType == wType)
@@ -3840,7 +3926,6 @@ const
 					}
 				}
 			}
-			++pMonsters;
 		}
 	}
 
@@ -3848,6 +3933,35 @@ const
 	return false;
 }
 
+//*****************************************************************************
+bool CDbRoom::FindMonsterSquareInRow(
+//Finds the next square in a row that is in the monster array.
+//
+//Params:
+	UINT &wX,          //(in/out) square to start looking at; set to the square found
+	const UINT wY,     //(in) row
+	const UINT wRight) //(in) last square in the row to look at
+//
+//Returns: whether an occupied square was found
+const
+{
+	const UINT *pRowBits = &this->monsterRowBits[wY * this->wMonsterRowWords];
+	while (wX <= wRight)
+	{
+		const UINT bits = pRowBits[wX / 32] >> (wX % 32);
+		if (!bits)
+		{
+			//Nothing else in this word.
+			wX = (wX | 31) + 1;
+			continue;
+		}
+		if (bits & 1)
+			return true;
+		++wX;
+	}
+	return false;
+}
+
 //*****************************************************************************
 bool CDbRoom::IsMonsterNextTo(
 //Returns: true if monster of specified type is adjacent to (not on) specified square
@@ -4322,6 +4436,10 @@ void CDbRoom::DoExplodeTile(
 	CCoordStack cs(wCol, wRow);
 
 	//Explode outward until done.
+	//The blast is walked square by square rather than built as a mask, since
+	//where it fans out from a square depends on the direction it arrived in,
+	//force arrows and cabers block it in some directions only, and tarstuff and
+	//fluff cues record that direction in the order squares are reached.
 	UINT wX, wY;
 	while (cs.PopBottom(wX, wY))  //process as queue
 		ExpandExplosion(CueEvents, cs, wCol, wRow, wX, wY, bombs, powder_kegs, explosion, caberCoords, explosion_radius);
@@ -5654,6 +5772,33 @@ void CDbRoom::ResetUnloadedPressurePlates(CCueEvents &CueEvents)
 		ActivateOrb(plate->second->wX, plate->second->wY, CueEvents, OAT_PressurePlateUp);
 }
 
+//*****************************************************************************
+static CTileMask GetBlastPassesMask()
+//Returns: o-layer tiles that a bomb blast goes over or through
+{
+	static const UINT tiles[] = {
+		T_FLOOR, T_FLOOR_M, T_FLOOR_ROAD, T_FLOOR_GRASS,
+		T_FLOOR_DIRT, T_FLOOR_ALT, T_FLOOR_IMAGE,
+		T_PIT, T_PIT_IMAGE, T_PLATFORM_P,
+		T_WATER, T_SHALLOW_WATER, T_STEP_STONE, T_PLATFORM_W,
+		T_STAIRS, T_STAIRS_UP,
+		T_TRAPDOOR, T_TRAPDOOR2, T_THINICE, T_THINICE_SH,
+		T_TUNNEL_N, T_TUNNEL_S, T_TUNNEL_E, T_TUNNEL_W,
+		T_DOOR_YO, T_DOOR_GO, T_DOOR_CO, T_DOOR_RO, T_DOOR_BO,
+		T_BRIDGE, T_BRIDGE_H, T_BRIDGE_V,
+		T_HOT, T_GOO, T_PRESSPLATE,
+		T_WALL_B, T_WALL_H,
+		T_FLOOR_SPIKES, T_FLUFFVENT,
+		T_FIRETRAP, T_FIRETRAP_ON
+	};
+	CTileMask mask;
+	for (UINT i = 0; i < sizeof(tiles)/sizeof(tiles[0]); ++i)
+		mask.set(tiles[i]);
+	return mask;
+}
+
+static const CTileMask blastPassesOTiles = GetBlastPassesMask();
+
 //*****************************************************************************
 void CDbRoom::ExpandExplosion(
 //Determines how an explosion can expand based on the normal constraints:
@@ -5688,25 +5833,8 @@ void CDbRoom::ExpandExplosion(
 		return; //force arrows in wrong direction stop the blast
 
 	//Constraint 2. What can be destroyed by an explosion.
-	switch (GetOSquare(wX,wY))
-	{
-		case T_FLOOR: case T_FLOOR_M: case T_FLOOR_ROAD: case T_FLOOR_GRASS:
-		case T_FLOOR_DIRT: case T_FLOOR_ALT: case T_FLOOR_IMAGE:
-		case T_PIT: case T_PIT_IMAGE: case T_PLATFORM_P:
-		case T_WATER: case T_SHALLOW_WATER: case T_STEP_STONE: case T_PLATFORM_W:
-		case T_STAIRS:	case T_STAIRS_UP:
-		case T_TRAPDOOR: case T_TRAPDOOR2: case T_THINICE: case T_THINICE_SH:
-		case T_TUNNEL_N: case T_TUNNEL_S: case T_TUNNEL_E: case T_TUNNEL_W:
-		case T_DOOR_YO: case T_DOOR_GO: case T_DOOR_CO: case T_DOOR_RO: case T_DOOR_BO:
-		case T_BRIDGE: case T_BRIDGE_H: case T_BRIDGE_V:
-		case T_HOT: case T_GOO: case T_PRESSPLATE:
-		case T_WALL_B: case T_WALL_H:
-		case T_FLOOR_SPIKES: case T_FLUFFVENT:
-		case T_FIRETRAP: case T_FIRETRAP_ON:
-			//Bomb blast goes over/through these things
-			break;
-		default: return;  //everything else stops bomb blast
-	}
+	if (!blastPassesOTiles.get(GetOSquare(wX,wY)))
+		return;  //everything else stops bomb blast
 
 	wTileNo = GetTSquare(wX,wY);
 	switch (wTileNo)
@@ -5781,6 +5909,11 @@ void CDbRoom::ExpandExplosion(
 			if (caberCoords.Exists(wNewX,wNewY))
 				continue;
 
+			//Don't queue squares that constraints 1 and 2 will stop the blast at.
+			if (nDist(wNewX,wNewY,wBombX,wBombY) > radius ||
+					!blastPassesOTiles.get(GetOSquare(wNewX,wNewY)))
+				continue;
+
 			//Otherwise, add to list.
 			cs.Push(wNewX, wNewY);
 		}
@@ -6227,6 +6360,9 @@ void CDbRoom::PushTLayerObject(
 	//Persist the pushed object's data,
 	//so it can be globally referenced for the duration of turn processing.
 	const UINT index = ARRAYINDEX(wSrcX, wSrcY);
+	const UINT destIndex = ARRAYINDEX(wDestX, wDestY);
+	const ULONGLONG oldKeys = GetTLayerHash(index) ^ GetTLayerHash(destIndex);
+
 	RoomObject *coveringObj = this->tLayer[index];
 	ASSERT(coveringObj);
 	RoomObject *uncoveredObj = coveringObj->uncover();
@@ -6236,12 +6372,12 @@ void CDbRoom::PushTLayerObject(
 
 	coveringObj->move(wDestX, wDestY);
 
-	const UINT destIndex = ARRAYINDEX(wDestX, wDestY);
 	RoomObject *destObj = this->tLayer[destIndex];
 	if (coveringObj->cover(destObj))
 		RemoveTLayerObject(destObj);
 
 	this->tLayer[destIndex] = coveringObj;
+	UpdateTileHash(oldKeys, GetTLayerHash(index) ^ GetTLayerHash(destIndex));
 	this->pushed_objects.insert(coveringObj);
 
 	if (wTile == T_POWDER_KEG)
@@ -6581,12 +6717,83 @@ UINT CDbRoom::GetTParam(const UINT index) const
 	return tObj->param;
 }
 
+//*****************************************************************************
+ULONGLONG CDbRoom::GetTileHash() const
+//Returns: a hash of the room's o-, f- and t-layer contents.
+//Kept current incrementally as tiles are plotted during play.
+{
+	if (!this->bTileHashValid)
+	{
+		ULONGLONG hash = 0;
+		const UINT dwSquareCount = CalcRoomArea();
+		for (UINT index=0; index<dwSquareCount; ++index)
+		{
+			hash ^= StateHash::Key(StateHash::OSquare, index, (BYTE)this->pszOSquares[index]);
+			hash ^= StateHash::Key(StateHash::FSquare, index, (BYTE)this->pszFSquares[index]);
+			hash ^= GetTLayerHash(index);
+		}
+		this->tileHash = hash;
+		this->bTileHashValid = true;
+	}
+	return this->tileHash;
+}
+
+//*****************************************************************************
+ULONGLONG CDbRoom::GetTurnStateHash() const
+//Returns: a hash of room state carried from one turn to the next that is not
+//part of the tiles, e.g., burning fuses, active firetraps and briar roots.
+{
+	ULONGLONG hash = StateHash::Key(StateHash::RoomState, this->wLastCloneIndex,
+			(this->bTarWasBuilt ? 0x1 : 0) | (this->bTarstuffGateTogglePending ? 0x2 : 0) |
+			(this->bBetterVision ? 0x4 : 0) | (this->bHasConquerToken ? 0x8 : 0) |
+			(this->bHasActiveBeacon ? 0x10 : 0) | (this->bGreenDoorsOpened ? 0x20 : 0),
+			0x10);
+
+	CCoordSet::const_iterator coord;
+	for (coord = this->LitFuses.begin(); coord != this->LitFuses.end(); ++coord)
+		hash ^= StateHash::Key(StateHash::RoomState, (coord->wY << 16) | coord->wX, 0, 0x11);
+	for (coord = this->NewFuses.begin(); coord != this->NewFuses.end(); ++coord)
+		hash ^= StateHash::Key(StateHash::RoomState, (coord->wY << 16) | coord->wX, 0, 0x12);
+	for (coord = this->activeFiretraps.begin(); coord != this->activeFiretraps.end(); ++coord)
+		hash ^= StateHash::Key(StateHash::RoomState, (coord->wY << 16) | coord->wX, 0, 0x13);
+	for (coord = this->building.tileSet.begin(); coord != this->building.tileSet.end(); ++coord)
+		hash ^= StateHash::Key(StateHash::RoomState, (coord->wY << 16) | coord->wX,
+				this->building.get(coord->wX, coord->wY), 0x14);
+
+	UINT wX, wY;
+	for (UINT wI=0; wI<this->NewBabies.GetSize(); ++wI)
+	{
+		this->NewBabies.GetAt(wI, wX, wY);
+		hash ^= StateHash::Key(StateHash::RoomState, (wY << 16) | wX, wI, 0x15);
+	}
+
+	return hash ^ this->briars.getStateHash();
+}
+
+//*****************************************************************************
+ULONGLONG CDbRoom::GetTLayerHash(const UINT index) const
+//Returns: state hash key for the t-layer object on this square
+{
+	const RoomObject *tObj = this->tLayer[index];
+	if (!tObj || (tObj->tile == RoomObject::emptyTile() &&
+			tObj->coveredTile == RoomObject::emptyTile() && tObj->param == RoomObject::noParam()))
+		return 0;
+
+	return StateHash::Key(StateHash::TSquare, index,
+			(tObj->coveredTile << 16) | tObj->tile, tObj->param);
+}
+
 //*****************************************************************************
 void CDbRoom::RemoveCoveredTLayerItem(const UINT wSX, const UINT wSY)
 {
-	RoomObject *tObj = this->tLayer[ARRAYINDEX(wSX,wSY)];
+	const UINT index = ARRAYINDEX(wSX,wSY);
+	RoomObject *tObj = this->tLayer[index];
 	if (tObj)
+	{
+		const ULONGLONG oldKey = GetTLayerHash(index);
 		tObj->remove_covered();
+		UpdateTileHash(oldKey, GetTLayerHash(index));
+	}
 }
 
 //*****************************************************************************
@@ -6665,6 +6872,8 @@ void CDbRoom::SetCurrentGame(
 	SetCurrentGameForMonsters(pSetCurrentGame);
 	for (UINT wIndex=this->platforms.size(); wIndex--; )
 		this->platforms[wIndex]->SetCurrentGame(pSetCurrentGame);
+	if (!this->stations.empty())
+		pSetCurrentGame->GetSimulationContext().wLastStationTurnInit = (UINT)-1;
 
 	if (this->bCheckForHoldCompletion)
 	{
@@ -6673,8 +6882,8 @@ void CDbRoom::SetCurrentGame(
 			const UINT holdID = this->pCurrentGame->pHold ?
 					this->pCurrentGame->pHold->dwHoldID :
 					g_pTheDB->Rooms.GetHoldIDForRoom(this->dwRoomID);
-			this->pCurrentGame->bHoldCompleted = g_pTheDB->Holds.IsHoldCompleted(
-					holdID, g_pTheDB->GetPlayerID());
+			this->pCurrentGame->bHoldCompleted =
+					this->pCurrentGame->GetSimulationContext().GetDataSource().IsHoldCompleted(holdID);
 		}
 		this->bCheckForHoldCompletion = false;
 	}
@@ -6686,8 +6895,8 @@ void CDbRoom::SetCurrentGame(
 			const UINT holdID = this->pCurrentGame->pHold ?
 					this->pCurrentGame->pHold->dwHoldID :
 					g_pTheDB->Rooms.GetHoldIDForRoom(this->dwRoomID);
-			this->pCurrentGame->bHoldMastered = g_pTheDB->Holds.IsHoldMastered(
-					holdID, g_pTheDB->GetPlayerID());
+			this->pCurrentGame->bHoldMastered =
+					this->pCurrentGame->GetSimulationContext().GetDataSource().IsHoldMastered(holdID);
 		}
 		this->bCheckForHoldMastery = false;
 	}
@@ -7551,6 +7760,10 @@ void CDbRoom::Clear()
 	this->bIsRequired = false;
 	this->bIsSecret = false;
 	this->style.resize(0);
+	this->tileHash = 0;
+	InvalidateTileHash();
+	this->wTSquareBitsTile = T_EMPTY;
+	this->eyeGazes.clear();
 
 	delete[] this->pszOSquares;
 	this->pszOSquares = NULL;
@@ -7566,6 +7779,8 @@ void CDbRoom::Clear()
 
 	delete[] this->pMonsterSquares;
 	this->pMonsterSquares = NULL;
+	this->monsterRowBits.clear();
+	this->wMonsterRowWords = 0;
 
 	for (wIndex=this->orbs.size(); wIndex--; )
 		delete this->orbs[wIndex];
@@ -7588,6 +7803,7 @@ void CDbRoom::Clear()
 	for (wIndex=this->stations.size(); wIndex--; )
 		delete this->stations[wIndex];
 	this->stations.clear();
+	this->dwStationPathsVersion = 0;
 
 	this->halphEnters.clear();
 	this->halph2Enters.clear();
@@ -7627,6 +7843,14 @@ void CDbRoom::Clear()
 	ASSERT(this->monsterEnemies.empty());
 }
 
+//*****************************************************************************
+void CDbRoom::ClearMonsterSquares()
+//Removes all monsters from the monster array.
+{
+	memset(this->pMonsterSquares, 0, CalcRoomArea() * sizeof(CMonster*));
+	std::fill(this->monsterRowBits.begin(), this->monsterRowBits.end(), 0);
+}
+
 //*****************************************************************************
 void CDbRoom::ClearPushStates()
 {
@@ -7736,7 +7960,7 @@ bool CDbRoom::UnpackSquares(
 
 	const UINT dwSquareCount = CalcRoomArea();
 
-	memset(this->pMonsterSquares, 0, dwSquareCount * sizeof(CMonster*));
+	ClearMonsterSquares();
 	memset(this->tLayer, 0, dwSquareCount * sizeof(RoomObject*));
 
 	const BYTE *pRead = pSrc, *pStopReading = pRead + dwSrcSize;
@@ -7901,6 +8125,8 @@ bool CDbRoom::UnpackSquares(
 //*****************************************************************************
 bool CDbRoom::AllocTileLayers()
 {
+	InvalidateTileHash();
+
 	if (!this->overheadTiles.Init(this->wRoomCols, this->wRoomRows))
 		return false;
 
@@ -7922,6 +8148,8 @@ bool CDbRoom::AllocTileLayers()
 	ASSERT(!this->pMonsterSquares);
 	this->pMonsterSquares = new CMonster*[dwSquareCount];
 	if (!this->pMonsterSquares) {delete[] this->pszOSquares; delete[] this->pszOSquares; delete[] this->tLayer; return false;}
+	this->wMonsterRowWords = (this->wRoomCols + 31) / 32;
+	this->monsterRowBits.assign(this->wMonsterRowWords * this->wRoomRows, 0);
 
 	return true;
 }
@@ -8107,7 +8335,7 @@ CMonster* CDbRoom::LoadMonster(const c4_RowRef& row,
 		const UINT wY = p_Y(pieceRow);
 		CMonsterPiece *pMPiece = new CMonsterPiece(pNew, p_Type(pieceRow), wX, wY);
 		ASSERT(!this->pMonsterSquares[ARRAYINDEX(wX,wY)]);
-		this->pMonsterSquares[ARRAYINDEX(wX,wY)] = pMPiece;
+		SetMonsterSquare(wX, wY, pMPiece);
 		pNew->Pieces.push_back(pMPiece);
 	}
 
@@ -8250,6 +8478,17 @@ void CDbRoom::ClearMonsters(
 	this->pFirstMonster = pCharacters;  //usually NULL
 	this->wMonsterCount = this->wBrainCount = 0;
 
+	this->monsterOrder.clear();
+	this->armedMonsters.clear();
+	for (pSeek = this->pFirstMonster; pSeek != NULL; pSeek = pSeek->pNext)
+	{
+		this->monsterOrder.push_back(pSeek);
+		if (bMonsterMayHoldWeapon(pSeek))
+			this->armedMonsters.push_back(pSeek);
+	}
+	this->wNextMonsterIndex = 0;
+	++this->dwMonsterMutations;
+
 	//Don't delete Halph/Slayer entrance positions.
 }
 
@@ -8258,11 +8497,11 @@ void CDbRoom::RemoveMonsterFromLayer(CMonster *pMonster)
 {
 	if (this->pMonsterSquares)
 	{
-		this->pMonsterSquares[ARRAYINDEX(pMonster->wX, pMonster->wY)] = NULL;
+		SetMonsterSquare(pMonster->wX, pMonster->wY, NULL);
 
 		MonsterPieces::const_iterator end = pMonster->Pieces.end();
 		for (MonsterPieces::const_iterator piece = pMonster->Pieces.begin(); piece != end; ++piece)
-			this->pMonsterSquares[ARRAYINDEX((*piece)->wX, (*piece)->wY)] = NULL;
+			SetMonsterSquare((*piece)->wX, (*piece)->wY, NULL);
 	}
 }
 
@@ -8323,7 +8562,8 @@ void CDbRoom::ClearPlatforms()
 	for (UINT wIndex=this->platforms.size(); wIndex--; )
 		delete this->platforms[wIndex];
 	this->platforms.clear();
-	CPlatform::clearFallTiles();
+	if (this->pCurrentGame)
+		this->pCurrentGame->GetSimulationContext().fallTiles.clear();
 }
 
 //*****************************************************************************
@@ -8341,6 +8581,8 @@ void CDbRoom::ClearTLayer()
 	//!!! FIXME: this->tLayer is sometimes NULL here
 	if (this->tLayer)
 		memset(this->tLayer, 0, CalcRoomArea() * sizeof(RoomObject*));
+
+	InvalidateTileHash();
 }
 
 //*****************************************************************************
@@ -8918,71 +9160,31 @@ const
 		return;
 	}
 
-	CCoordStack cstack(wFirstX,wFirstY);
-	UINT wX, wY;
-	bool bAddTop, bAddBottom, bAddLeft, bAddRight;
-
-	while (cstack.PopBottom(wX,wY)) //perform as a queue for performance
-	{
-		if (!tiles.insert(wX, wY))
-			continue; //don't need to reprocess this tile if it was already handled
-
-#define PushTileIfOfType(wX, wY) do {\
-	ASSERT(IsValidColRow((wX), (wY)));\
-	if (!tiles.has((wX), (wY)))\
-		cstack.Push ((wX), (wY));} while(0)
+	//Tarstuff pieces are connected through 2x2 blocks of the tarstuff.
+	//Mark each block by its upper-left square.
+	const CBitboard& tar = GetTSquareBitboard(wTar);
+	CBitboard blocks(tar);
+	blocks &= tar.Shifted(-1, 0);
+	blocks &= tar.Shifted(0, -1);
+	blocks &= tar.Shifted(-1, -1);
 
-		//For each of the four diagonals adjacent to this tar tile:
-		//  check whether it and the two axial pieces are present.
-		//  If so, add the corner, and a flag for the axial pieces.
-		//  Add piece for each set flags.
-		const bool
-		   bTop = wY > 0 && wTar == GetTSquare(wX,wY-1),
-		bBottom = wY < this->wRoomRows-1 && wTar == GetTSquare(wX,wY+1),
-		  bLeft = wX > 0 && wTar == GetTSquare(wX-1,wY),
-		 bRight = wX < this->wRoomCols-1 && wTar == GetTSquare(wX+1,wY);
+	//Start from the blocks covering this square.  Blocks sharing any square
+	//are connected, i.e. they are 8-neighbors as marked.
+	CBitboard component(this->wRoomCols, this->wRoomRows);
+	for (UINT wY = wFirstY - 1; wY != wFirstY + 1; ++wY)
+		for (UINT wX = wFirstX - 1; wX != wFirstX + 1; ++wX)
+			if (blocks.has(wX, wY))
+				component.insert(wX, wY);
+	if (!bAddAdjOnly)
+		component.FloodFill(blocks, true);
 
-		bAddTop = bAddBottom = bAddLeft = bAddRight = false;
-      if (bTop && bLeft && wTar == GetTSquare(wX-1,wY-1))
-		{
-			PushTileIfOfType(wX-1,wY-1);
-			bAddTop = bAddLeft = true;
-		}
-      if (bTop && bRight && wTar == GetTSquare(wX+1,wY-1))
-		{
-			PushTileIfOfType(wX+1,wY-1);
-			bAddTop = bAddRight = true;
-		}
-      if (bBottom && bLeft && wTar == GetTSquare(wX-1,wY+1))
-		{
-			PushTileIfOfType(wX-1,wY+1);
-			bAddBottom = bAddLeft = true;
-		}
-      if (bBottom && bRight && wTar == GetTSquare(wX+1,wY+1))
-		{
-			PushTileIfOfType(wX+1,wY+1);
-			bAddBottom = bAddRight = true;
-		}
-
-		if (bAddTop)
-			PushTileIfOfType(wX,wY-1);
-		if (bAddBottom)
-			PushTileIfOfType(wX,wY+1);
-		if (bAddLeft)
-			PushTileIfOfType(wX-1,wY);
-		if (bAddRight)
-			PushTileIfOfType(wX+1,wY);
-
-#undef PushTileIfOfType
-
-		if (bAddAdjOnly)
-		{
-			//Add tiles in stack from first pass and stop.
-			while (cstack.PopBottom(wX,wY))
-				tiles.insert(wX, wY);
-			break;
-		}
-	}
+	//Gather the squares of the connected blocks.
+	CBitboard covered(component);
+	covered |= component.Shifted(1, 0);
+	covered |= component.Shifted(0, 1);
+	covered |= component.Shifted(1, 1);
+	covered.insert(wFirstX, wFirstY);
+	covered.AddTo(tiles);
 }
 
 //*****************************************************************************
@@ -9080,6 +9282,17 @@ void CDbRoom::GrowTar(
 	vector<tartype> added_tar(CalcRoomArea());
 	CCoordStack possible;
 	UINT x, y;
+
+	//Tarstuff can grow next to this flavor of tarstuff (or, for gel, gel
+	//contiguous to some mother).
+	CBitboard growsNextTo(GetTSquareBitboard(wTarType));
+	if (bGel)
+	{
+		CBitboard contiguous(this->wRoomCols, this->wRoomRows);
+		contiguous.insert(contiguousGel);
+		growsNextTo &= contiguous;
+	}
+	growsNextTo.Dilate(true);
 	for (x = 0; x < this->wRoomCols; ++x)
 		for (y = 0; y < this->wRoomRows; ++y)
 		{
@@ -9103,21 +9316,11 @@ void CDbRoom::GrowTar(
 			        (!pMonster || pMonster->wType == wMotherType ||
 					pMonster->wType == M_FLUFFBABY || babies.Exists(x,y)))
 			{
-				for (UINT o = 0; o < ORIENTATION_COUNT; ++o)
+				if (growsNextTo.has(x, y))
 				{
-					if (o == NO_ORIENTATION) continue;
-					const int nx = x + nGetOX(o);
-					const int ny = y + nGetOY(o);
-
-					if (!IsValidColRow(nx, ny)) continue;
-					if (GetTSquare(nx, ny) == wTarType &&
-							(!bGel || contiguousGel.has(nx,ny))) //gel must be contiguous to some mother
-					{
-						//Eligible tarstuff is adjacent to this square, so tar might grow here.
-						added_tar[pos] = newtar;
-						possible.Push(x, y);
-						break;
-					}
+					//Eligible tarstuff is adjacent to this square, so tar might grow here.
+					added_tar[pos] = newtar;
+					possible.Push(x, y);
 				}
 			}
 		}
@@ -9845,6 +10048,9 @@ void CDbRoom::SwitchTarstuff(const UINT wType1, const UINT wType2, CCueEvents& C
 							this->pLastMonster = pNew;
 						if (pMonster == this->pFirstMonster)
 							this->pFirstMonster = pNew;
+						std::replace(this->monsterOrder.begin(), this->monsterOrder.end(),
+								pMonster, pNew);
+						ASSERT(!bMonsterMayHoldWeapon(pMonster) && !bMonsterMayHoldWeapon(pNew));
 
 						//Need to re-fire a growth command from this new mother object.
 						if (bIsMother(pMonster->wType))
@@ -9887,17 +10093,16 @@ void CDbRoom::GetDoubleSwordCoords(
 	CMonster *pIgnore) //[default=NULL] optional monster to ignore in tally
 const
 {
-	UINT wSX, wSY;
 	DoubleSwordCoords.Init(this->wRoomCols, this->wRoomRows);
-	CMonster *pMonster = this->pFirstMonster;
-	while (pMonster)
+	const vector<WEAPONSQUARE>& weapons = GetWeaponSquares();
+	for (vector<WEAPONSQUARE>::const_iterator weapon = weapons.begin();
+			weapon != weapons.end(); ++weapon)
 	{
-		if (pMonster != pIgnore && pMonster->GetSwordCoords(wSX, wSY))
-			if (!(bIgnoreDagger && pMonster->GetWeaponType() == WT_Dagger) &&
-				!(bIgnoreNonCuts && !bWeaponCutsWhenStationary(pMonster->GetWeaponType())) &&
-					IsValidColRow(wSX, wSY))
-				DoubleSwordCoords.Add(wSX, wSY, 1+pMonster->wO); //avoid 0 values
-		pMonster = pMonster->pNext;
+		if (weapon->pMonster != pIgnore)
+			if (!(bIgnoreDagger && weapon->weaponType == WT_Dagger) &&
+				!(bIgnoreNonCuts && !bWeaponCutsWhenStationary(weapon->weaponType)) &&
+					IsValidColRow(weapon->wX, weapon->wY))
+				DoubleSwordCoords.Add(weapon->wX, weapon->wY, 1+weapon->wO); //avoid 0 values
 	}
 }
 
@@ -9922,7 +10127,6 @@ WeaponType CDbRoom::SwordfightCheck() const
 	CCoordSet weaponMoved; //weapon just moved to this square
 	map<UINT, WeaponType> weaponTypeAtTile;
 
-	UINT wSX, wSY;
 	CSwordsman& player = this->pCurrentGame->swordsman;
 	if (player.HasWeapon())
 	{
@@ -9933,30 +10137,28 @@ WeaponType CDbRoom::SwordfightCheck() const
 			weaponMoved.insert(player.wSwordX, player.wSwordY);
 	}
 
-	CMonster *pMonster = this->pFirstMonster;
-	while (pMonster)
+	const vector<WEAPONSQUARE>& weapons = GetWeaponSquares();
+	for (vector<WEAPONSQUARE>::const_iterator weapon = weapons.begin();
+			weapon != weapons.end(); ++weapon)
 	{
-		if (pMonster->GetSwordCoords(wSX, wSY))
-		{
-			const UINT tileIndex = ARRAYINDEX(wSX, wSY);
-			const WeaponType wt = pMonster->GetWeaponType();
+		const UINT wSX = weapon->wX, wSY = weapon->wY;
+		const UINT tileIndex = ARRAYINDEX(wSX, wSY);
+		const WeaponType wt = weapon->weaponType;
 
-			CArmedMonster *pArmedMonster = DYN_CAST(CArmedMonster*, CMonster*, pMonster);
-			if (pArmedMonster->wSwordMovement != NO_ORIENTATION)
-				weaponMoved.insert(wSX, wSY);
-			if (weaponTypeAtTile.count(tileIndex) && weaponMoved.has(wSX, wSY)) {
-				//Weapons clash.  Determine sound effect.
-				if (weaponMakesSwordSound(wt)) {
-					map<UINT, WeaponType>::const_iterator it = weaponTypeAtTile.find(tileIndex);
-					ASSERT(it != weaponTypeAtTile.end());
-					if (weaponMakesSwordSound(it->second))
-						return WT_Sword;
-				}
-				return WT_Staff;
+		CArmedMonster *pArmedMonster = DYN_CAST(CArmedMonster*, CMonster*, weapon->pMonster);
+		if (pArmedMonster->wSwordMovement != NO_ORIENTATION)
+			weaponMoved.insert(wSX, wSY);
+		if (weaponTypeAtTile.count(tileIndex) && weaponMoved.has(wSX, wSY)) {
+			//Weapons clash.  Determine sound effect.
+			if (weaponMakesSwordSound(wt)) {
+				map<UINT, WeaponType>::const_iterator it = weaponTypeAtTile.find(tileIndex);
+				ASSERT(it != weaponTypeAtTile.end());
+				if (weaponMakesSwordSound(it->second))
+					return WT_Sword;
 			}
-			weaponTypeAtTile.insert(make_pair(tileIndex, wt));
+			return WT_Staff;
 		}
-		pMonster = pMonster->pNext;
+		weaponTypeAtTile.insert(make_pair(tileIndex, wt));
 	}
 	return WT_Off;
 }
@@ -9977,16 +10179,16 @@ const
 	CaberCoords.Init(this->wRoomCols, this->wRoomRows);
 	static const UINT rdirmask[] = {DMASK_SE, DMASK_S, DMASK_SW, DMASK_E, 0, DMASK_W, DMASK_NE, DMASK_N, DMASK_NW};
 
-	CMonster *pMonster = this->pFirstMonster;
-	while (pMonster)
+	const vector<WEAPONSQUARE>& weapons = GetWeaponSquares();
+	for (vector<WEAPONSQUARE>::const_iterator weapon = weapons.begin();
+			weapon != weapons.end(); ++weapon)
 	{
-		if (pMonster->GetWeaponType() == WT_Caber && pMonster->GetSwordCoords(wSX,wSY) && IsValidColRow(wSX,wSY))
+		if (weapon->weaponType == WT_Caber && IsValidColRow(weapon->wX, weapon->wY))
 		{
-			ASSERT(pMonster->wO != NO_ORIENTATION && pMonster->wO < ORIENTATION_COUNT);
-			const UINT wMask = rdirmask[pMonster->wO];
-			CaberCoords.Add(wSX, wSY, wMask | CaberCoords.GetAt(wSX, wSY));
+			ASSERT(weapon->wO != NO_ORIENTATION && weapon->wO < ORIENTATION_COUNT);
+			const UINT wMask = rdirmask[weapon->wO];
+			CaberCoords.Add(weapon->wX, weapon->wY, wMask | CaberCoords.GetAt(weapon->wX, weapon->wY));
 		}
-		pMonster = pMonster->pNext;
 	}
 	if (this->pCurrentGame && this->pCurrentGame->swordsman.GetActiveWeapon() == WT_Caber && this->pCurrentGame->swordsman.HasWeapon() &&
 			IsValidColRow(this->pCurrentGame->swordsman.wSwordX, this->pCurrentGame->swordsman.wSwordY))
@@ -10022,6 +10224,51 @@ const
 	}
 }
 
+//*****************************************************************************
+const vector<WEAPONSQUARE>& CDbRoom::GetWeaponSquares() const
+//Returns: the weapon squares of the monsters in the room, in monster order.
+//
+//During a turn, and in the editor, these are read from each holder every time,
+//since any of them may move, turn or change weapons without the room knowing.
+//Once the turn is settled, the list is kept until the next turn starts, the
+//turn number changes or a monster is added or removed.
+{
+	const bool bSettled = this->pCurrentGame &&
+			this->pCurrentGame->wTurnNo == this->wSettledTurnNo &&
+			this->dwMonsterMutations == this->dwSettledMutations;
+	if (bSettled && this->bWeaponSquaresSettled)
+		return this->weaponSquares;
+
+	this->weaponSquares.clear();
+	for (vector<CMonster*>::const_iterator armed = this->armedMonsters.begin();
+			armed != this->armedMonsters.end(); ++armed)
+	{
+		CMonster *pMonster = *armed;
+		WEAPONSQUARE weapon;
+		if (pMonster->GetSwordCoords(weapon.wX, weapon.wY))
+		{
+			weapon.pMonster = pMonster;
+			weapon.wO = pMonster->wO;
+			weapon.weaponType = pMonster->GetWeaponType();
+			this->weaponSquares.push_back(weapon);
+		}
+	}
+	this->bWeaponSquaresSettled = bSettled;
+	return this->weaponSquares;
+}
+
+//*****************************************************************************
+void CDbRoom::SettleWeaponSquares()
+//Called once a turn has been fully processed, after which monsters' weapons
+//stay put until the next turn starts.  Lets GetWeaponSquares() reuse its list
+//for this turn number and set of monsters.
+{
+	ASSERT(this->pCurrentGame);
+	this->wSettledTurnNo = this->pCurrentGame->wTurnNo;
+	this->dwSettledMutations = this->dwMonsterMutations;
+	this->bWeaponSquaresSettled = false;
+}
+
 //*****************************************************************************
 bool CDbRoom::IsMonsterSwordAt(
 //Determines if a square contains a monster/double's sword.
@@ -10679,13 +10926,19 @@ void CDbRoom::Plot(
 	ASSERT(IsValidColRow(wX, wY));
 
 	const UINT wSquareIndex = ARRAYINDEX(wX,wY);
+
+	//Station path maps only change when the square blocks movement differently.
+	const bool bCheckStations = !this->stations.empty() && TILE_LAYER[wTileNo] != 2;
+	const UINT wOldStationMask = bCheckStations ? CStation::GetObstacleMask(*this, wX, wY) : 0;
+
 	switch (TILE_LAYER[wTileNo])
 	{
 		case 0: //Opaque layer.
+			UpdateTileHash(
+					StateHash::Key(StateHash::OSquare, wSquareIndex, GetOSquare(wX, wY)),
+					StateHash::Key(StateHash::OSquare, wSquareIndex, wTileNo));
 			this->pszOSquares[wSquareIndex] = static_cast<unsigned char>(wTileNo);
 
-			RecalcStationPaths();
-
 			this->PlotsMade.insert(wX,wY);
 			this->geometryChanges.insert(wX,wY);  //always assume changes to o-layer affect room geometry for easier maintenance
 
@@ -10693,10 +10946,14 @@ void CDbRoom::Plot(
 		break;
 
 		case 3: //Floor layer.
-			this->pszFSquares[wSquareIndex] = static_cast<unsigned char>(
-					wTileNo == T_EMPTY_F || wTileNo == T_REMOVE_FLOOR_ITEM ? T_EMPTY : wTileNo);
-			RecalcStationPaths();
+		{
+			const UINT wFTile = wTileNo == T_EMPTY_F || wTileNo == T_REMOVE_FLOOR_ITEM ? T_EMPTY : wTileNo;
+			UpdateTileHash(
+					StateHash::Key(StateHash::FSquare, wSquareIndex, GetFSquare(wX, wY)),
+					StateHash::Key(StateHash::FSquare, wSquareIndex, wFTile));
+			this->pszFSquares[wSquareIndex] = static_cast<unsigned char>(wFTile);
 			this->PlotsMade.insert(wX,wY);
+		}
 		break;
 
 		case 1: //Transparent layer.
@@ -10709,9 +10966,10 @@ void CDbRoom::Plot(
 			if (bGeometryChanging)
 				this->geometryChanges.insert(wX,wY);
 
+			const ULONGLONG oldKey = GetTLayerHash(wSquareIndex);
 			ReplaceTLayerItem(wX, wY, wTileNo, bUnderObject);
+			UpdateTileHash(oldKey, GetTLayerHash(wSquareIndex));
 
-			RecalcStationPaths();
 			this->PlotsMade.insert(wX,wY);
 		}
 		break;
@@ -10723,6 +10981,9 @@ void CDbRoom::Plot(
 		default: ASSERT(!"Invalid layer"); break;
 	}
 
+	if (bCheckStations && CStation::GetObstacleMask(*this, wX, wY) != wOldStationMask)
+		RecalcStationPaths();
+
 	UpdatePathMapAt(wX, wY);
 	ReevalBriarNear(wX,wY,wTileNo);
 }
@@ -10788,10 +11049,10 @@ void CDbRoom::PlotMonster(UINT wX, UINT wY, UINT wTileNo, CMonster *pMonster)
 	{
 		ASSERT(pMonster->IsLongMonster());
 		CMonsterPiece *pMPiece = new CMonsterPiece(pMonster, wTileNo, wX, wY);
-		this->pMonsterSquares[ARRAYINDEX(wX,wY)] = pMPiece;
+		SetMonsterSquare(wX, wY, pMPiece);
 		pMonster->Pieces.push_back(pMPiece);
 	} else {
-		this->pMonsterSquares[ARRAYINDEX(wX,wY)] = wTileNo == T_NOMONSTER ? NULL : pMonster;
+		SetMonsterSquare(wX, wY, wTileNo == T_NOMONSTER ? NULL : pMonster);
 		if (wTileNo == T_NOMONSTER)
 			this->PlotsMade.insert(wX,wY);
 	}
@@ -11049,9 +11310,12 @@ void CDbRoom::SetTParam(const UINT wX, const UINT wY, const BYTE value)
 			wTTile == T_TOKEN ||
 			wTTile == T_STATION);
 
-	RoomObject *tObj = this->tLayer[ARRAYINDEX(wX,wY)];
+	const UINT index = ARRAYINDEX(wX,wY);
+	RoomObject *tObj = this->tLayer[index];
 	ASSERT(tObj);
+	const ULONGLONG oldKey = GetTLayerHash(index);
 	tObj->param = value;
+	UpdateTileHash(oldKey, GetTLayerHash(index));
 }
 
 //*****************************************************************************
@@ -11059,11 +11323,14 @@ void CDbRoom::SetCoveredTLayerObject(const UINT wX, const UINT wY, const UINT ti
 {
 	ASSERT(IsValidColRow(wX, wY));
 
-	RoomObject *tObj = this->tLayer[ARRAYINDEX(wX,wY)];
+	const UINT index = ARRAYINDEX(wX,wY);
+	RoomObject *tObj = this->tLayer[index];
 	ASSERT(tObj);
 	ASSERT(bIsTLayerCoveringItem(tObj->tile));
 
+	const ULONGLONG oldKey = GetTLayerHash(index);
 	tObj->coveredTile = tile;
+	UpdateTileHash(oldKey, GetTLayerHash(index));
 }
 
 //*****************************************************************************
@@ -11635,6 +11902,41 @@ CDbRoom* CDbRoom::MakeCopy(CImportInfo& info, const UINT newHoldID, const bool b
 	return pCopy;
 }
 
+//*****************************************************************************
+static void ReserveMonsterCopies(
+//Reserves pool blocks for copies of a room's monsters and their pieces, so
+//each type of monster in a room copy is allocated from one contiguous chunk.
+//
+//Params:
+	const CMonster *pFirstMonster,        //(in) monster list
+	const list<CMonster*> *pDeadMonsters) //(in) dead monsters being copied, or NULL
+{
+	map<size_t, UINT> monsterCounts; //object size --> number to copy
+	UINT wPieces = 0;
+	const CMonster *pMonster;
+	for (pMonster = pFirstMonster; pMonster != NULL; pMonster = pMonster->pNext)
+	{
+		++monsterCounts[pMonster->GetObjectSize()];
+		wPieces += pMonster->Pieces.size();
+	}
+	if (pDeadMonsters)
+	{
+		for (list<CMonster*>::const_iterator m = pDeadMonsters->begin();
+				m != pDeadMonsters->end(); ++m)
+		{
+			pMonster = *m;
+			++monsterCounts[pMonster->GetObjectSize()];
+			wPieces += pMonster->Pieces.size();
+		}
+	}
+	if (wPieces)
+		monsterCounts[sizeof(CMonsterPiece)] += wPieces;
+
+	for (map<size_t, UINT>::const_iterator count = monsterCounts.begin();
+			count != monsterCounts.end(); ++count)
+		CMonsterPool::Reserve(count->first, count->second);
+}
+
 //*****************************************************************************
 bool CDbRoom::SetMembers(
 //For copy constructor and assignment operator.
@@ -11692,6 +11994,9 @@ bool CDbRoom::SetMembers(
 	memcpy(this->pszFSquares, Src.pszFSquares, dwSquareCount * sizeof(char));
 	CopyTLayer(Src.tLayerObjects);
 	this->overheadTiles = Src.overheadTiles;
+	this->tileHash = Src.tileHash;
+	this->bTileHashValid = Src.bTileHashValid;
+	this->dwGeometryVersion = Src.dwGeometryVersion;
 
 	this->tileLights = Src.tileLights;
 
@@ -11734,7 +12039,8 @@ bool CDbRoom::SetMembers(
 	//Monster data
 	this->pFirstMonster = this->pLastMonster = NULL;
 
-	memset(this->pMonsterSquares, 0, dwSquareCount * sizeof(CMonster*));
+	ClearMonsterSquares();
+	ReserveMonsterCopies(Src.pFirstMonster, bCopyLocalInfo ? &Src.DeadMonsters : NULL);
 	CMonster *pMonster, *pTrav;
 	for (pTrav = Src.pFirstMonster; pTrav != NULL; pTrav = pTrav->pNext)
 	{
@@ -11762,7 +12068,7 @@ bool CDbRoom::SetMembers(
 			if (Src.pMonsterSquares[ARRAYINDEX(pOldPiece->wX,pOldPiece->wY)] == pOldPiece)
 			{
 				ASSERT(!this->pMonsterSquares[ARRAYINDEX(pOldPiece->wX,pOldPiece->wY)]);
-				this->pMonsterSquares[ARRAYINDEX(pOldPiece->wX,pOldPiece->wY)] = pNewPiece;
+				SetMonsterSquare(pOldPiece->wX, pOldPiece->wY, pNewPiece);
 			}
 		}
 		pMonster->ResetCurrentGame();
@@ -11801,6 +12107,7 @@ bool CDbRoom::SetMembers(
 			CStation *pStation = new CStation(*(Src.stations[wIndex]), this);
 			this->stations.push_back(pStation);
 		}
+		this->dwStationPathsVersion = Src.dwStationPathsVersion;
 		this->coveredOSquares = Src.coveredOSquares;
 		this->bTarWasStabbed = Src.bTarWasStabbed;
 		this->bGreenDoorsOpened = Src.bGreenDoorsOpened;
@@ -11932,34 +12239,31 @@ void CDbRoom::InitCoveredTiles()
 	static const UINT floors[numFloors] = {T_FLOOR, T_FLOOR_M, T_FLOOR_ROAD,
 			T_FLOOR_GRASS, T_FLOOR_DIRT, T_FLOOR_ALT};   //not T_FLOOR_IMAGE
 	static const UINT pits[numPits] = {T_PIT, T_PIT_IMAGE};
-	static CTileMask floorMask, pitMask;
-	if (floorMask.empty())
-	{
-		floorMask.set(T_CHECKPOINT);  //keep for 1.6 import
-		floorMask.set(T_WALL_B);
-		floorMask.set(T_WALL_H);
-		floorMask.set(T_WALL_M);
-		floorMask.set(T_WALL_WIN);
-		floorMask.set(T_DOOR_C);
-		floorMask.set(T_DOOR_M);
-		floorMask.set(T_DOOR_R);
-		floorMask.set(T_DOOR_Y);
-		floorMask.set(T_DOOR_B);
-		floorMask.set(T_DOOR_YO);
-		floorMask.set(T_DOOR_GO);
-		floorMask.set(T_DOOR_CO);
-		floorMask.set(T_DOOR_RO);
-		floorMask.set(T_DOOR_BO);
-		floorMask.set(T_TUNNEL_N);
-		floorMask.set(T_TUNNEL_S);
-		floorMask.set(T_TUNNEL_E);
-		floorMask.set(T_TUNNEL_W);
-		floorMask.set(T_GOO);
-		floorMask.set(T_FLOOR_IMAGE);
-
-		pitMask.set(T_TRAPDOOR);
-		pitMask.set(T_PLATFORM_P);
-	}
+	CTileMask floorMask, pitMask;
+	floorMask.set(T_CHECKPOINT);  //keep for 1.6 import
+	floorMask.set(T_WALL_B);
+	floorMask.set(T_WALL_H);
+	floorMask.set(T_WALL_M);
+	floorMask.set(T_WALL_WIN);
+	floorMask.set(T_DOOR_C);
+	floorMask.set(T_DOOR_M);
+	floorMask.set(T_DOOR_R);
+	floorMask.set(T_DOOR_Y);
+	floorMask.set(T_DOOR_B);
+	floorMask.set(T_DOOR_YO);
+	floorMask.set(T_DOOR_GO);
+	floorMask.set(T_DOOR_CO);
+	floorMask.set(T_DOOR_RO);
+	floorMask.set(T_DOOR_BO);
+	floorMask.set(T_TUNNEL_N);
+	floorMask.set(T_TUNNEL_S);
+	floorMask.set(T_TUNNEL_E);
+	floorMask.set(T_TUNNEL_W);
+	floorMask.set(T_GOO);
+	floorMask.set(T_FLOOR_IMAGE);
+
+	pitMask.set(T_TRAPDOOR);
+	pitMask.set(T_PLATFORM_P);
 
 	this->coveredOSquares.Init(this->wRoomCols, this->wRoomRows);
 
@@ -12015,6 +12319,9 @@ void CDbRoom::InitStateForThisTurn()
 {
 	ClearStateVarsUsedDuringTurn();
 
+	//Weapons may move from here until the turn is settled.
+	++this->dwMonsterMutations;
+
 	//Any lit fuses are no longer "new", and eligible to spread next time
 	//we reach BurnFuses().
 	this->LitFuses += this->NewFuses;
@@ -12288,97 +12595,51 @@ const
 	if (!IsValidColRow(wX,wY))
 		return;
 
-	if (pIgnoreSquares && pIgnoreSquares->has(wX, wY)) return;
-	if (pRegionMask && !pRegionMask->has(wX, wY)) return;
-
-	if (!tileMask.get(GetOSquare(wX, wY)) && !tileMask.get(GetTSquare(wX, wY)))
-		return;
-
-#define PushTileIfOfType(x,y) {\
-	ASSERT(IsValidColRow((x), (y)));\
-	if ( (tileMask.get(GetOSquare((x), (y))) || tileMask.get(GetTSquare((x), (y))))\
-			&& !squares.has((x), (y)) && (!pIgnoreSquares || !pIgnoreSquares->has((x), (y)))\
-			&& (!pRegionMask || pRegionMask->has((x), (y))) )\
-		evalCoords.Push((x), (y));}
+	CBitboard tiles;
+	GetTileBitboard(tileMask, tiles, pIgnoreSquares, pRegionMask);
+	GetConnectedTiles(wX, wY, tiles, eConnect, squares);
+}
 
-#define CheckForPitAt(x,y) {\
-	switch (GetOSquare((x),(y))) {\
-		case T_PIT: case T_PIT_IMAGE: case T_PLATFORM_P: bAdjacentPit = true; break; } }
+//*****************************************************************************
+void CDbRoom::GetConnectedTiles(
+//As above, with the squares that may be gathered already marked.
+//
+//Params:
+	const UINT wX, const UINT wY, //(in) square to check from
+	const CBitboard& tiles,       //(in) squares that may be gathered
+	const TileConnectionStrategy eConnect, //(in) connection strategy
+	CCoordSet& squares)           //(out) set of contiguous tiles
+const
+{
+	squares.clear();
 
-	const bool b8Neighbor = eConnect == Connect_8;
-	const UINT rightEdge = this->wRoomRows - 1;
-	const UINT lowerEdge = this->wRoomCols - 1;
+	if (!tiles.has(wX, wY))
+		return;
 
-	UINT wEvalX, wEvalY;
-	CCoordStack evalCoords(wX,wY);
-	while (evalCoords.PopBottom(wEvalX,wEvalY)) //perform as a queue for performance
+	CBitboard component(this->wRoomCols, this->wRoomRows);
+	component.insert(wX, wY);
+	if (eConnect == Connect_8_WithoutAxialPit)
 	{
-		// If the tile is of this type, add it to the squares set and
-		// push surrounding tiles onto the evaluation stack.
-		if (!squares.insert(wEvalX, wEvalY))
-			continue; //don't need to reprocess this tile if it was already handled
-
-		const bool bGTLeft = wEvalX > 0;
-		const bool bGTTop = wEvalY > 0;
-		const bool bLTBottom = wEvalY < rightEdge;
-		const bool bLTRight = wEvalX < lowerEdge;
-
-		//Add adjacent coords to Eval stack.
-		if (eConnect == Connect_8_WithoutAxialPit) {
-			bool bAdjacentPit = false;
-
-			if (bGTLeft) {
-				CheckForPitAt(wEvalX - 1, wEvalY);
-				PushTileIfOfType(wEvalX - 1, wEvalY);
-			}
-			if (bGTTop) {
-				CheckForPitAt(wEvalX, wEvalY - 1);
-				PushTileIfOfType(wEvalX, wEvalY - 1);
-			}
-			if (bLTRight) {
-				CheckForPitAt(wEvalX + 1, wEvalY);
-				PushTileIfOfType(wEvalX + 1, wEvalY);
-			}
-			if (bLTBottom) {
-				CheckForPitAt(wEvalX, wEvalY + 1);
-				PushTileIfOfType(wEvalX, wEvalY + 1);
-			}
-
-			if (!bAdjacentPit) {
-				if (bGTLeft) {
-					if (bGTTop) PushTileIfOfType(wEvalX - 1, wEvalY - 1);
-					if (bLTBottom) PushTileIfOfType(wEvalX - 1, wEvalY + 1);
-				}
-				if (bLTRight) {
-					if (bGTTop) PushTileIfOfType(wEvalX + 1, wEvalY - 1);
-					if (bLTBottom) PushTileIfOfType(wEvalX + 1, wEvalY + 1);
-				}
-			}
-		} else {
-			if (bGTLeft)
-			{
-				PushTileIfOfType(wEvalX - 1, wEvalY);
-				if (b8Neighbor)
+		//No diagonal connections are made from squares beside a pit.
+		CBitboard pits(this->wRoomCols, this->wRoomRows);
+		for (UINT wPitX = 0; wPitX < this->wRoomCols; ++wPitX)
+			for (UINT wPitY = 0; wPitY < this->wRoomRows; ++wPitY)
+				switch (GetOSquare(wPitX, wPitY))
 				{
-					if (bGTTop) PushTileIfOfType(wEvalX - 1, wEvalY - 1);
-					if (bLTBottom) PushTileIfOfType(wEvalX - 1, wEvalY + 1);
-				}
-			}
-			if (bGTTop) PushTileIfOfType(wEvalX, wEvalY - 1);
-			if (bLTRight)
-			{
-				PushTileIfOfType(wEvalX + 1, wEvalY);
-				if (b8Neighbor)
-				{
-					if (bGTTop) PushTileIfOfType(wEvalX + 1, wEvalY - 1);
-					if (bLTBottom) PushTileIfOfType(wEvalX + 1, wEvalY + 1);
+					case T_PIT: case T_PIT_IMAGE: case T_PLATFORM_P:
+						pits.insert(wPitX, wPitY);
+					break;
+					default: break;
 				}
-			}
-			if (bLTBottom) PushTileIfOfType(wEvalX, wEvalY + 1);
-		}
+		CBitboard besidePits(pits.Shifted(-1, 0));
+		besidePits |= pits.Shifted(1, 0);
+		besidePits |= pits.Shifted(0, -1);
+		besidePits |= pits.Shifted(0, 1);
+		component.FloodFill(tiles, true, &besidePits);
+	} else {
+		component.FloodFill(tiles, eConnect == Connect_8);
 	}
-#undef PushTileIfOfType
-#undef CheckForPitAt
+	component.AddTo(squares);
 }
 
 //*****************************************************************************
@@ -12399,15 +12660,16 @@ const
 	UINT numRegions = 0;
 	bool haveE=false, haveS=false, haveW=false;
 
-	CCoordSet ignore;
-	if (pIgnoreSquares)
-		ignore = *pIgnoreSquares;
-	ignore.insert(wX,wY);
+	//The squares that may be gathered are the same for each region.
+	CBitboard tiles;
+	GetTileBitboard(tileMask, tiles, pIgnoreSquares, pRegionMask);
+	if (IsValidColRow(wX, wY))
+		tiles.erase(wX, wY);
 
 	{
 		regions.resize(++numRegions);
 		CCoordSet& currRegion = regions.back();
-		GetConnected4NeighborTiles(wX, wY-1, tileMask, currRegion, &ignore, pRegionMask);
+		GetConnectedTiles(wX, wY-1, tiles, Connect_4, currRegion);
 		if (currRegion.has(wX+1,wY))
 			haveE = true;
 		if (currRegion.has(wX,wY+1))
@@ -12422,7 +12684,7 @@ const
 	{
 		regions.resize(++numRegions);
 		CCoordSet& currRegion = regions.back();
-		GetConnected4NeighborTiles(wX+1, wY, tileMask, currRegion, &ignore, pRegionMask);
+		GetConnectedTiles(wX+1, wY, tiles, Connect_4, currRegion);
 		if (currRegion.has(wX,wY+1))
 			haveS = true;
 		if (currRegion.has(wX-1,wY))
@@ -12435,7 +12697,7 @@ const
 	{
 		regions.resize(++numRegions);
 		CCoordSet& currRegion = regions.back();
-		GetConnected4NeighborTiles(wX, wY+1, tileMask, currRegion, &ignore, pRegionMask);
+		GetConnectedTiles(wX, wY+1, tiles, Connect_4, currRegion);
 		if (currRegion.has(wX-1,wY))
 			haveW = true;
 		if (currRegion.empty())
@@ -12446,7 +12708,7 @@ const
 	{
 		regions.resize(++numRegions);
 		CCoordSet& currRegion = regions.back();
-		GetConnected4NeighborTiles(wX-1, wY, tileMask, currRegion, &ignore, pRegionMask);
+		GetConnectedTiles(wX-1, wY, tiles, Connect_4, currRegion);
 		if (currRegion.empty())
 			--numRegions;
 	}
@@ -12454,6 +12716,113 @@ const
 	regions.resize(numRegions);
 }
 
+//*****************************************************************************
+void CDbRoom::GetTileBitboard(
+//Marks the squares with a tile of indicated type on the o- or t-layer.
+//
+//Params:
+	const CTileMask &tileMask,    //(in) which type of tiles to mark
+	CBitboard& tiles,             //(out) marked squares
+	const CCoordSet* pIgnoreSquares, //(in) optional set of squares to leave unmarked [default=NULL]
+	const CCoordSet* pRegionMask)    //(in) optional region to limit marks to [default=NULL]
+const
+{
+	tiles.resize(this->wRoomCols, this->wRoomRows);
+	for (UINT wX = 0; wX < this->wRoomCols; ++wX)
+		for (UINT wY = 0; wY < this->wRoomRows; ++wY)
+			if (tileMask.get(GetOSquare(wX, wY)) || tileMask.get(GetTSquare(wX, wY)))
+				tiles.insert(wX, wY);
+
+	if (pIgnoreSquares)
+	{
+		CBitboard ignore(this->wRoomCols, this->wRoomRows);
+		ignore.insert(*pIgnoreSquares);
+		tiles -= ignore;
+	}
+	if (pRegionMask)
+	{
+		CBitboard region(this->wRoomCols, this->wRoomRows);
+		region.insert(*pRegionMask);
+		tiles &= region;
+	}
+}
+
+//*****************************************************************************
+const CBitboard& CDbRoom::GetTSquareBitboard(
+//Returns: the squares with the indicated tile on the t-layer
+//
+//Params:
+	const UINT wTile) //(in) t-layer tile
+const
+{
+	ASSERT(wTile != T_EMPTY);
+	if (this->wTSquareBitsTile != wTile || this->dwTSquareBitsVersion != this->dwGeometryVersion)
+	{
+		this->tSquareBits.resize(this->wRoomCols, this->wRoomRows);
+		for (UINT wX = 0; wX < this->wRoomCols; ++wX)
+			for (UINT wY = 0; wY < this->wRoomRows; ++wY)
+				if (GetTSquare(ARRAYINDEX(wX,wY)) == wTile)
+					this->tSquareBits.insert(wX, wY);
+		this->wTSquareBitsTile = wTile;
+		this->dwTSquareBitsVersion = this->dwGeometryVersion;
+	}
+	return this->tSquareBits;
+}
+
+//*****************************************************************************
+const EYEGAZE& CDbRoom::GetEvilEyeGaze(
+//Returns: the path of an evil eye's gaze from (wX,wY) facing wO.
+//Gazes depend only on the room's tiles, so each is traced once and kept
+//until the geometry changes.
+//
+//Params:
+	const UINT wX, const UINT wY, //(in) square gaze starts from
+	const UINT wO)                //(in) direction gaze faces
+{
+	ASSERT(IsValidColRow(wX, wY));
+	ASSERT(IsValidOrientation(wO) && wO != NO_ORIENTATION);
+	if (this->dwEyeGazesVersion != this->dwGeometryVersion)
+	{
+		this->eyeGazes.clear();
+		this->dwEyeGazesVersion = this->dwGeometryVersion;
+	}
+
+	const UINT key = ARRAYINDEX(wX,wY) * ORIENTATION_COUNT + wO;
+	std::map<UINT, EYEGAZE>::iterator found = this->eyeGazes.find(key);
+	if (found != this->eyeGazes.end())
+		return found->second;
+
+	EYEGAZE& gaze = this->eyeGazes[key];
+	UINT cx = wX, cy = wY;
+	int dx = nGetOX(wO), dy = nGetOY(wO);
+	bool bReflected = false;
+	gaze.wFirstReflected = UINT(-1);
+	for (;;)
+	{
+		const bool bContinueGaze = CEvilEye::GetNextGaze(this, cx, cy, dx, dy, bReflected);
+		if (!IsValidColRow(cx, cy))
+		{
+			//Gaze left the room.
+			ASSERT(!bContinueGaze);
+			gaze.wOpenSquares = gaze.squares.size();
+			break;
+		}
+		if (bReflected && gaze.wFirstReflected == UINT(-1))
+			gaze.wFirstReflected = gaze.squares.size();
+		gaze.squares.push_back(ROOMCOORD(cx, cy));
+		if (!bContinueGaze)
+		{
+			//Gaze is blocked on this square.
+			gaze.wOpenSquares = gaze.squares.size() - 1;
+			break;
+		}
+	}
+
+	if (gaze.wFirstReflected == UINT(-1))
+		gaze.wFirstReflected = gaze.squares.size();
+	return gaze;
+}
+
 //*****************************************************************************
 void CDbRoom::GetAllYellowDoorSquares(
 //Compiles set of all squares for yellow door, starting at (wX,wY).
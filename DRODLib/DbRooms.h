@@ -52,11 +52,13 @@
 #include "TileMask.h"
 #include "NetInterface.h"
 
+#include <BackEndLib/Bitboard.h>
 #include <BackEndLib/CoordIndex.h>
 #include <BackEndLib/CoordSet.h>
 #include <BackEndLib/CoordStack.h>
 
 #include <list>
+#include <map>
 
 //******************************************************************************************
 class CDbRooms;
@@ -68,6 +70,24 @@ class CDbDatum;
 class CCueEvents;
 class CPlayerDouble;
 class CPlatform;
+//Path of an evil eye's gaze from a square, as traced by CEvilEye::GetNextGaze.
+struct EYEGAZE
+{
+	vector<ROOMCOORD> squares; //squares seen, in order, ending with the one the
+	                           //gaze is blocked on when that is in the room
+	UINT wOpenSquares;         //squares the gaze passes through before it is blocked
+	UINT wFirstReflected;      //first square seen after a mirror, or squares.size()
+};
+
+//A held weapon and the square it is on, as listed by CDbRoom::GetWeaponSquares.
+struct WEAPONSQUARE
+{
+	CMonster *pMonster;    //holder
+	UINT wX, wY;           //weapon square, which might be outside the room
+	UINT wO;               //holder's orientation
+	WeaponType weaponType;
+};
+
 class CDbRoom : public CDbBase
 {
 protected:
@@ -147,6 +167,7 @@ public:
 	list<CPlayerDouble*> Decoys, monsterEnemies;  //player decoys, monster enemies in the room
 	vector<CPlatform*>   platforms;  //all moving platforms in the room
 	vector<CStation*>    stations;   //all relay stations in the room
+	UINT           dwStationPathsVersion; //changes whenever a station path map is recalculated
 	CCoordIndex    coveredOSquares;  //what is under removable o-tile objects
 	CCoordIndex_T<USHORT> pressurePlateIndex; //which pressure plate is on this square
 	bool				bTarWasStabbed;	//for "dangerous room" heuristic
@@ -313,6 +334,10 @@ public:
 	COrbData*      GetPressurePlateAtCoords(const UINT wX, const UINT wY) const;
 	const WCHAR*   GetScrollTextAtSquare(const UINT wX, const UINT wY) const;
 	CScrollData*   GetScrollAtSquare(const UINT wX, const UINT wY) const;
+	const EYEGAZE& GetEvilEyeGaze(const UINT wX, const UINT wY, const UINT wO);
+	UINT           GetGeometryVersion() const {return this->dwGeometryVersion;}
+	ULONGLONG      GetTileHash() const;
+	ULONGLONG      GetTurnStateHash() const;
 	UINT           GetOSquare(const UINT wX, const UINT wY) const;
 	UINT           GetFSquare(const UINT wX, const UINT wY) const;
 	UINT           GetTSquare(const UINT wX, const UINT wY) const;
@@ -380,6 +405,14 @@ public:
 	void           LightFuseEnd(CCueEvents &CueEvents, const UINT wCol, const UINT wRow);
 	void           LinkMonster(CMonster *pMonster, const bool bInRoom=true, const bool bReverseRule=false);
 	void           UnlinkMonster(CMonster *pMonster);
+	const vector<CMonster*>& GetMonstersInProcessOrder() const {return this->monsterOrder;}
+	//Walk of the monsters in process order.  Monsters linked or unlinked during
+	//the walk are visited or skipped just as a walk of the monster list would.
+	void           StartMonsterProcessing() {this->wNextMonsterIndex = 0;}
+	CMonster*      GetNextMonsterToProcess() {
+		return this->wNextMonsterIndex < this->monsterOrder.size() ?
+				this->monsterOrder[this->wNextMonsterIndex++] : NULL;
+	}
 	bool           Load(const UINT dwLoadRoomID, const bool bQuick=false);
 	CMonster*      LoadMonster(const c4_RowRef& row, CDbHold* &pHold);
 	bool           LoadTiles();
@@ -434,9 +467,11 @@ public:
 
 	void           SetHalphSlayerEntrance();
 	void           SetMonsterSquare(CMonster *pMonster);
+	void           SetMonsterSquare(const UINT wX, const UINT wY, CMonster *pMonster);
 	void           SetPathMapsTarget(const UINT wX, const UINT wY);
 	void           SetPressurePlatesState();
 	void           SetRoomLightingChanged() { room_lighting_changed = true; }
+	void           SwapMonsterSquares(const UINT wX1, const UINT wY1, const UINT wX2, const UINT wY2);
 	void           SetTParam(const UINT wX, const UINT wY, const BYTE value);
 
 	//Import handling
@@ -453,6 +488,7 @@ public:
 	void           SetScrollTextAtSquare(const UINT wX, const UINT wY, const WCHAR* pwczScrollText);
 	void           SetExit(const UINT dwEntranceID, const UINT wX, const UINT wY,
 			const UINT wX2=(UINT)-1, const UINT wY2=(UINT)-1);
+	void           SettleWeaponSquares();
 	bool           SomeMonsterCanSmellSwordsman() const;
 	bool           StabTar(const UINT wX, const UINT wY, CCueEvents &CueEvents,
 			const bool removeTarNow, const UINT wStabO=NO_ORIENTATION);
@@ -493,6 +529,7 @@ private:
 			CCoordSet& newGrowth, CCoordSet& newPuffs, CCueEvents &CueEvents);
 
 	void           Clear();
+	void           ClearMonsterSquares();
 	void           ClearPushStates();
 	void           ClearStateVarsUsedDuringTurn();
 	void           CloseYellowDoor(const UINT wX, const UINT wY, CCueEvents &CueEvents);
@@ -500,6 +537,7 @@ private:
 	void           DeletePathMaps();
 	CCoordStack    GetPowderKegsStillOnHotTiles() const;
 	void           ExplodeStabbedPowderKegs(CCueEvents& CueEvents);
+	bool           FindMonsterSquareInRow(UINT &wX, const UINT wY, const UINT wRight) const;
 	UINT           FuseEndAt(const UINT wCol, const UINT wRow, const bool bLighting=true) const;
 	UINT           GentryiiFallsInPit(UINT wPrevX, UINT wPrevY,
 			MonsterPieces::iterator pieceIt, MonsterPieces::const_iterator pieces_end,
@@ -507,12 +545,19 @@ private:
 	void           GetConnectedTiles(const UINT wX, const UINT wY,
 			const CTileMask &tileMask, const TileConnectionStrategy eConnect, CCoordSet& squares,
 			const CCoordSet* pIgnoreSquares=NULL, const CCoordSet* pRegionMask=NULL) const;
+	void           GetConnectedTiles(const UINT wX, const UINT wY, const CBitboard& tiles,
+			const TileConnectionStrategy eConnect, CCoordSet& squares) const;
 	void           GetLevelPositionDescription_English(WSTRING &wstrDescription,
 			const int dx, const int dy, const bool bAbbrev=false);
 	void           GetLevelPositionDescription_Russian(WSTRING &wstrDescription,
 			const int dx, const int dy, const bool bAbbrev=false);
 	UINT           GetLocalID() const;
 	void           GetNumber_English(const UINT num, WCHAR *str);
+	ULONGLONG      GetTLayerHash(const UINT index) const;
+	void           GetTileBitboard(const CTileMask &tileMask, CBitboard& tiles,
+			const CCoordSet* pIgnoreSquares=NULL, const CCoordSet* pRegionMask=NULL) const;
+	const CBitboard& GetTSquareBitboard(const UINT wTile) const;
+	const vector<WEAPONSQUARE>& GetWeaponSquares() const;
 	bool           LargeMonsterFalls(CMonster* &pMonster, const UINT wX, const UINT wY, CCueEvents& CueEvents);
 	bool           LoadOrbs(c4_View &OrbsView);
 	bool           LoadMonsters(c4_View &MonstersView);
@@ -563,6 +608,10 @@ private:
 	bool           UpdateExisting();
 	bool           UpdateNew();
 	void           UpdateFields(c4_RowRef& row);
+	void           InvalidateTileHash()
+		{this->bTileHashValid = false; ++this->dwGeometryVersion;}
+	void           UpdateTileHash(const ULONGLONG oldKey, const ULONGLONG newKey)
+		{if (this->bTileHashValid) this->tileHash ^= oldKey ^ newKey; ++this->dwGeometryVersion;}
 
 	list<CMonster *>  DeadMonsters;
 	list<RoomObject*> DeadRoomObjects;
@@ -580,6 +629,47 @@ private:
 	set<const CMonster*> monsters_stabbed_by_spikes_this_turn;
 	CCoordStack stabbed_powder_kegs;
 	bool room_lighting_changed;
+
+	//Which squares pMonsterSquares has a monster on, as a bitmask for each row,
+	//so searching a rect only needs to look at the squares that are occupied.
+	vector<UINT>   monsterRowBits;
+	UINT           wMonsterRowWords;  //words of bits per row
+
+	//Hash of the o-, f- and t-layers, updated as tiles are plotted.
+	//Rebuilt on demand when the layers are (re)loaded.
+	mutable ULONGLONG tileHash;
+	mutable bool      bTileHashValid;
+
+	//Changes whenever the tile hash does, so cached results that depend on
+	//the room's tiles can tell cheaply whether they are still current.
+	UINT           dwGeometryVersion;
+
+	//Squares with a given t-layer tile, kept until the room's geometry changes.
+	mutable CBitboard tSquareBits;
+	mutable UINT   wTSquareBitsTile;      //tile in tSquareBits, or T_EMPTY if not built
+	mutable UINT   dwTSquareBitsVersion;  //geometry version it was built at
+
+	//Evil eye gazes traced so far, by square and orientation, kept until the
+	//room's geometry changes.
+	std::map<UINT, EYEGAZE> eyeGazes;
+	UINT           dwEyeGazesVersion;     //geometry version they were traced at
+
+	//The monster list as an array, kept in step by LinkMonster and UnlinkMonster.
+	vector<CMonster*> monsterOrder;
+	UINT           wNextMonsterIndex; //next monster for GetNextMonsterToProcess()
+
+	//Monsters in monsterOrder whose type can hold a weapon, in the same order.
+	//Weapon queries only need to look at these.
+	vector<CMonster*> armedMonsters;
+
+	//Weapon squares of armedMonsters.  Between turns these are reused as long as
+	//the game's turn number and dwMonsterMutations still match the values that
+	//SettleWeaponSquares() recorded once the last turn was done.
+	mutable vector<WEAPONSQUARE> weaponSquares;
+	mutable bool   bWeaponSquaresSettled; //weaponSquares was built at the settled turn
+	UINT           dwMonsterMutations;    //bumped on monster list changes and at turn start
+	UINT           wSettledTurnNo;
+	UINT           dwSettledMutations;
 };
 
 //******************************************************************************************
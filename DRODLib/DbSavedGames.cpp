@@ -35,6 +35,7 @@
 #include "DbProps.h"
 #include "DbXML.h"
 #include "MonsterFactory.h"
+#include "ReplayVerifier.h"
 #include "../Texts/MIDs.h"
 #include <BackEndLib/Base64.h>
 #include <BackEndLib/Exception.h>
@@ -903,7 +904,8 @@ bool CDbSavedGame::SetMembers(
 //For copy constructor and assignment operator.
 //
 //Params:
-	const CDbSavedGame &Src)
+	const CDbSavedGame &Src,
+	const bool bCopyCommands) //[default=true]
 {
 	//primitive types
 	this->dwSavedGameID = Src.dwSavedGameID;
@@ -931,7 +933,8 @@ bool CDbSavedGame::SetMembers(
 	this->worldMapIcons = Src.worldMapIcons;
 	this->Created = Src.Created;
 	this->LastUpdated = Src.LastUpdated;
-	this->Commands = Src.Commands;
+	if (bCopyCommands)
+		this->Commands = Src.Commands;
 
 	//Overall game "scores"
 	this->dwLevelDeaths = Src.dwLevelDeaths;
@@ -1132,21 +1135,27 @@ void CDbSavedGames::VerifyForRoom(
 {
 	//Test demos and their saved games...
 	CDb db;
-	CIDList DemoStats;
+	CReplayVerifier demoVerifier(db);
 	CIDSet ids = CDb::getDemosInRoom(dwRoomID);
 	CIDSet::const_iterator iter;
 	for (iter = ids.begin(); iter != ids.end(); ++iter)
+		demoVerifier.AddDemo(*iter);
+	demoVerifier.Run();
+
+	UINT wJob;
+	for (wJob = 0; wJob < demoVerifier.GetJobCount(); ++wJob)
 	{
-		CDbDemo *pDemo = db.Demos.GetByID(*iter);
+		const REPLAYJOB& job = demoVerifier.GetJob(wJob);
+		CDbDemo *pDemo = job.pDemo;
 		ASSERT(pDemo);
-		if (!pDemo->Test(DemoStats))
-			db.Demos.Delete(*iter);
+		if (job.eResult != RR_Passed)
+			db.Demos.Delete(job.dwID);
 		else
 		{
 			//Mark whether these demos result in victory or death.
-			const bool bDeath = GetDemoStatBool(DemoStats, DS_DidPlayerDie) ||
-					GetDemoStatBool(DemoStats, DS_DidHalphDie);
-			const bool bVictory = GetDemoStatBool(DemoStats, DS_WasRoomConquered);
+			const bool bDeath = GetDemoStatBool(job.DemoStats, DS_DidPlayerDie) ||
+					GetDemoStatBool(job.DemoStats, DS_DidHalphDie);
+			const bool bVictory = GetDemoStatBool(job.DemoStats, DS_WasRoomConquered);
 			if (pDemo->IsFlagSet(CDbDemo::Victory) != bVictory ||
 					pDemo->IsFlagSet(CDbDemo::Death) != bDeath)
 			{
@@ -1155,25 +1164,27 @@ void CDbSavedGames::VerifyForRoom(
 				pDemo->Update();
 			}
 		}
-		delete pDemo;
 	}
 
 	//...and then saved games w/o demos.
-	CCueEvents Ignored;
-	CCurrentGame *pCurrentGame;
+	CReplayVerifier savedGameVerifier(db);
 	ids = CDb::getSavedGamesInRoom(dwRoomID);
 	for (iter = ids.begin(); iter != ids.end(); ++iter)
+		savedGameVerifier.AddSavedGame(*iter);
+	const UINT dwActivePlayerID = db.GetPlayerID();
+	savedGameVerifier.Run();
+	db.SetPlayerID(dwActivePlayerID, false);
+
+	for (wJob = 0; wJob < savedGameVerifier.GetJobCount(); ++wJob)
 	{
-		pCurrentGame = db.GetSavedCurrentGame(*iter, Ignored, true);
-		ASSERT(pCurrentGame);
-		if (!pCurrentGame)
+		const REPLAYJOB& job = savedGameVerifier.GetJob(wJob);
+		ASSERT(job.eResult != RR_LoadFailed);
+		if (job.eResult == RR_LoadFailed)
 		{
 			//Saved game can't even be loaded -- data was corrupted?
-			db.SavedGames.Delete(*iter);
-		} else {
-			if (!pCurrentGame->PlayAllCommands(Ignored, true))
-				pCurrentGame->Update(); //truncate commands that can't be played back
-			delete pCurrentGame;
+			db.SavedGames.Delete(job.dwID);
+		} else if (job.eResult == RR_Failed) {
+			job.pGame->Update(); //truncate commands that can't be played back
 		}
 	}
 }
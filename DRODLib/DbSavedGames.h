@@ -127,6 +127,7 @@ public:
 
 protected:
 	void     Clear(const bool bNewGame=true);
+	bool     SetMembers(const CDbSavedGame &Src, const bool bCopyCommands=true);
 
 private:
 	void     SaveCompletedScripts(c4_View &CompletedScriptsView) const;
@@ -137,7 +138,6 @@ private:
 	void     SaveWorldMapIcons(c4_View &WorldMapIconsView) const;
 	void     SaveFields(c4_RowRef& row);
 
-	bool     SetMembers(const CDbSavedGame &Src);
 	bool     UpdateExisting();
 	bool     UpdateNew();
 };
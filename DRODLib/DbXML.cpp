@@ -32,6 +32,7 @@
 
 #include "DbXML.h"
 #include "CurrentGame.h"
+#include "ReplayVerifier.h"
 #include "SettingsKeys.h"
 
 #include <BackEndLib/Exception.h>
@@ -1328,7 +1329,6 @@ void CDbXML::VerifySavedGames()
 	{
 	CDb db;
 	CCueEvents Ignored;
-	CCurrentGame *pCurrentGame;
 
 	const UINT dwActivePlayer = g_pTheDB->GetPlayerID(); 
 	UINT dwCurrentPlayerID = 0;
@@ -1355,7 +1355,6 @@ void CDbXML::VerifySavedGames()
 		bFullValidate = atoi(str.c_str()) != 0;
 
 	float fNumRecords;
-	UINT wCount;
 	UINT dwTime;
 	WCHAR temp[10];
 	UINT holdCount = 1;
@@ -1400,13 +1399,19 @@ void CDbXML::VerifySavedGames()
 			}
 
 			//Test each demo for integrity.
-			for (iter = demoIDs.begin(), wCount = 0; iter != demoIDs.end(); ++iter)
+			CReplayVerifier demoVerifier(db);
+			for (iter = demoIDs.begin(); iter != demoIDs.end(); ++iter)
+				demoVerifier.AddDemo(*iter);
+			demoVerifier.Run(PerformCallbackf);
+
+			//Apply results.
+			for (UINT wJob = 0; wJob < demoVerifier.GetJobCount(); ++wJob)
 			{
-				CDbDemo *pDemo = db.Demos.GetByID(*iter);
+				REPLAYJOB& job = demoVerifier.GetJob(wJob);
+				CDbDemo *pDemo = job.pDemo;
 				ASSERT(pDemo);
 				demoSavedGameIDs += pDemo->dwSavedGameID;	//don't recheck saved games for demos that were just checked
-				CIDList DemoStats;
-				if (!pDemo->Test(DemoStats))
+				if (job.eResult != RR_Passed)
 				{
 					//Delete broken demo and make a written record of this.
 					if (!bMarkedBroken)
@@ -1437,9 +1442,10 @@ void CDbXML::VerifySavedGames()
 						delete pRoom;
 					}
 
-					db.Demos.Delete(*iter);
+					db.Demos.Delete(job.dwID);
 				} else {
 					//Mark whether these demos result in victory or death.
+					const CIDList& DemoStats = job.DemoStats;
 					const bool bDeath = GetDemoStatBool(DemoStats, DS_DidPlayerDie) ||
 							GetDemoStatBool(DemoStats, DS_DidHalphDie);
 					const bool bVictory = GetDemoStatBool(DemoStats, DS_WasRoomConquered);
@@ -1455,12 +1461,10 @@ void CDbXML::VerifySavedGames()
 						if (pDemo->GetTimeElapsed(dwTime)) {
 							CNetRoom room(pDemo);
 							CDbXML::upgradedHoldVictoryDemos.push_back(DEMO_UPLOAD(
-								room, string(), wProcessedTurnCount, dwTime, *iter, 0, CDbDemo::Victory, pDemo->GetAuthorText()));
+								room, string(), wProcessedTurnCount, dwTime, job.dwID, 0, CDbDemo::Victory, pDemo->GetAuthorText()));
 						}
 					}
 				}
-				delete pDemo;
-				PerformCallbackf(++wCount/fNumRecords);
 			}
 		}
 		//else: saved games attached to demos will be minimally verified below
@@ -1498,44 +1502,43 @@ void CDbXML::VerifySavedGames()
 			wstr += db.GetMessageText(MID_VerifyingSavedGames);
 			PerformCallbackText(wstr.c_str());
 		}
-		for (iter = savedGameIDs.begin(), wCount = 0; iter != savedGameIDs.end(); ++iter)
+		//Full validation:
+		//0 - Only determine whether saved game may be loaded to its initial state
+		//1 - Replay move sequence and truncate any invalid moves.
+		CReplayVerifier savedGameVerifier(db);
+		for (iter = savedGameIDs.begin(); iter != savedGameIDs.end(); ++iter)
+			savedGameVerifier.AddSavedGame(*iter);
+		savedGameVerifier.Run(PerformCallbackf, bFullValidate);
+
+		//Apply results.
+		for (UINT wJob = 0; wJob < savedGameVerifier.GetJobCount(); ++wJob)
 		{
-			const UINT savedGameID = *iter;
-			const UINT dwPlayerID = db.SavedGames.GetPlayerIDofSavedGame(savedGameID);
-			const UINT dwRoomID = db.SavedGames.GetRoomIDofSavedGame(savedGameID);
-			if (!dwRoomID) {
-				pCurrentGame = NULL;
-			} else {
-				db.SetPlayerID(dwPlayerID, false);
-
-				//Checks that the saved commands can be replayed.
-				pCurrentGame = db.GetSavedCurrentGame(savedGameID, Ignored, true,
-       					true); //don't save to DB while replaying commands
-				if (!pCurrentGame)
-				{
-					//Saved game can't even be loaded -- it was probably recorded in
-					//a room that no longer exists.
-					db.SavedGames.Delete(savedGameID);
-					continue;
-				}
+			const REPLAYJOB& job = savedGameVerifier.GetJob(wJob);
+			if (job.eResult == RR_Skipped)
+				continue;
+			if (job.eResult == RR_LoadFailed)
+			{
+				//Saved game can't even be loaded -- it was probably recorded in
+				//a room that no longer exists.
+				db.SavedGames.Delete(job.dwID);
+				continue;
 			}
 
 			//Tally rooms.
-			tallyIter = playerRoomTallies.find(dwPlayerID);
+			tallyIter = playerRoomTallies.find(job.dwPlayerID);
 			if (tallyIter == playerRoomTallies.end())
 			{
-				playerRoomTallies[dwPlayerID] = roomSet();
-				tallyIter = playerRoomTallies.find(dwPlayerID);
+				playerRoomTallies[job.dwPlayerID] = roomSet();
+				tallyIter = playerRoomTallies.find(job.dwPlayerID);
 				ASSERT(tallyIter != playerRoomTallies.end());
 			}
-			tallyIter->second.conquered += pCurrentGame->ConqueredRooms;
-			tallyIter->second.explored += pCurrentGame->ExploredRooms;
-			
-			//Full validation:
-			//0 - Only determine whether saved game may be loaded to its initial state
-			//1 - Replay move sequence and truncate any invalid moves.
-			if (bFullValidate && pCurrentGame && !pCurrentGame->PlayAllCommands(Ignored, true))
+			tallyIter->second.conquered += job.ConqueredRooms;
+			tallyIter->second.explored += job.ExploredRooms;
+
+			if (job.eResult == RR_Failed)
 			{
+				CCurrentGame *pCurrentGame = job.pGame;
+				ASSERT(pCurrentGame);
 				if (!bMarkedBroken)
 				{
 					CDbHold *pHold = db.Holds.GetByID(*hold, true);
@@ -1559,10 +1562,6 @@ void CDbXML::VerifySavedGames()
 
 				pCurrentGame->Update(); //truncate commands that can't be played back
 			}
-			delete pCurrentGame;
-			pCurrentGame = NULL;
-			Ignored.Clear();
-			PerformCallbackf(++wCount/fNumRecords);
 		}
 	}
 
@@ -30,6 +30,7 @@
 #include "EvilEye.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //
 //Public methods.
@@ -42,6 +43,14 @@ CEvilEye::CEvilEye(CCurrentGame *pSetCurrentGame) : CMonster(M_EYE, pSetCurrentG
 {
 }
 
+//*****************************************************************************************
+ULONGLONG CEvilEye::GetStateHash() const
+//Returns: a hash of this monster's game state, including whether it is awake
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState, 0, 0,
+			0x02000000 | (this->bIsActive ? 1 : 0) | (this->bHalfAwake ? 2 : 0));
+}
+
 //*****************************************************************************************
 void CEvilEye::Process(
 //Process an Evil Eye for movement.
@@ -162,14 +171,20 @@ bool CEvilEye::WakeupCheck(
 	const bool bPlayerVisible = player.IsVisible();
 	nOX = nGetOX(this->wO);
 	nOY = nGetOY(this->wO);
-	UINT cx = this->wX, cy = this->wY, wDist = 1;
-	bool bReflected = false;
-	bool bContinueGaze = true;
-	do
+
+	//The gaze's path only changes with the room's tiles, so the room keeps it.
+	const EYEGAZE& gaze = this->pCurrentGame->pRoom->GetEvilEyeGaze(this->wX, this->wY, this->wO);
+	for (UINT wIndex = 0; wIndex < gaze.squares.size(); ++wIndex)
 	{
-		bContinueGaze = GetNextGaze(this->pCurrentGame->pRoom,cx,cy,nOX,nOY,bReflected);
-		if (cx >= this->pCurrentGame->pRoom->wRoomCols || cy >= this->pCurrentGame->pRoom->wRoomRows)
-			break; //out of bounds -- nothing can happen here
+		const UINT cx = gaze.squares[wIndex].wX, cy = gaze.squares[wIndex].wY;
+		const UINT wDist = wIndex + 1;
+		const bool bReflected = wIndex >= gaze.wFirstReflected;
+		if (wIndex == gaze.wFirstReflected)
+		{
+			//Gaze was turned back by a mirror.
+			nOX = -nOX;
+			nOY = -nOY;
+		}
 		const bool bIsPlayer = cx == wSX && cy == wSY;
 		const bool bCanSmell = wDist <= DEFAULT_SMELL_RANGE && !bReflected;
 		bool bIsTarget = false;
@@ -209,8 +224,7 @@ bool CEvilEye::WakeupCheck(
 				return true;
 			}
 		}
-		++wDist;
-	} while (bContinueGaze);
+	}
 
 	ASSERT(!this->bIsActive);
 
@@ -45,6 +45,7 @@ public:
 
 	static  bool GetNextGaze(CDbRoom *pRoom, UINT& cx, UINT& cy,
 			int& dx, int& dy, bool& bReflected);
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsAggressive() const {return this->bIsActive;}
 	virtual void Process(const int nLastCommand, CCueEvents &CueEvents);
 	void         SetActive(const bool bVal=true) {this->bIsActive = bVal;}
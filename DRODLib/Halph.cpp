@@ -30,6 +30,7 @@
 #include "Halph.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 #include <queue>
 
 //
@@ -44,6 +45,8 @@ CHalph::CHalph(
 	: CMonster(type, pSetCurrentGame, eMovement)
 	, state(Entering)
 	, wMoves(0)
+	, bPlateIsGoal(false)
+	, openingDoorAt(static_cast<UINT>(-1), static_cast<UINT>(-1))
 {}
 
 //*****************************************************************************************
@@ -51,6 +54,16 @@ CHalph2::CHalph2(CCurrentGame *pSetCurrentGame, const UINT /*type*/) //[default=
 	: CHalph(pSetCurrentGame, GROUND_AND_SHALLOW_WATER, M_HALPH2)
 {}
 
+//*****************************************************************************************
+ULONGLONG CHalph::GetStateHash() const
+//Returns: a hash of Halph's game state, including what he is trying to do
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			(this->state << 16) | this->wMoves,
+			(this->openingDoorAt.wY << 16) | (this->openingDoorAt.wX & 0xffff),
+			0x06000000 | (this->bPlateIsGoal ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CHalph::Process(
 //Process Halph for movement.
@@ -108,7 +121,7 @@ void CHalph::Process(
 			//This will be calculated more quickly than a brain pathmap since player
 			//will almost always be within a couple squares of Halph.
 			CCoordSet dest(player.wX, player.wY);
-			this->pCurrentGame->pRoom->GetSwordCoords(this->swordsInRoom); //speed optimization
+			this->pCurrentGame->pRoom->GetSwordCoords(GetSimulationContext().swordsInRoom); //speed optimization
 			const bool bRes = FindOptimalPathTo(this->wX, this->wY, dest);
 			player.wSwordX = wSaveSwordX;	//restore value
 			if (bRes)
@@ -197,7 +210,7 @@ bool CHalph::GetPathTo(
 	const CCoordSet *pDirectDests)  //(in) set of tiles that must be stepped on directly [default=NULL]
 {
 	//Confirm path to goal is still open.
-	this->pCurrentGame->pRoom->GetSwordCoords(this->swordsInRoom); //speed optimization
+	this->pCurrentGame->pRoom->GetSwordCoords(GetSimulationContext().swordsInRoom); //speed optimization
 	if (!ConfirmPath())
 	{
 		//If it's not, search for a new path to the goal.
@@ -488,7 +501,7 @@ const
 		return true;
 
 	//Can't step on any swords.
-	if (this->swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
+	if (GetSimulationContext().swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
 		return true;
 
 	//Player can never be stepped on.
@@ -564,7 +577,7 @@ void CHalph::RequestOpenDoor(
 	room.FindPlatesToOpenDoor(plates, doorSquares);
 
 	//Tell Halph to try to hit any of these orbs or step on these plates.
-	room.GetSwordCoords(this->swordsInRoom); //speed optimization
+	room.GetSwordCoords(GetSimulationContext().swordsInRoom); //speed optimization
 	bool bPlatePathFound = false;
 	bool bOrbPathFound = FindOptimalPathTo(this->wX, this->wY, orbs);
 	if (bOrbPathFound)
@@ -44,6 +44,7 @@ public:
 
 	virtual bool BrainAffects() const {return false;}
 	virtual bool DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsTileObstacle(const UINT wTileNo) const;
 	virtual void Process(const int nLastCommand, CCueEvents &CueEvents);
 
@@ -34,6 +34,7 @@
 #include "Character.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 #include <BackEndLib/Base64.h>
 #include <BackEndLib/Ports.h>
 
@@ -41,10 +42,6 @@
 
 #define NO_TARGET ((UINT)-1) //this distance to a target represents no valid option
 
-CCoordIndex_T<UINT> CMonster::room;
-CCoordIndex CMonster::searchMoves;
-CCoordIndex CMonster::swordsInRoom;
-bool CMonster::calculatingPathmap = false;
 
 //Node object used in pathfinding search.
 class CPathNode : public CCoord
@@ -63,27 +60,12 @@ public:
 	bool operator <(const CPathNode& mc) const {return this->wScore >= mc.wScore;}
 };
 
-//Fixed version
-class CPathNode2 : public CCoord
-{
-public:
-	CPathNode2(const UINT wX, const UINT wY, const UINT wCost, const UINT wScore)
-		: CCoord(wX, wY)
-		, wCost(wCost), wScore(wScore)
-	{ }
-	UINT wCost;    //f -- distance already traveled
-	UINT wScore;   //f+g -- cost + lowest possible remaining distance to goal
-
-	//For priority queue insertion:
-	bool operator <(const CPathNode2& mc) const {return mc.wScore < this->wScore;}
-};
-
 namespace Path
 {
 	const UINT wNumNeighbors = 8;
 	const int dXs[wNumNeighbors] = { 0,  1,  0, -1,  1,  1, -1, -1};
 	const int dYs[wNumNeighbors] = {-1,  0,  1,  0, -1,  1,  1, -1};
-	const UINT O_MOD = 16;   //each cell in CMonster::room stores (dist * O_MOD + direction from previous square)
+	const UINT O_MOD = 16;   //each cell in the path search index stores (dist * O_MOD + direction from previous square)
 }
 
 //
@@ -107,9 +89,10 @@ CMonster::CMonster(
 	, stunned(0), bNewStun(false)
 	, bPushedThisTurn(false)
 	, bWaitedOnHotFloorLastTurn(false)
+	, bSafeToDelete(true)
 	, pNext(NULL), pPrevious(NULL)
 	, pCurrentGame(NULL)
-	, bSafeToDelete(true)
+	, wNextPathSearch(0)
 {
 	if (pSetCurrentGame)
 		SetCurrentGame(pSetCurrentGame);
@@ -149,9 +132,7 @@ void CMonster::ReflectX(CDbRoom *pRoom)
 	ASSERT(pRoom);
 	const UINT wNewX = (pRoom->wRoomCols-1) - this->wX;
 	if (this == pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX, this->wY)])
-		std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(wNewX,this->wY)]);
+		pRoom->SwapMonsterSquares(this->wX, this->wY, wNewX, this->wY);
 
 	for (MonsterPieces::const_iterator piece=this->Pieces.begin();
 			piece != this->Pieces.end(); ++piece)
@@ -169,9 +150,7 @@ void CMonster::ReflectY(CDbRoom *pRoom)
 	ASSERT(pRoom);
 	const UINT wNewY = (pRoom->wRoomRows-1) - this->wY;
 	if (this == pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX, this->wY)])
-		std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,wNewY)]);
+		pRoom->SwapMonsterSquares(this->wX, this->wY, this->wX, wNewY);
 
 	for (MonsterPieces::const_iterator piece=this->Pieces.begin();
 			piece != this->Pieces.end(); ++piece)
@@ -581,7 +560,7 @@ CheckMonster:
 			)
 		){
 
-			if (!CMonster::calculatingPathmap || pMonster->IsNPCPathmapObstacle())
+			if (!GetSimulationContext().bCalculatingPathmap || pMonster->IsNPCPathmapObstacle())
 				return true;
 		}
 	}
@@ -725,9 +704,117 @@ bool CMonster::ConfirmPath()
 	return bPathOpen;
 }
 
+//*****************************************************************************
+void CMonster::CachePathSearch(
+//Keeps the result of a path search just made, replacing the oldest one kept.
+//
+//Params:
+	const ULONGLONG searchKey,    //(in) search made
+	const SEARCHREGION& region,   //(in) squares the search looked at
+	const bool bFound)            //(in) whether a path was found
+{
+	if (!CanCachePathSearch())
+		return;
+
+	PATHSEARCH& search = this->pathSearches[this->wNextPathSearch];
+	this->wNextPathSearch = (this->wNextPathSearch + 1) % PATH_SEARCHES_CACHED;
+
+	search.searchKey = searchKey;
+	search.region = region;
+	search.regionHash = GetSearchRegionHash(region);
+	search.bFound = bFound;
+	search.goal = this->goal;
+	search.path = this->pathToDest;
+}
+
+//*****************************************************************************
+bool CMonster::CanCachePathSearch() const
+//Returns: whether a path search made from where the monster is now only depends
+//on the squares in and around the region it expands.
+//
+//A monster standing on a platform may step off the platform's edge only if the
+//whole platform can move that way, which depends on squares anywhere in the room.
+{
+	return !bIsPlatform(this->pCurrentGame->pRoom->GetOSquare(this->wX, this->wY));
+}
+
+//*****************************************************************************
+bool CMonster::FindCachedPathSearch(
+//Looks for the same search already made while the squares it looked at were
+//as they are now.  If one is found, its path and goal are restored.
+//
+//Returns: whether the search was found
+//
+//Params:
+	const ULONGLONG searchKey, //(in) search to be made
+	bool& bFound)              //(out) if found, whether it found a path
+{
+	if (!CanCachePathSearch())
+		return false;
+
+	for (UINT wI=0; wI<PATH_SEARCHES_CACHED; ++wI)
+	{
+		const PATHSEARCH& search = this->pathSearches[wI];
+		if (search.searchKey != searchKey)
+			continue;
+
+		//Changes elsewhere in the room don't affect the search.
+		if (search.regionHash != GetSearchRegionHash(search.region))
+			continue;
+
+		bFound = search.bFound;
+		this->goal = search.goal;
+		this->pathToDest = search.path;
+		return true;
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+ULONGLONG CMonster::GetSearchRegionHash(
+//Returns: a hash of everything a path search's moves through a region depend on
+//
+//Params:
+	const SEARCHREGION& region) //(in) squares the search looked at
+const
+{
+	//Moves test the square stepped onto and the one past it (for pushing),
+	//and weapons can reach one square further from an adjacent monster.
+	static const UINT wPad = 3;
+
+	const CDbRoom& room = *(this->pCurrentGame->pRoom);
+	const UINT wLeft = region.wLeft > wPad ? region.wLeft - wPad : 0;
+	const UINT wTop = region.wTop > wPad ? region.wTop - wPad : 0;
+	const UINT wRight = min(region.wRight + wPad, room.wRoomCols - 1);
+	const UINT wBottom = min(region.wBottom + wPad, room.wRoomRows - 1);
+
+	ULONGLONG hash = StateHash::Key(StateHash::PathSearch, (wTop << 16) | wLeft,
+			(wBottom << 16) | wRight);
+	for (UINT wY=wTop; wY<=wBottom; ++wY)
+		for (UINT wX=wLeft; wX<=wRight; ++wX)
+		{
+			const UINT index = room.ARRAYINDEX(wX, wY);
+			hash ^= StateHash::Key(StateHash::TSquare, index,
+					(room.GetOSquare(wX, wY) << 16) | room.GetFSquare(wX, wY),
+					(room.GetCoveredTSquare(wX, wY) << 16) | room.GetTSquare(wX, wY));
+			const CMonster *pMonster = room.GetMonsterAtSquare(wX, wY);
+			if (pMonster)
+				hash ^= StateHash::Mix(pMonster->GetStateHash() + index);
+		}
+
+	const CSwordsman& player = this->pCurrentGame->swordsman;
+	if (player.wX >= wLeft && player.wX <= wRight && player.wY >= wTop && player.wY <= wBottom)
+		hash ^= player.GetStateHash();
+
+	return hash;
+}
+
 //*****************************************************************************
 bool CMonster::FindOptimalPathTo(
 //Find the shortest path to any of the given destinations using A* search.
+//The same search made again while nothing it looked at has changed reuses the
+//last result.
 //
 //Returns: true if path found, else false
 //
@@ -739,6 +826,33 @@ bool CMonster::FindOptimalPathTo(
 	const bool bPathThroughObstacles) //[default=false] if set,
 	   //then when path is completely blocked, find the path with fewest obstacles to the goal
 {
+	ULONGLONG searchKey = StateHash::Key(StateHash::PathSearch, (wY << 16) | wX,
+			(bAdjIsGood ? 2 : 0) | (bPathThroughObstacles ? 1 : 0));
+	for (CCoordSet::const_iterator dest = dests.begin(); dest != dests.end(); ++dest)
+		searchKey = StateHash::Mix(searchKey ^ ((dest->wY << 16) | dest->wX));
+
+	bool bFound;
+	if (FindCachedPathSearch(searchKey, bFound))
+		return bFound;
+
+	SEARCHREGION region(wX, wY);
+	bFound = SearchOptimalPathTo(wX, wY, dests, bAdjIsGood, bPathThroughObstacles, region);
+	CachePathSearch(searchKey, region, bFound);
+	return bFound;
+}
+
+//*****************************************************************************
+bool CMonster::SearchOptimalPathTo(
+//Searches for the path FindOptimalPathTo returns.
+//
+//Params:
+	const UINT wX, const UINT wY, //(in) starting location
+	const CCoordSet &dests, //(in) possible goal destinations
+	const bool bAdjIsGood,  //(in) whether arriving next to a destination is sufficient
+	const bool bPathThroughObstacles, //(in) whether to path through obstacles when blocked
+	SEARCHREGION& region)   //(in/out) extended to cover the squares looked at
+{
+	CCoordIndex_T<UINT>& pathSearch = GetSimulationContext().pathSearch;
 	this->pathToDest.Clear();
 
 	if (dests.empty())
@@ -752,11 +866,11 @@ bool CMonster::FindOptimalPathTo(
 
 	//Init search.
 	CDbRoom& curGameRoom = *(this->pCurrentGame->pRoom);
-	VERIFY(CMonster::room.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
+	VERIFY(pathSearch.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
 
 	//Push starting node.
-	const UINT dwCostThroughObstacle = CMonster::room.GetArea() * Path::O_MOD;
-	CMonster::room.Add(wX, wY, Path::O_MOD + Path::wNumNeighbors);  //small number ensures this square will never be visited
+	const UINT dwCostThroughObstacle = pathSearch.GetArea() * Path::O_MOD;
+	pathSearch.Add(wX, wY, Path::O_MOD + Path::wNumNeighbors);  //small number ensures this square will never be visited
 	CPathNode coord(wX, wY, 0, dist);
 	priority_queue<CPathNode> open;
 	open.push(coord);
@@ -767,6 +881,7 @@ bool CMonster::FindOptimalPathTo(
 		//Expand best-valued node.
 		coord = open.top();
 		open.pop();
+		region.Add(coord.wX, coord.wY);
 
 		//If a questionable path has been found,
 		//continue searching until no better path might be found.
@@ -780,7 +895,7 @@ bool CMonster::FindOptimalPathTo(
 			wNewX = coord.wX + (dx = Path::dXs[nIndex]);
 			wNewY = coord.wY + (dy = Path::dYs[nIndex]);
 			if (!curGameRoom.IsValidColRow(wNewX, wNewY)) continue;
-			const UINT wSquareScore = CMonster::room.GetAt(wNewX,wNewY) / Path::O_MOD;
+			const UINT wSquareScore = pathSearch.GetAt(wNewX,wNewY) / Path::O_MOD;
 			//Only allow visiting a square if (1) it hasn't been visited, or
 			//(2) this is the shortest path to the square so far.
 			if (wSquareScore && wSquareScore <= wCostPlusOne) continue;
@@ -795,7 +910,7 @@ bool CMonster::FindOptimalPathTo(
 						continue;
 				}
 
-				CMonster::room.Add(wNewX, wNewY, newScore); //node is now visited
+				pathSearch.Add(wNewX, wNewY, newScore); //node is now visited
 
 				dist = getMinDistance(wNewX, wNewY, dests, this->goal);
 				if (dist <= nCloseEnough) //Close enough to destination.
@@ -824,12 +939,44 @@ bool CMonster::FindOptimalPathTo(
 
 //*****************************************************************************
 //Fixed version of A* pathfinding that prefers non-diagonal movements
-//and applies a proper operator< for priority queuing
+//and applies a proper operator< for priority queuing.
+//The same search made again while nothing it looked at has changed reuses the
+//last result.
 bool CMonster::FindOptimalPath2(
 	const UINT wStartX, const UINT wStartY,
 	const UINT wGoalX, const UINT wGoalY,
 	const bool bPathThroughObstacles)
 {
+	if (wStartX == wGoalX && wStartY == wGoalY)
+	{
+		this->pathToDest.Clear();
+		return true; //At the destination -- no search needed.
+	}
+
+	//Which way the monster faces breaks ties between paths.
+	const ULONGLONG searchKey = StateHash::Key(StateHash::PathSearch, (wStartY << 16) | wStartX,
+			(wGoalY << 16) | wGoalX, 0x100 | (this->wO << 1) | (bPathThroughObstacles ? 1 : 0));
+
+	bool bFound;
+	if (FindCachedPathSearch(searchKey, bFound))
+		return bFound;
+
+	SEARCHREGION region(wStartX, wStartY);
+	bFound = SearchOptimalPath2(wStartX, wStartY, wGoalX, wGoalY, bPathThroughObstacles, region);
+	CachePathSearch(searchKey, region, bFound);
+	return bFound;
+}
+
+//*****************************************************************************
+bool CMonster::SearchOptimalPath2(
+//Searches for the path FindOptimalPath2 returns.
+	const UINT wStartX, const UINT wStartY,
+	const UINT wGoalX, const UINT wGoalY,
+	const bool bPathThroughObstacles,
+	SEARCHREGION& region)   //(in/out) extended to cover the squares looked at
+{
+	CSimulationContext& context = GetSimulationContext();
+	CPathSearchSpace& search = context.pathSearchSpace;
 	this->pathToDest.Clear();
 
 	if (wStartX == wGoalX && wStartY == wGoalY)
@@ -839,29 +986,27 @@ bool CMonster::FindOptimalPath2(
 	this->goal.wX = wGoalX;
 	this->goal.wY = wGoalY;
 	CDbRoom& curGameRoom = *(this->pCurrentGame->pRoom);
-	VERIFY(CMonster::room.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
-	VERIFY(CMonster::searchMoves.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
+	search.Start(curGameRoom.wRoomCols, curGameRoom.wRoomRows);
+	const UINT wArea = curGameRoom.CalcRoomArea();
 
 	//larger than the sum of move indexes for a path of maximum possible length
-	const UINT STEP_INC = CMonster::room.GetArea() * Path::O_MOD;
+	const UINT STEP_INC = wArea * Path::O_MOD;
 
-	const UINT dwCostThroughObstacle = STEP_INC * CMonster::room.GetArea();
+	const UINT dwCostThroughObstacle = STEP_INC * wArea;
 	ASSERT(dwCostThroughObstacle < UINT(-1) / max(curGameRoom.wRoomCols, curGameRoom.wRoomRows)); //avoid potential overflow
 
 	//Push starting node.
-	CMonster::room.Add(wStartX, wStartY, 1);  //small number ensures this square will never be visited
-	CMonster::searchMoves.Add(wStartX, wStartY, 1+this->wO);
+	search.Visit(wStartX, wStartY, 1, 1+this->wO);  //small score ensures this square will never be visited
 	int dist = nDist(wStartX, wStartY, wGoalX, wGoalY);
-	CPathNode2 coord(wStartX, wStartY, 0, dist*STEP_INC);
-	priority_queue<CPathNode2> open;
-	open.push(coord);
+	CPathSearchSpace::NODE coord(wStartX, wStartY, 0, dist*STEP_INC);
+	search.Push(coord);
 
 	UINT bestScore = 0;
 	int dx, dy, wNewX, wNewY;
 	do {
 		//Expand best-valued node.
-		coord = open.top();
-		open.pop();
+		coord = search.Pop();
+		region.Add(coord.wX, coord.wY);
 
 		//If a questionable path has been found,
 		//continue searching until no better path might be found.
@@ -875,10 +1020,10 @@ bool CMonster::FindOptimalPath2(
 			wNewX = coord.wX + (dx = Path::dXs[nIndex]);
 			wNewY = coord.wY + (dy = Path::dYs[nIndex]);
 			if (!curGameRoom.IsValidColRow(wNewX, wNewY)) continue;
-			const UINT wSquareScore = CMonster::room.GetAt(wNewX, wNewY);
+			const UINT wSquareScore = search.GetScore(wNewX, wNewY);
 			UINT newScore = wNextStepCost +
 					nIndex*2; //break ties on movement direction
-			const bool bChangedDirection = (1+nIndex != CMonster::searchMoves.GetAt(coord.wX, coord.wY));
+			const bool bChangedDirection = (1+nIndex != search.GetMove(coord.wX, coord.wY));
 			if (bChangedDirection)
 				++newScore; //...and whether turning was required to make this step
 
@@ -889,9 +1034,9 @@ bool CMonster::FindOptimalPath2(
 			//If monster can move to this square...
 
 			//pathmapping through NPCs flagged to pathmap through is only considered on later moves in the path
-			CMonster::calculatingPathmap = coord.wX != wStartX || coord.wY != wStartY;
+			context.bCalculatingPathmap = coord.wX != wStartX || coord.wY != wStartY;
 			const bool bOpenMove = IsOpenMove(coord.wX, coord.wY, dx, dy) || (UINT(wNewX) == wGoalX && UINT(wNewY) == wGoalY);
-			CMonster::calculatingPathmap = false;
+			context.bCalculatingPathmap = false;
 
 			if (bOpenMove || bPathThroughObstacles)
 			{
@@ -901,8 +1046,7 @@ bool CMonster::FindOptimalPath2(
 						continue;
 				}
 
-				CMonster::room.Add(wNewX, wNewY, newScore); //node is now visited
-				CMonster::searchMoves.Add(wNewX, wNewY, 1+nIndex); //direction moved to get here
+				search.Visit(wNewX, wNewY, newScore, 1+nIndex); //node is now visited, with direction moved to get here
 
 				dist = nDist(wNewX, wNewY, wGoalX, wGoalY);
 				if (!dist)
@@ -913,7 +1057,7 @@ bool CMonster::FindOptimalPath2(
 					{
 						this->pathToDest.Push(wNewX, wNewY);
 						//Reverse the step made to this square.
-						const UINT wO = CMonster::searchMoves.GetAt(wNewX, wNewY) - 1;
+						const UINT wO = search.GetMove(wNewX, wNewY) - 1;
 						ASSERT(wO < Path::wNumNeighbors);
 						wNewX -= Path::dXs[wO];
 						wNewY -= Path::dYs[wO];
@@ -924,11 +1068,11 @@ bool CMonster::FindOptimalPath2(
 					bestScore = newScore;
 				} else {
 					//...Add this unvisited node to priority queue.
-					open.push(CPathNode2(wNewX, wNewY, newScore, newScore + dist*STEP_INC));
+					search.Push(CPathSearchSpace::NODE(wNewX, wNewY, newScore, newScore + dist*STEP_INC));
 				}
 			}
 		}
-	} while (!open.empty());
+	} while (!search.empty());
 
 	//No path found.
 	return false;
@@ -943,13 +1087,14 @@ bool CMonster::FindOptimalPathToClosestMonster(
 //Params:
 	const UINT wX, const UINT wY, const CIDSet& monsterTypes) //(in) starting location
 {
+	CCoordIndex_T<UINT>& pathSearch = GetSimulationContext().pathSearch;
 	//Init search.
 	this->pathToDest.Clear();
 	CDbRoom& curGameRoom = *(this->pCurrentGame->pRoom);
-	VERIFY(CMonster::room.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
+	VERIFY(pathSearch.Init(curGameRoom.wRoomCols, curGameRoom.wRoomRows));
 
 	//Push starting node.
-	CMonster::room.Add(wX,wY, Path::O_MOD + Path::wNumNeighbors);  //large number ensures this square will never be visited
+	pathSearch.Add(wX,wY, Path::O_MOD + Path::wNumNeighbors);  //large number ensures this square will never be visited
 	CPathNode coord(wX, wY, 0, 1);
 	priority_queue<CPathNode> open;
 	open.push(coord);
@@ -974,7 +1119,7 @@ bool CMonster::FindOptimalPathToClosestMonster(
 			wNewY = coord.wY + (dy = Path::dYs[nIndex]);
 			if (!curGameRoom.IsValidColRow(wNewX, wNewY))
 				continue;
-			const UINT wSquareScore = CMonster::room.GetAt(wNewX,wNewY) / Path::O_MOD;
+			const UINT wSquareScore = pathSearch.GetAt(wNewX,wNewY) / Path::O_MOD;
 			//Only allow visiting a square if (1) it hasn't been visited, or
 			//(2) this is the shortest path to the square so far.
 			if (wSquareScore && wSquareScore <= wCostPlusOne)
@@ -990,7 +1135,7 @@ bool CMonster::FindOptimalPathToClosestMonster(
 					wGoalDistance = wCostPlusOne;
 					this->goal.wX = wNewX;
 					this->goal.wY = wNewY;
-					CMonster::room.Add(wNewX, wNewY, wGoalDistance * Path::O_MOD + nIndex);  //last node in path
+					pathSearch.Add(wNewX, wNewY, wGoalDistance * Path::O_MOD + nIndex);  //last node in path
 
 					//Continue searching for better path to this goal until done.
 					break;
@@ -1003,7 +1148,7 @@ bool CMonster::FindOptimalPathToClosestMonster(
 				//...Add this unvisited node to priority queue.
 				const UINT newScore = wCostPlusOne * Path::O_MOD + nIndex;
 				open.push(CPathNode(wNewX, wNewY, newScore, newScore));
-				CMonster::room.Add(wNewX, wNewY, newScore);  //node is now visited
+				pathSearch.Add(wNewX, wNewY, newScore);  //node is now visited
 			}
 		}
 	} while (!open.empty());
@@ -1017,13 +1162,22 @@ bool CMonster::FindOptimalPathToClosestMonster(
 	return true;
 }
 
+//*****************************************************************************
+CSimulationContext& CMonster::GetSimulationContext() const
+//Returns: pathfinding scratch state for the game this monster is in
+{
+	return ::GetSimulationContext(this->pCurrentGame);
+}
+
+//*****************************************************************************
 void CMonster::PushPathFromGoal(UINT endX, UINT endY, UINT startX, UINT startY)
 {
+	CCoordIndex_T<UINT>& pathSearch = GetSimulationContext().pathSearch;
 	while (endX != startX || endY != startY)  //until starting point is returned to
 	{
 		this->pathToDest.Push(endX, endY);
 		//Reverse the step made to this square.
-		const UINT wO = CMonster::room.GetAt(endX, endY) % Path::O_MOD;
+		const UINT wO = pathSearch.GetAt(endX, endY) % Path::O_MOD;
 		ASSERT(wO < Path::wNumNeighbors);
 		endX -= Path::dXs[wO];
 		endY -= Path::dYs[wO];
@@ -1084,6 +1238,30 @@ const CMonster* CMonster::GetOwningMonsterConst() const {
 	return this;
 }
 
+//*****************************************************************************
+ULONGLONG CMonster::GetStateHash() const
+//Returns: a hash of this monster's game state, for CCurrentGame::GetStateHash()
+{
+	ULONGLONG hash = StateHash::Key(StateHash::Monster,
+			(this->wType << 16) | GetIdentity(),
+			(this->wY << 16) | this->wX,
+			(this->wO << 24) | (this->stunned << 8) | (this->bAlive ? 1 : 0));
+	hash ^= StateHash::Key(StateHash::MonsterState, this->wProcessSequence, 0,
+			(this->bIsFirstTurn ? 1 : 0) | (this->bWaitedOnHotFloorLastTurn ? 2 : 0) |
+			(this->bForceWeaponAttack ? 4 : 0));
+	hash ^= this->ExtraVars.GetHash();
+
+	for (MonsterPieces::const_iterator piece = this->Pieces.begin();
+			piece != this->Pieces.end(); ++piece)
+	{
+		const CMonsterPiece& monsterPiece = **piece;
+		hash ^= StateHash::Key(StateHash::MonsterPiece, monsterPiece.wTileNo,
+				(monsterPiece.wY << 16) | monsterPiece.wX);
+	}
+
+	return hash;
+}
+
 //*****************************************************************************
 bool CMonster::IsConquerable() const
 {
@@ -71,6 +71,7 @@
 #include "DbPackedVars.h"
 #include "DbRefs.h"
 #include "GameConstants.h"
+#include "MonsterPool.h"
 #include "Weapons.h"
 #include <BackEndLib/Coord.h>
 #include <BackEndLib/CoordIndex.h>
@@ -165,7 +166,8 @@ static inline MovementType GetHornMovementType(MovementType movement)
 //******************************************************************************************
 //method used herein should be public
 #define IMPLEMENT_CLONE(CBase, CDerived) virtual CBase* Clone() const \
-	{ return new CDerived(*this); }
+	{ return new CDerived(*this); } \
+	virtual size_t GetObjectSize() const { return sizeof(CDerived); }
 #define IMPLEMENT_CLONE_REPLICATE(CBase, CDerived) \
 	IMPLEMENT_CLONE(CBase, CDerived) \
 	virtual CBase* Replicate() const { return Clone(); }
@@ -210,6 +212,7 @@ class CCueEvents;
 class CCurrentGame;
 class CMonsterFactory;
 class CDbRoom;
+class CSimulationContext;
 class CMonster : public CEntity
 {
 protected:
@@ -223,6 +226,11 @@ public:
 
 	virtual CMonster *Clone() const=0;
 	virtual CMonster *Replicate() const=0;
+	virtual size_t GetObjectSize() const=0;
+
+	//Monsters and their pieces are allocated from CMonsterPool.
+	static void*  operator new(size_t size) {return CMonsterPool::Allocate(size);}
+	static void   operator delete(void *p, size_t size) {CMonsterPool::Free(p, size);}
 
 	void          AskYesNo(MESSAGE_ID eMessageID, CCueEvents &CueEvents) const;
 	virtual bool  BrainAffects() const {return true;}
@@ -276,6 +284,7 @@ public:
 	CCoordSet     GetMatchingEndTiles(const vector<CCoord>& coords) const;
 	virtual UINT  GetProcessSequence() const;
 	virtual UINT  GetResolvedIdentity() const {return GetIdentity();}
+	virtual ULONGLONG GetStateHash() const;
 	UINT          GetOrientationFacingTarget(const UINT wX, const UINT wY) const;
 	virtual CCoordStack GetStoredPath() const { return this->pathToDest; }
 	bool          GetSwordCoords(UINT& wX, UINT& wY) const;
@@ -375,13 +384,53 @@ protected:
 	CCoordStack pathToDest; //sequence of squares that lead to preferred goal coord
 	ROOMCOORD goal; //goal coord
 
-	static CCoordIndex_T<UINT> room; //for breadth-first search
-	static CCoordIndex searchMoves;  //moves made during search
-	static CCoordIndex swordsInRoom;  //speed optimization for pathmapping
-	static bool calculatingPathmap;
+	CSimulationContext& GetSimulationContext() const;
 
 private:
+	//Bounds of the squares a path search expanded.
+	struct SEARCHREGION
+	{
+		SEARCHREGION(const UINT wX, const UINT wY)
+			: wLeft(wX), wTop(wY), wRight(wX), wBottom(wY) { }
+		void Add(const UINT wX, const UINT wY)
+		{
+			if (wX < this->wLeft) this->wLeft = wX;
+			if (wX > this->wRight) this->wRight = wX;
+			if (wY < this->wTop) this->wTop = wY;
+			if (wY > this->wBottom) this->wBottom = wY;
+		}
+		UINT wLeft, wTop, wRight, wBottom;
+	};
+
+	void          CachePathSearch(const ULONGLONG searchKey, const SEARCHREGION& region,
+			const bool bFound);
+	bool          CanCachePathSearch() const;
+	bool          FindCachedPathSearch(const ULONGLONG searchKey, bool& bFound);
+	ULONGLONG     GetSearchRegionHash(const SEARCHREGION& region) const;
 	void          PushPathFromGoal(UINT endX, UINT endY, UINT startX, UINT startY);
+	bool          SearchOptimalPathTo(const UINT wX, const UINT wY,
+			const CCoordSet &dests, const bool bAdjIsGood, const bool bPathThroughObstacles,
+			SEARCHREGION& region);
+	bool          SearchOptimalPath2(const UINT wStartX, const UINT wStartY,
+			const UINT wGoalX, const UINT wGoalY, const bool bPathThroughObstacles,
+			SEARCHREGION& region);
+
+	//Results of recent path searches.  A search made again while the tiles,
+	//monsters and player in and around the region it expanded are unchanged
+	//reuses its result instead of searching the room again.
+	struct PATHSEARCH
+	{
+		PATHSEARCH() : searchKey(0), region(0, 0), regionHash(0), bFound(false) { }
+		ULONGLONG searchKey;    //start, destination and kind of search (0 if unused)
+		SEARCHREGION region;    //squares expanded by the search
+		ULONGLONG regionHash;   //what was in and around them when searched
+		bool bFound;
+		ROOMCOORD goal;
+		CCoordStack path;
+	};
+	static const UINT PATH_SEARCHES_CACHED = 2;
+	PATHSEARCH pathSearches[PATH_SEARCHES_CACHED];
+	UINT wNextPathSearch;   //entry to be replaced next
 };
 
 #endif //...#ifndef MONSTER_H
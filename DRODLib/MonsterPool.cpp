@@ -0,0 +1,164 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//MonsterPool.cpp
+//Implementation of CMonsterPool.
+
+#include "MonsterPool.h"
+#include <BackEndLib/Assert.h>
+
+#include <SDL_atomic.h>
+
+#include <new>
+
+//Block sizes are multiples of this, which keeps every block aligned.
+static const size_t BLOCK_ALIGNMENT = 16;
+
+//Larger objects are allocated normally.
+static const size_t MAX_POOLED_SIZE = 4096;
+static const UINT NUM_SIZE_CLASSES = MAX_POOLED_SIZE / BLOCK_ALIGNMENT;
+
+//Bytes to carve into blocks at a time when a free list runs out.
+static const size_t CHUNK_SIZE = 16384;
+
+struct FREEBLOCK
+{
+	FREEBLOCK *pNext;
+};
+
+//Free blocks for each size of object.  Guarded by poolLock.
+//A spin lock needs no creating or freeing, so the pool may be used before
+//SDL is started and while static objects are being destroyed.
+static FREEBLOCK *freeLists[NUM_SIZE_CLASSES];
+static UINT wFreeCounts[NUM_SIZE_CLASSES];
+static SDL_SpinLock poolLock = 0;
+
+//*****************************************************************************
+static inline UINT GetSizeClass(const size_t size)
+{
+	return UINT((size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT) - 1;
+}
+
+//*****************************************************************************
+static bool AddChunk(
+//Carves one chunk into blocks and puts them on a free list.
+//Call with the pool locked.
+//
+//Params:
+	const UINT wSizeClass, //(in) size of blocks
+	const UINT wCount)     //(in) number of blocks
+//
+//Returns:
+//False if memory couldn't be allocated.
+{
+	const size_t blockSize = (wSizeClass + 1) * BLOCK_ALIGNMENT;
+	char *pChunk = static_cast<char*>(::operator new(blockSize * wCount, std::nothrow));
+	if (!pChunk)
+		return false;
+
+	//Blocks are linked in address order, so objects allocated one after
+	//another are next to each other.
+	FREEBLOCK *pNext = freeLists[wSizeClass];
+	for (UINT wIndex = wCount; wIndex--; )
+	{
+		FREEBLOCK *pBlock = reinterpret_cast<FREEBLOCK*>(pChunk + wIndex * blockSize);
+		pBlock->pNext = pNext;
+		pNext = pBlock;
+	}
+	freeLists[wSizeClass] = pNext;
+	wFreeCounts[wSizeClass] += wCount;
+	return true;
+}
+
+//*****************************************************************************
+void* CMonsterPool::Allocate(const size_t size)
+//Returns: a block at least size bytes long
+{
+	if (size > MAX_POOLED_SIZE)
+		return ::operator new(size);
+
+	const UINT wSizeClass = GetSizeClass(size);
+	SDL_AtomicLock(&poolLock);
+	if (!freeLists[wSizeClass])
+	{
+		const size_t blockSize = (wSizeClass + 1) * BLOCK_ALIGNMENT;
+		const UINT wCount = blockSize < CHUNK_SIZE ? UINT(CHUNK_SIZE / blockSize) : 1;
+		if (!AddChunk(wSizeClass, wCount))
+		{
+			SDL_AtomicUnlock(&poolLock);
+			throw std::bad_alloc();
+		}
+	}
+	FREEBLOCK *pBlock = freeLists[wSizeClass];
+	freeLists[wSizeClass] = pBlock->pNext;
+	--wFreeCounts[wSizeClass];
+	SDL_AtomicUnlock(&poolLock);
+	return pBlock;
+}
+
+//*****************************************************************************
+void CMonsterPool::Free(
+//Returns a block from Allocate() to the pool.
+//
+//Params:
+	void *p,           //(in) block, or NULL
+	const size_t size) //(in) size it was allocated with
+{
+	if (!p)
+		return;
+	if (size > MAX_POOLED_SIZE)
+	{
+		::operator delete(p);
+		return;
+	}
+
+	const UINT wSizeClass = GetSizeClass(size);
+	FREEBLOCK *pBlock = static_cast<FREEBLOCK*>(p);
+	SDL_AtomicLock(&poolLock);
+	pBlock->pNext = freeLists[wSizeClass];
+	freeLists[wSizeClass] = pBlock;
+	++wFreeCounts[wSizeClass];
+	SDL_AtomicUnlock(&poolLock);
+}
+
+//*****************************************************************************
+void CMonsterPool::Reserve(
+//Makes sure enough blocks are free for a number of objects of one size.
+//Any more that are needed are carved from a single chunk.
+//
+//Params:
+	const size_t size,  //(in) object size
+	const UINT wCount)  //(in) number of objects about to be allocated
+{
+	if (size > MAX_POOLED_SIZE || !wCount)
+		return;
+
+	const UINT wSizeClass = GetSizeClass(size);
+	SDL_AtomicLock(&poolLock);
+	if (wFreeCounts[wSizeClass] < wCount)
+		AddChunk(wSizeClass, wCount - wFreeCounts[wSizeClass]); //Allocate() copes with failure
+	SDL_AtomicUnlock(&poolLock);
+}
@@ -0,0 +1,51 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//MonsterPool.h
+//Declarations for CMonsterPool.
+//
+//Monsters and monster pieces are allocated from the pool by CMonster's
+//operator new.  Blocks are kept on a free list for each size of object, so
+//each monster type reuses the memory of its own deleted instances, and new
+//blocks are carved out of large chunks.  Memory is never returned to the
+//system, only reused.  The pool may be used from several threads.
+
+#ifndef MONSTERPOOL_H
+#define MONSTERPOOL_H
+
+#include <BackEndLib/Types.h>
+
+#include <cstddef>
+
+class CMonsterPool
+{
+public:
+	static void* Allocate(const size_t size);
+	static void  Free(void *p, const size_t size);
+	static void  Reserve(const size_t size, const UINT wCount);
+};
+
+#endif //...#ifndef MONSTERPOOL_H
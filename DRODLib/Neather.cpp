@@ -28,12 +28,21 @@
 #include "Neather.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 #include "../Texts/MIDs.h"
 
 //
 //Public methods.
 //
 
+//*****************************************************************************************
+ULONGLONG CNeather::GetStateHash() const
+//Returns: a hash of the 'Neather's game state, including his scripted state
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->m_CurrentState, 0, 0x07000000 | (this->bStrikingOrb ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CNeather::Process(
 //Process a neather for movement.
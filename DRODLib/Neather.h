@@ -164,6 +164,7 @@ public:
 		, bStrikingOrb(false), bLaughWhenOrbHit(false) { }
 	IMPLEMENT_CLONE_REPLICATE(CMonster, CNeather);
 
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsAggressive() const {return false;}
 	virtual bool OnAnswer(int nCommand, CCueEvents &CueEvents);
 	virtual bool OnStabbed(CCueEvents &CueEvents, const UINT wX=-1, const UINT wY=-1,
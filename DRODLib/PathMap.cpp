@@ -30,6 +30,7 @@
 #include <BackEndLib/Coord.h>
 #include <BackEndLib/Ports.h>
 
+#include <functional>   //std::greater
 #include <utility>      //std::swap
 
 #ifdef _DEBUG
@@ -44,6 +45,13 @@
 
 const UINT dwBigVal = UINT(-1); //this value indicates a tile is not part of the valid pathmap
 
+//Offsets to the adjacent squares, and the direction from each back to the center square.
+static const UINT wNumNeighbors = 8;
+static const int dxDir[wNumNeighbors] = {-1,  0,  1, -1,  1, -1,  0,  1};
+static const int dyDir[wNumNeighbors] = {-1, -1, -1,  0,  0,  1,  1,  1};
+//static const UINT dirmask[] = {DMASK_NW, DMASK_N, DMASK_NE, DMASK_W, DMASK_E, DMASK_SW, DMASK_S, DMASK_SE};
+static const UINT rdirmask[] = {DMASK_SE, DMASK_S, DMASK_SW, DMASK_E, DMASK_W, DMASK_NE, DMASK_N, DMASK_NW};
+
 //**********************************************************************************
 CPathMap::CPathMap(
 //Constructor.  Sets object vars to default values and allocates and initializes the map squares and immediate
@@ -60,6 +68,7 @@ CPathMap::CPathMap(
 	, xTarget(xTarget), yTarget(yTarget)
 	, dwPathThroughObstacleCost(dwPathThroughObstacleCost)
 	, bSupportPartialObstacles(bSupportPartialObstacles)
+	, bEntrancesValid(true)
 {
 	//Allocate map.  Initialize map squares.
 	const UINT wArea=wCols*wRows;
@@ -80,7 +89,14 @@ void CPathMap::CalcPaths()
 //squares, this work is continued.
 {
 	if (this->recalcSquares.empty())
+	{
+		if (!this->changedSquares.empty())
+			RepairPaths();
 		return;
+	}
+
+	this->changedSquares.clear();
+	this->bEntrancesValid = true;
 
 	int dx, dy, wNewX, wNewY;
 
@@ -93,12 +109,6 @@ void CPathMap::CalcPaths()
 		this->recalcSquares.pop();
 
 		//Check every adjacent square for recalc eligibility.
-		static const UINT wNumNeighbors = 8;
-		static const int dxDir[wNumNeighbors] = {-1,  0,  1, -1,  1, -1,  0,  1};
-		static const int dyDir[wNumNeighbors] = {-1, -1, -1,  0,  0,  1,  1,  1};
-		//static const UINT dirmask[] = {DMASK_NW, DMASK_N, DMASK_NE, DMASK_W, DMASK_E, DMASK_SW, DMASK_S, DMASK_SE};
-		static const UINT rdirmask[] = {DMASK_SE, DMASK_S, DMASK_SW, DMASK_E, DMASK_W, DMASK_NE, DMASK_N, DMASK_NW};
-
 		const SQUARE& parent_square = this->squares[GetSquareIndex(coord.wX, coord.wY)];
 
 		for (UINT nIndex=0; nIndex<wNumNeighbors; ++nIndex)
@@ -111,10 +121,7 @@ void CPathMap::CalcPaths()
 
 			SQUARE& square = this->squares[GetSquareIndex(wNewX,wNewY)];
 
-			//Direction of movement out of parent tile matters only when directional obstacles are being considered.
-			const bool bIsObstacle = ((
-				(this->bSupportPartialObstacles ? parent_square.eBlockedDirections : 0) |
-						square.eBlockedDirections) & rdirmask[nIndex]) != 0;
+			const bool bIsObstacle = !IsStepOpen(parent_square, square, nIndex);
 
 			//If this square is considered a valid candidate...
 			if (!bIsObstacle || this->dwPathThroughObstacleCost)
@@ -170,6 +177,10 @@ void CPathMap::GetEntrances(
 //Get a list of entrances, sorted by distance to target
 	SORTPOINTS& sortPoints)
 {
+	//Repairs don't keep entrances in the order a full calculation finds them in.
+	if (!this->bEntrancesValid || !this->changedSquares.empty())
+		Reset();
+
 	//Ensure path map is current.
 	CalcPaths();
 	sortPoints.clear();
@@ -264,6 +275,9 @@ void CPathMap::Reset()
 	while (!this->entrySquares.empty())
 		this->entrySquares.pop();
 
+	this->changedSquares.clear();
+	this->bEntrancesValid = true;
+
 	//Wasteful to recalc pathmap if no valid target is specified.
 	if (this->xTarget >= this->wCols || this->yTarget >= this->wRows)
 		return;
@@ -289,6 +303,9 @@ void CPathMap::SetMembers(const CPathMap& Src)
 	this->bSupportPartialObstacles = Src.bSupportPartialObstacles;
 
 	this->dwPathThroughObstacleCost = Src.dwPathThroughObstacleCost;
+
+	this->changedSquares = Src.changedSquares;
+	this->bEntrancesValid = Src.bEntrancesValid;
 }
 
 //*****************************************************************************
@@ -308,10 +325,23 @@ void CPathMap::SetSquare(
 	//if (!this->bSupportPartialObstacles && eBlockedDirections != DMASK_NONE)
 	//	eBlockedDirections = DMASK_ALL;
 
-	if (square.eBlockedDirections != eBlockedDirections)
-		Reset();
+	if (square.eBlockedDirections == eBlockedDirections)
+		return;
 
 	square.eBlockedDirections = eBlockedDirections;
+
+	//Nothing to repair if paths are going to be recalculated from scratch,
+	//or if there is no target to have paths to.
+	if (!this->recalcSquares.empty() ||
+			this->xTarget >= this->wCols || this->yTarget >= this->wRows)
+		return;
+
+	//When many squares change at once, it's quicker to start over.
+	if (this->dwPathThroughObstacleCost ||
+			this->changedSquares.size() >= this->squares.size() / 8)
+		Reset();
+	else
+		this->changedSquares.push_back(GetSquareIndex(wX,wY));
 }
 
 //**********************************************************************************
@@ -335,6 +365,159 @@ void CPathMap::SetTarget(
 //*****************************************************************************
 inline UINT CPathMap::GetSquareIndex(const UINT x, const UINT y) const {return y*this->wCols+x;}
 
+//*****************************************************************************
+bool CPathMap::IsStepOpen(
+//Returns: whether the path may take a step from one square into an adjacent one
+//without going through an obstacle.
+//
+//Params:
+	const SQUARE& from, const SQUARE& to, //(in) squares stepped between
+	const UINT nIndex)                    //(in) index of 'to' in the neighbor arrays, relative to 'from'
+const
+{
+	//Direction of movement out of parent tile matters only when directional obstacles are being considered.
+	return (((this->bSupportPartialObstacles ? from.eBlockedDirections : 0) |
+			to.eBlockedDirections) & rdirmask[nIndex]) == 0;
+}
+
+//*****************************************************************************
+void CPathMap::RepairPaths()
+//Updates the distances to the target after the squares in changedSquares have
+//changed, recalculating only those squares whose distances may have changed.
+//Only called when every step costs the same, so the distances are the shortest
+//number of steps to the target, and are the same as a full recalculation gives.
+{
+	ASSERT(!this->dwPathThroughObstacleCost);
+	ASSERT(this->recalcSquares.empty());
+
+	const UINT wArea = this->squares.size();
+	const UINT wTargetI = GetSquareIndex(this->xTarget, this->yTarget);
+	typedef std::pair<UINT, UINT> DISTSQUARE; //distance, square index
+	std::priority_queue<DISTSQUARE, std::vector<DISTSQUARE>, std::greater<DISTSQUARE> > queue;
+	int nI;
+	UINT nIndex, wSquareI;
+
+	//Steps into a changed square, and out of it into its neighbors, may have
+	//opened or closed.
+	std::vector<UINT> candidates;
+	for (std::vector<UINT>::const_iterator changed = this->changedSquares.begin();
+			changed != this->changedSquares.end(); ++changed)
+	{
+		const int wX = *changed % this->wCols, wY = *changed / this->wCols;
+		for (nI = -1; nI < (int)wNumNeighbors; ++nI)
+		{
+			const UINT wNX = wX + (nI < 0 ? 0 : dxDir[nI]);
+			const UINT wNY = wY + (nI < 0 ? 0 : dyDir[nI]);
+			if (wNX < this->wCols && wNY < this->wRows)
+				candidates.push_back(GetSquareIndex(wNX, wNY));
+		}
+	}
+	this->changedSquares.clear();
+	this->bEntrancesValid = false;
+
+	//1. Find the squares that lost their shortest path.  In order of distance,
+	//a square has lost it when no square one step closer to the target is
+	//still on a shortest path and can step into it.  Squares one step further
+	//that it could step into are then checked in turn.
+	std::vector<bool> lost(wArea, false);
+	std::vector<UINT> lostSquares;
+	for (std::vector<UINT>::const_iterator candidate = candidates.begin();
+			candidate != candidates.end(); ++candidate)
+		if (*candidate != wTargetI && this->squares[*candidate].dwTargetDist != dwBigVal)
+			queue.push(DISTSQUARE(this->squares[*candidate].dwTargetDist, *candidate));
+
+	while (!queue.empty())
+	{
+		const DISTSQUARE top = queue.top();
+		queue.pop();
+		wSquareI = top.second;
+		if (lost[wSquareI])
+			continue;
+
+		const UINT wX = wSquareI % this->wCols, wY = wSquareI / this->wCols;
+		const SQUARE& square = this->squares[wSquareI];
+		bool bSupported = false;
+		for (nIndex = 0; nIndex < wNumNeighbors && !bSupported; ++nIndex)
+		{
+			//Square this one would be stepped into from.
+			const UINT wPX = wX - dxDir[nIndex], wPY = wY - dyDir[nIndex];
+			if (wPX >= this->wCols || wPY >= this->wRows)
+				continue;
+			const UINT wParentI = GetSquareIndex(wPX, wPY);
+			const SQUARE& parent = this->squares[wParentI];
+			if (!lost[wParentI] && parent.dwTargetDist + 1 == square.dwTargetDist &&
+					IsStepOpen(parent, square, nIndex))
+				bSupported = true;
+		}
+		if (bSupported)
+			continue;
+
+		lost[wSquareI] = true;
+		lostSquares.push_back(wSquareI);
+		for (nIndex = 0; nIndex < wNumNeighbors; ++nIndex)
+		{
+			const UINT wNX = wX + dxDir[nIndex], wNY = wY + dyDir[nIndex];
+			if (wNX >= this->wCols || wNY >= this->wRows)
+				continue;
+			const UINT wChildI = GetSquareIndex(wNX, wNY);
+			if (!lost[wChildI] && this->squares[wChildI].dwTargetDist == square.dwTargetDist + 1)
+				queue.push(DISTSQUARE(square.dwTargetDist + 1, wChildI));
+		}
+	}
+
+	//2. Squares that lost their path get the best distance from their
+	//neighbors that didn't, and squares that a newly opened step makes closer
+	//get their new distance.
+	std::vector<UINT>::const_iterator iter;
+	for (iter = lostSquares.begin(); iter != lostSquares.end(); ++iter)
+		this->squares[*iter].dwTargetDist = this->squares[*iter].dwSteps = dwBigVal;
+	candidates.insert(candidates.end(), lostSquares.begin(), lostSquares.end());
+	for (iter = candidates.begin(); iter != candidates.end(); ++iter)
+	{
+		SQUARE& square = this->squares[*iter];
+		const UINT wX = *iter % this->wCols, wY = *iter / this->wCols;
+		for (nIndex = 0; nIndex < wNumNeighbors; ++nIndex)
+		{
+			const UINT wPX = wX - dxDir[nIndex], wPY = wY - dyDir[nIndex];
+			if (wPX >= this->wCols || wPY >= this->wRows)
+				continue;
+			const SQUARE& parent = this->squares[GetSquareIndex(wPX, wPY)];
+			if (parent.dwTargetDist != dwBigVal && parent.dwTargetDist + 1 < square.dwTargetDist &&
+					IsStepOpen(parent, square, nIndex))
+			{
+				square.dwTargetDist = square.dwSteps = parent.dwTargetDist + 1;
+				queue.push(DISTSQUARE(square.dwTargetDist, *iter));
+			}
+		}
+	}
+
+	//3. Spread the new distances outward, as in a full calculation.
+	while (!queue.empty())
+	{
+		const DISTSQUARE top = queue.top();
+		queue.pop();
+		wSquareI = top.second;
+		const SQUARE& square = this->squares[wSquareI];
+		if (top.first != square.dwTargetDist)
+			continue; //a shorter distance was found after this was queued
+
+		const UINT wX = wSquareI % this->wCols, wY = wSquareI / this->wCols;
+		for (nIndex = 0; nIndex < wNumNeighbors; ++nIndex)
+		{
+			const UINT wNX = wX + dxDir[nIndex], wNY = wY + dyDir[nIndex];
+			if (wNX >= this->wCols || wNY >= this->wRows)
+				continue;
+			const UINT wChildI = GetSquareIndex(wNX, wNY);
+			SQUARE& child = this->squares[wChildI];
+			if (square.dwTargetDist + 1 < child.dwTargetDist && IsStepOpen(square, child, nIndex))
+			{
+				child.dwTargetDist = child.dwSteps = square.dwTargetDist + 1;
+				queue.push(DISTSQUARE(child.dwTargetDist, wChildI));
+			}
+		}
+	}
+}
+
 //*****************************************************************************
 void CPathMap::StableSortPoints(
 //Stable (bubble) sort for SORTPOINT structs.  Just as fast as a quick sort
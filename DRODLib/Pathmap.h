@@ -121,6 +121,8 @@ public:
 
 private:
 	inline UINT       GetSquareIndex(const UINT x, const UINT y) const;
+	bool              IsStepOpen(const SQUARE& from, const SQUARE& to, const UINT nIndex) const;
+	void              RepairPaths();
 	static void       StableSortPoints(SORTPOINTS& sortPoints);
 
 	UINT xTarget, yTarget;
@@ -136,6 +138,13 @@ private:
 	//Support force arrows, orthosquares, etc. If false (default), these are
 	//treated as full obstacles.
 	bool bSupportPartialObstacles;
+
+	//When paths aren't allowed through obstacles, every step costs the same,
+	//so the distances to the target don't depend on the order squares are
+	//searched in, and can be repaired around squares that have changed instead
+	//of being recalculated for the whole room.
+	std::vector<UINT> changedSquares; //indices of squares changed since paths were calculated
+	bool bEntrancesValid;             //entrySquares weren't affected by repairs
 };
 
 #endif //...#ifndef PATHMAP_H
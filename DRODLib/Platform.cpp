@@ -31,8 +31,14 @@
 #include "TileConstants.h"
 #include "MonsterFactory.h"
 #include "RockGolem.h"
+#include "SimulationContext.h"
 
-CCoordSet CPlatform::fallTiles;
+//*****************************************************************************
+static inline CCoordSet& FallTiles(const CDbRoom& room)
+//Returns: tiles platforms moved off of since last falling check
+{
+	return GetSimulationContext(room.GetCurrentGame()).fallTiles;
+}
 
 //*****************************************************************************
 CPlatform::CPlatform(
@@ -130,18 +136,19 @@ bool CPlatform::CanMove(const UINT wO)
 void CPlatform::checkForFalling(CDbRoom *pRoom, CCueEvents& CueEvents)
 //Check for falling objects.
 {
-	if (CPlatform::fallTiles.empty())
+	CCoordSet& fallTiles = FallTiles(*pRoom);
+	if (fallTiles.empty())
 		return;
 
 	//There shouldn't be any tiles to process if there are no platforms in the room.
 	ASSERT(!pRoom->platforms.empty());
 
-	for (CCoordSet::const_iterator tile=CPlatform::fallTiles.begin();
-			tile!=CPlatform::fallTiles.end(); ++tile)
+	for (CCoordSet::const_iterator tile=fallTiles.begin();
+			tile!=fallTiles.end(); ++tile)
 		pRoom->CheckForFallingAt(tile->wX, tile->wY, CueEvents);
 	pRoom->ConvertUnstableTar(CueEvents);
 	
-	CPlatform::fallTiles.clear();
+	fallTiles.clear();
 }
 
 //*****************************************************************************
@@ -192,6 +199,7 @@ void CPlatform::Move(CDbRoom& room, const int nOX, const int nOY, const bool bPl
 {
 	//Move all pieces in direction of movement.
 	//1. Remove all blocks from current position.
+	CCoordSet& fallTiles = FallTiles(room);
 	UINT wBlockX, wBlockY;
 	UINT wIndex;
 	for (wIndex=this->blocks.GetSize(); wIndex--; )
@@ -199,7 +207,7 @@ void CPlatform::Move(CDbRoom& room, const int nOX, const int nOY, const bool bPl
 		this->blocks.GetAt(wIndex, wBlockX, wBlockY);
 		if (bPlotToRoom)
 			room.Plot(wBlockX, wBlockY, room.coveredOSquares.GetAt(wBlockX, wBlockY));
-		CPlatform::fallTiles.insert(wBlockX, wBlockY);
+		fallTiles.insert(wBlockX, wBlockY);
  	}
 
 	//2. Place blocks in new position.
@@ -213,7 +221,7 @@ void CPlatform::Move(CDbRoom& room, const int nOX, const int nOY, const bool bPl
 		this->blocks.SetAt(wIndex, wBlockX, wBlockY);
 		if (bPlotToRoom)
 			room.Plot(wBlockX, wBlockY, wTile);
-		CPlatform::fallTiles.erase(wBlockX, wBlockY);
+		fallTiles.erase(wBlockX, wBlockY);
 	}
 }
 
@@ -310,7 +318,7 @@ bool CPlatform::CanMoveTo(CDbRoom* pRoom, const UINT wX, const UINT wY) const
 
 	//Water monsters will block platforms.
 	CMonster *pMonster = pRoom->GetMonsterAtSquare(wX, wY);
-	if (pMonster && pMonster->IsSwimming() && !CPlatform::fallTiles.has(wX, wY))
+	if (pMonster && pMonster->IsSwimming() && !FallTiles(*pRoom).has(wX, wY))
 		return false;
 
 	return true;
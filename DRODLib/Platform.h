@@ -41,8 +41,6 @@ public:
 	void SetCurrentGame(CCurrentGame *pSetCurrentGame);
 
 	static void checkForFalling(CDbRoom *pRoom, CCueEvents& CueEvents);
-	static void clearFallTiles() {CPlatform::fallTiles.clear();}
-	static bool fallTilesPending() {return !CPlatform::fallTiles.empty();}
 
 	bool CanMove(const UINT wO);
 	void GetTiles(CCoordSet& tiles) const;
@@ -68,8 +66,6 @@ private:
 	CCoordStack blocks;  //tile coords that compose the platform
 	vector<UINT> edgeBlocks[DIR_COUNT];   //indices of leading edge blocks
 	CIDSet types; //located on what tile type(s)
-
-	static CCoordSet fallTiles; //tiles platforms moved off of since last falling check
 };
 
 #endif //...#ifndef PLATFORM_H
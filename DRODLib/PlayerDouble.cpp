@@ -28,6 +28,7 @@
 
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //
 //Public methods.
@@ -154,6 +155,16 @@ bool CArmedMonster::DoesSquareRemoveWeapon(const UINT wCol, const UINT wRow) con
 	return false;
 }
 
+//*****************************************************************************
+ULONGLONG CArmedMonster::GetStateHash() const
+//Returns: a hash of this monster's game state, including its weapon
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->weaponType, this->wSwordMovement,
+			0x01000000 | (this->bWeaponSheathed ? 1 : 0) | (this->bNoWeapon ? 2 : 0) |
+			(this->bFrozen ? 4 : 0));
+}
+
 //*****************************************************************************
 bool CArmedMonster::HasSword() const
 //Returns: true when double has unsheathed sword
@@ -46,6 +46,7 @@ public:
 	virtual bool   CheckForDamage(CCueEvents& CueEvents);
 	bool           DoesSquareRemoveWeapon(const UINT wCol, const UINT wRow) const;
 	virtual bool   DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual WeaponType GetWeaponType() const { return this->weaponType; }
 	virtual bool   HasSword() const;
 	virtual bool   IsAggressive() const {return false;}
@@ -50,6 +50,8 @@ WSTRING ScriptVars::getVarNameW(const Predefined var)
 void ScriptVars::init()
 //Init 'midTexts' on first call.
 //Much faster than repeated multiple DB queries.
+//Main thread only.  Games played on worker threads have this called first
+//by CGameDataSnapshot, so they only read the texts.
 {
 	UINT index=0;
 	if (midTexts[0].empty())
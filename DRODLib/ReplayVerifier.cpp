@@ -0,0 +1,373 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+#include "ReplayVerifier.h"
+#include "CurrentGame.h"
+#include "Db.h"
+#include "DbDemos.h"
+#include <BackEndLib/Assert.h>
+
+#include <SDL.h>
+
+//How many loaded games each worker thread gets per chunk.
+//Games are loaded a chunk at a time to bound memory use.
+const UINT JOBS_PER_THREAD = 4;
+
+//*****************************************************************************
+REPLAYJOB::~REPLAYJOB()
+{
+	delete this->pDemo;
+	delete this->pGame;
+	delete this->pCueEvents;
+}
+
+//*****************************************************************************
+CReplayVerifier::CReplayVerifier(
+//Constructor.
+//
+//Params:
+	CDb &db,              //(in) DB records are loaded through
+	const UINT wThreads)  //(in) number of worker threads, or 0 for the default [default=0]
+	: db(db)
+	, wThreads(wThreads ? wThreads : GetDefaultThreadCount())
+	, pMutex(NULL)
+	, wNextJob(0), wChunkEnd(0), wJobsDone(0)
+{
+}
+
+//*****************************************************************************
+CReplayVerifier::~CReplayVerifier()
+{
+	Clear();
+}
+
+//*****************************************************************************
+void CReplayVerifier::AddDemo(const UINT dwDemoID)
+//Queue a demo to be verified.
+{
+	ASSERT(dwDemoID);
+	this->jobs.push_back(new REPLAYJOB(dwDemoID, true));
+}
+
+//*****************************************************************************
+void CReplayVerifier::AddSavedGame(const UINT dwSavedGameID)
+//Queue a saved game to be verified.
+{
+	ASSERT(dwSavedGameID);
+	REPLAYJOB *pJob = new REPLAYJOB(dwSavedGameID, false);
+	pJob->dwPlayerID = this->db.SavedGames.GetPlayerIDofSavedGame(dwSavedGameID);
+	this->jobs.push_back(pJob);
+}
+
+//*****************************************************************************
+void CReplayVerifier::Clear()
+//Discard all jobs and their results.
+{
+	for (vector<REPLAYJOB*>::const_iterator job = this->jobs.begin();
+			job != this->jobs.end(); ++job)
+		delete *job;
+	this->jobs.clear();
+}
+
+//*****************************************************************************
+UINT CReplayVerifier::GetDefaultThreadCount()
+//Returns: how many worker threads to replay with when not specified.
+{
+	const int nCPUs = SDL_GetCPUCount();
+	return nCPUs > 1 ? UINT(nCPUs) : 1;
+}
+
+//*****************************************************************************
+void CReplayVerifier::Run(
+//Verify all queued jobs.
+//
+//Params:
+	void (*pfnProgress)(float), //(in) if set, called on this thread with the fraction
+	                            //of jobs completed [default=NULL]
+	const bool bReplay)         //(in) if false, only check that each game can be loaded
+	                            //to its initial state [default=true]
+{
+	if (!bReplay)
+	{
+		const float fNumJobs = (float)this->jobs.size();
+		for (UINT wJob = 0; wJob < this->jobs.size(); ++wJob)
+		{
+			REPLAYJOB &job = *this->jobs[wJob];
+			if (LoadJob(job))
+			{
+				job.eResult = RR_Passed;
+				delete job.pGame;
+				job.pGame = NULL;
+				delete job.pCueEvents;
+				job.pCueEvents = NULL;
+			}
+			if (pfnProgress)
+				pfnProgress((wJob + 1) / fNumJobs);
+		}
+		return;
+	}
+
+	const UINT wChunkSize = this->wThreads * JOBS_PER_THREAD;
+	const UINT wCount = this->jobs.size();
+	this->wJobsDone = 0;
+
+	UINT wStart = 0;
+	while (wStart < wCount)
+	{
+		//Saved games are loaded with their player active, so keep each chunk
+		//to a single player.
+		UINT wEnd = wStart + 1;
+		while (wEnd < wCount && wEnd - wStart < wChunkSize &&
+				this->jobs[wEnd]->dwPlayerID == this->jobs[wStart]->dwPlayerID)
+			++wEnd;
+
+		RunChunk(wStart, wEnd, pfnProgress);
+		wStart = wEnd;
+	}
+}
+
+//
+//Private methods.
+//
+
+//*****************************************************************************
+bool CReplayVerifier::LoadJob(REPLAYJOB &job)
+//Load the game to replay for this job.  Only called from the main thread.
+//
+//Returns: whether the job has a game to be replayed
+{
+	ASSERT(job.eResult == RR_Pending);
+	ASSERT(!job.pGame);
+	job.pCueEvents = new CCueEvents;
+
+	if (job.bDemo)
+	{
+		job.pDemo = this->db.Demos.GetByID(job.dwID);
+		ASSERT(job.pDemo);
+		if (job.pDemo)
+			job.pGame = job.pDemo->LoadTestGame(*job.pCueEvents);
+	} else {
+		if (!this->db.SavedGames.GetRoomIDofSavedGame(job.dwID))
+		{
+			job.eResult = RR_Skipped;
+			return false;
+		}
+
+		this->db.SetPlayerID(job.dwPlayerID, false);
+		job.pGame = this->db.GetSavedCurrentGame(job.dwID, *job.pCueEvents, true,
+				true); //don't save to DB while replaying commands
+		if (job.pGame)
+		{
+			job.pGame->SetAutoSaveOptions(ASO_NONE);
+			job.ConqueredRooms = job.pGame->ConqueredRooms;
+			job.ExploredRooms = job.pGame->ExploredRooms;
+		}
+	}
+
+	if (!job.pGame)
+	{
+		job.eResult = RR_LoadFailed;
+		return false;
+	}
+	return true;
+}
+
+//*****************************************************************************
+void CReplayVerifier::ReplayJob(REPLAYJOB &job) const
+//Replay a loaded game's commands.  Doesn't access the DB.
+{
+	ASSERT(job.pGame);
+	ASSERT(job.pCueEvents);
+
+	bool bPassed;
+	if (job.bDemo)
+		bPassed = job.pDemo->TestGame(job.pGame, *job.pCueEvents, job.DemoStats);
+	else
+		bPassed = job.pGame->PlayAllCommands(*job.pCueEvents, true);
+	job.eResult = bPassed ? RR_Passed : RR_Failed;
+
+	//Retain the game only when the caller will need to update it.
+	if (job.bDemo || bPassed)
+	{
+		delete job.pGame;
+		job.pGame = NULL;
+	}
+	delete job.pCueEvents;
+	job.pCueEvents = NULL;
+}
+
+//*****************************************************************************
+void CReplayVerifier::ReplayPendingJobs()
+//Replay jobs in the current chunk until none are left.
+{
+	for (;;)
+	{
+		SDL_LockMutex(this->pMutex);
+		REPLAYJOB *pJob = NULL;
+		while (this->wNextJob < this->wChunkEnd && !pJob)
+		{
+			pJob = this->jobs[this->wNextJob++];
+			if (pJob->eResult != RR_Pending)
+			{
+				//Nothing to replay.
+				++this->wJobsDone;
+				pJob = NULL;
+			}
+		}
+		SDL_UnlockMutex(this->pMutex);
+		if (!pJob)
+			return;
+
+		ReplayJob(*pJob);
+
+		SDL_LockMutex(this->pMutex);
+		++this->wJobsDone;
+		SDL_UnlockMutex(this->pMutex);
+	}
+}
+
+//*****************************************************************************
+int CReplayVerifier::ReplayWorker(void *pData)
+//Worker thread procedure.
+{
+	CReplayVerifier *pThis = static_cast<CReplayVerifier*>(pData);
+	pThis->ReplayPendingJobs();
+	return 0;
+}
+
+//*****************************************************************************
+void CReplayVerifier::RunChunk(
+//Load and replay the jobs in [wStart,wEnd).
+//
+//Params:
+	const UINT wStart, const UINT wEnd, //(in) job range
+	void (*pfnProgress)(float))         //(in) progress callback, or NULL
+{
+	ASSERT(wStart < wEnd);
+	const float fNumJobs = (float)this->jobs.size();
+	UINT wJob;
+
+	if (this->wThreads <= 1)
+	{
+		//Replay on this thread.
+		for (wJob = wStart; wJob < wEnd; ++wJob)
+		{
+			REPLAYJOB &job = *this->jobs[wJob];
+			if (LoadJob(job))
+				ReplayJob(job);
+			++this->wJobsDone;
+			if (pfnProgress)
+				pfnProgress(this->wJobsDone / fNumJobs);
+		}
+		return;
+	}
+
+	//All DB reads for the chunk are done up front, before any workers start.
+	//Games being replayed together read hold data from the snapshot only.
+	//It is rebuilt for each chunk, as chunks may be played by different players.
+	this->snapshot.Clear();
+	for (wJob = wStart; wJob < wEnd; ++wJob)
+	{
+		REPLAYJOB &job = *this->jobs[wJob];
+		if (LoadJob(job))
+		{
+			this->snapshot.AddGame(*job.pGame);
+			job.pGame->GetSimulationContext().SetDataSource(&this->snapshot);
+		}
+	}
+
+	this->pMutex = SDL_CreateMutex();
+	if (!this->pMutex)
+	{
+		//Can't coordinate threads -- replay on this thread instead.
+		for (wJob = wStart; wJob < wEnd; ++wJob)
+		{
+			REPLAYJOB &job = *this->jobs[wJob];
+			if (job.eResult == RR_Pending)
+				ReplayJob(job);
+			++this->wJobsDone;
+		}
+		if (pfnProgress)
+			pfnProgress(this->wJobsDone / fNumJobs);
+		ReleaseSnapshot(wStart, wEnd);
+		return;
+	}
+
+	this->wNextJob = wStart;
+	this->wChunkEnd = wEnd;
+	const UINT wChunkDone = this->wJobsDone + (wEnd - wStart);
+
+	const UINT wWorkers = wEnd - wStart < this->wThreads ? wEnd - wStart : this->wThreads;
+	vector<SDL_Thread*> workers;
+	for (UINT wI = 0; wI < wWorkers; ++wI)
+	{
+		SDL_Thread *pThread = SDL_CreateThread(ReplayWorker, "replay", this);
+		if (pThread)
+			workers.push_back(pThread);
+	}
+
+	if (workers.empty())
+	{
+		ReplayPendingJobs(); //couldn't create threads
+	} else {
+		//Report progress while the workers run.
+		UINT wDone;
+		do {
+			SDL_Delay(10);
+			SDL_LockMutex(this->pMutex);
+			wDone = this->wJobsDone;
+			SDL_UnlockMutex(this->pMutex);
+			if (pfnProgress)
+				pfnProgress(wDone / fNumJobs);
+		} while (wDone < wChunkDone);
+
+		for (vector<SDL_Thread*>::const_iterator thread = workers.begin();
+				thread != workers.end(); ++thread)
+			SDL_WaitThread(*thread, NULL);
+	}
+	ASSERT(this->wJobsDone == wChunkDone);
+
+	SDL_DestroyMutex(this->pMutex);
+	this->pMutex = NULL;
+	ReleaseSnapshot(wStart, wEnd);
+}
+
+//*****************************************************************************
+void CReplayVerifier::ReleaseSnapshot(
+//Frees the snapshot used to replay the jobs in [wStart,wEnd).  Games retained
+//for the caller read from the DB again.
+//
+//Params:
+	const UINT wStart, const UINT wEnd) //(in) job range
+{
+	for (UINT wJob = wStart; wJob < wEnd; ++wJob)
+	{
+		REPLAYJOB &job = *this->jobs[wJob];
+		if (job.pGame)
+			job.pGame->GetSimulationContext().SetDataSource(NULL);
+	}
+	this->snapshot.Clear();
+}
@@ -0,0 +1,121 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//ReplayVerifier.h
+//Declarations for CReplayVerifier.
+//Replays demos and saved games without UI interaction to verify they still
+//play back correctly, spreading the replays over a pool of worker threads.
+//
+//Records are loaded from the DB on the calling thread.  Worker threads only
+//replay commands against the loaded games, reading any further hold data they
+//need from a snapshot loaded along with them (see CGameDataSnapshot).  No DB writes are made here:
+//callers inspect the results afterwards and apply any deletions and updates
+//in one pass.
+
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+#include "CueEvents.h"
+#include "SimulationContext.h"
+#include <BackEndLib/IDList.h>
+#include <BackEndLib/IDSet.h>
+#include <BackEndLib/Types.h>
+
+#include <SDL_thread.h>
+
+#include <vector>
+using std::vector;
+
+class CCurrentGame;
+class CDb;
+class CDbDemo;
+
+enum REPLAYRESULT
+{
+	RR_Pending=0,  //not processed yet
+	RR_Passed,     //all commands replayed as expected (or game loaded, if not replaying)
+	RR_Failed,     //playback went wrong
+	RR_LoadFailed, //record couldn't be loaded to start playback
+	RR_Skipped     //record has nothing to verify
+};
+
+//One demo or saved game to verify.
+struct REPLAYJOB
+{
+	REPLAYJOB(const UINT dwID, const bool bDemo)
+		: dwID(dwID), bDemo(bDemo), dwPlayerID(0), eResult(RR_Pending)
+		, pDemo(NULL), pGame(NULL), pCueEvents(NULL)
+	{ }
+	~REPLAYJOB();
+
+	UINT dwID;           //demo or saved game ID
+	bool bDemo;          //whether dwID is a demo or a saved game
+	UINT dwPlayerID;     //player owning the saved game
+	REPLAYRESULT eResult;
+
+	CIDList DemoStats;   //demo playback statistics (demos only)
+	CIDSet ConqueredRooms, ExploredRooms; //room tallies when loaded (saved games only)
+
+	CDbDemo *pDemo;      //demo record (demos only)
+	CCurrentGame *pGame; //retained after playback only for saved games that failed,
+	                     //so the caller can Update() them with invalid commands truncated
+	CCueEvents *pCueEvents; //events generated when the game was loaded
+};
+
+//*****************************************************************************
+class CReplayVerifier
+{
+public:
+	CReplayVerifier(CDb &db, const UINT wThreads=0);
+	~CReplayVerifier();
+
+	void  AddDemo(const UINT dwDemoID);
+	void  AddSavedGame(const UINT dwSavedGameID);
+	void  Clear();
+	static UINT GetDefaultThreadCount();
+	UINT  GetJobCount() const {return this->jobs.size();}
+	REPLAYJOB& GetJob(const UINT wIndex) const {return *this->jobs[wIndex];}
+	void  Run(void (*pfnProgress)(float)=NULL, const bool bReplay=true);
+
+private:
+	bool  LoadJob(REPLAYJOB &job);
+	void  ReplayJob(REPLAYJOB &job) const;
+	void  ReleaseSnapshot(const UINT wStart, const UINT wEnd);
+	void  ReplayPendingJobs();
+	void  RunChunk(const UINT wStart, const UINT wEnd, void (*pfnProgress)(float));
+	static int ReplayWorker(void *pData);
+
+	CDb &db;
+	UINT wThreads;
+	vector<REPLAYJOB*> jobs;
+	CGameDataSnapshot snapshot; //hold data read by games during replay
+
+	//Shared with worker threads while a chunk is being replayed.
+	SDL_mutex *pMutex;
+	UINT wNextJob, wChunkEnd, wJobsDone;
+};
+
+#endif //...#ifndef REPLAYVERIFIER_H
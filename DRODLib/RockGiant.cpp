@@ -105,7 +105,7 @@ void CRockGiant::Shatter(
 	ASSERT(pGame);
 	CDbRoom& room = *(pGame->pRoom);
 
-	static CCoordIndex swordCoords;
+	CCoordIndex swordCoords;
 	room.GetSwordCoords(swordCoords, false, true); //resets var
 
 	if (pWeaponDamagePosition != NULL){
@@ -248,11 +248,11 @@ void CRockGiant::Process(
 
 	//Remove off old tiles.
 	CDbRoom& room = *(this->pCurrentGame->pRoom);
-	room.pMonsterSquares[room.ARRAYINDEX(this->wX,this->wY)] = NULL;
+	room.SetMonsterSquare(this->wX, this->wY, NULL);
 	for (piece = this->Pieces.begin(); piece != this->Pieces.end(); ++piece)
 	{
 		const CMonsterPiece& mpiece = *(*piece);
-		room.pMonsterSquares[room.ARRAYINDEX(mpiece.wX,mpiece.wY)] = NULL;
+		room.SetMonsterSquare(mpiece.wX, mpiece.wY, NULL);
 	}
 
 	//Move onto destination tiles.
@@ -273,12 +273,8 @@ void CRockGiant::ReflectX(CDbRoom *pRoom)
 	++(*(piece++))->wX;
 	--(*(piece++))->wX;
 	++(*piece)->wX;
-	std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX+1,this->wY)]);
-	std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY+1)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX+1,this->wY+1)]);
+	pRoom->SwapMonsterSquares(this->wX, this->wY, this->wX+1, this->wY);
+	pRoom->SwapMonsterSquares(this->wX, this->wY+1, this->wX+1, this->wY+1);
 }
 
 //*****************************************************************************************
@@ -293,12 +289,8 @@ void CRockGiant::ReflectY(CDbRoom *pRoom)
 	--(*(piece++))->wY;
 	++(*(piece++))->wY;
 	++(*piece)->wY;
-	std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX,this->wY+1)]);
-	std::swap(
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX+1,this->wY)],
-			pRoom->pMonsterSquares[pRoom->ARRAYINDEX(this->wX+1,this->wY+1)]);
+	pRoom->SwapMonsterSquares(this->wX, this->wY, this->wX, this->wY+1);
+	pRoom->SwapMonsterSquares(this->wX+1, this->wY, this->wX+1, this->wY+1);
 }
 
 //*****************************************************************************************
@@ -350,12 +342,12 @@ void CRockGiant::MovePiece(
 		}
 
 		//Remove it from the room's monster array to avoid a pointer overwrite assertion.
-		room.pMonsterSquares[room.ARRAYINDEX(wDestX, wDestY)] = NULL;
+		room.SetMonsterSquare(wDestX, wDestY, NULL);
 	}
 
 	//Place monster piece on destination tile.
 	ASSERT(!room.pMonsterSquares[room.ARRAYINDEX(wDestX,wDestY)]);
-	room.pMonsterSquares[room.ARRAYINDEX(wDestX,wDestY)] = pMonster;
+	room.SetMonsterSquare(wDestX, wDestY, pMonster);
 
 	//Set new coords.
 	pMonster->wX = wDestX;
@@ -0,0 +1,530 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+#include "RoomSolver.h"
+#include "CueEvents.h"
+#include "CurrentGame.h"
+#include "DbRooms.h"
+#include "GameConstants.h"
+#include <BackEndLib/Assert.h>
+
+#include <SDL.h>
+
+#include <algorithm>
+
+//Commands tried from each state.
+static const UINT MOVE_COMMANDS[] = {
+	CMD_N, CMD_NE, CMD_E, CMD_SE, CMD_S, CMD_SW, CMD_W, CMD_NW,
+	CMD_C, CMD_CC, CMD_WAIT
+};
+static const UINT COMMANDS_PER_NODE = sizeof(MOVE_COMMANDS) / sizeof(MOVE_COMMANDS[0]);
+
+//Commands tried while the player is being asked a question.
+//Multiple choice questions are answered as yes/no questions.
+static const UINT ANSWER_COMMANDS[] = {CMD_YES, CMD_NO};
+static const UINT ANSWERS_PER_NODE = sizeof(ANSWER_COMMANDS) / sizeof(ANSWER_COMMANDS[0]);
+
+//How many states each worker thread gets per batch.
+const UINT NODES_PER_THREAD = 64;
+
+//How many consecutive states a worker takes at a time.  Consecutive states
+//are often siblings, which can all be rebuilt from the worker's last game.
+const UINT NODES_PER_PICKUP = 8;
+
+const UINT NO_NODE = UINT(-1);
+const UINT MAX_DEPTH = 0xFFFF;    //node depths are USHORTs
+const UINT MAX_MONSTERS = 0xFFFF; //as are monster counts
+
+//
+//CTranspositionTable
+//
+
+//*****************************************************************************
+CTranspositionTable::CTranspositionTable()
+	: dwSize(0)
+{
+}
+
+//*****************************************************************************
+void CTranspositionTable::Clear()
+{
+	vector<ULONGLONG> empty;
+	this->slots.swap(empty);
+	this->dwSize = 0;
+}
+
+//*****************************************************************************
+bool CTranspositionTable::Insert(ULONGLONG hash)
+//Adds a state hash to the table.
+//
+//Returns: whether the hash wasn't in the table yet
+{
+	if (!hash)
+		hash = 1; //0 marks empty slots
+
+	//Keep the table at most half full.
+	if ((this->dwSize + 1) * 2 > this->slots.size())
+		Grow();
+
+	const UINT dwMask = this->slots.size() - 1;
+	for (UINT dwSlot = UINT(hash) & dwMask; ; dwSlot = (dwSlot + 1) & dwMask)
+	{
+		ULONGLONG& slot = this->slots[dwSlot];
+		if (slot == hash)
+			return false;
+		if (!slot)
+		{
+			slot = hash;
+			++this->dwSize;
+			return true;
+		}
+	}
+}
+
+//*****************************************************************************
+void CTranspositionTable::Grow()
+//Doubles the number of slots.
+{
+	vector<ULONGLONG> oldSlots;
+	oldSlots.swap(this->slots);
+	this->slots.resize(oldSlots.empty() ? 1024 : oldSlots.size() * 2, 0);
+
+	const UINT dwMask = this->slots.size() - 1;
+	for (vector<ULONGLONG>::const_iterator hash = oldSlots.begin();
+			hash != oldSlots.end(); ++hash)
+	{
+		if (!*hash)
+			continue;
+		UINT dwSlot = UINT(*hash) & dwMask;
+		while (this->slots[dwSlot])
+			dwSlot = (dwSlot + 1) & dwMask;
+		this->slots[dwSlot] = *hash;
+	}
+}
+
+//
+//CRoomSolver
+//
+
+//*****************************************************************************
+CRoomSolver::CRoomSolver(
+//Constructor.
+//
+//Params:
+	const CCurrentGame &startGame, //(in) game in the state to search from.
+	                               //It is copied and not changed.
+	const UINT wThreads)           //(in) number of worker threads, or 0 for the default [default=0]
+	: bMergeTurns(false)
+	, pStartGame(new CCurrentGame(startGame))
+	, wThreads(wThreads ? wThreads : GetDefaultThreadCount())
+	, eSearchType(ST_BreadthFirst)
+	, bScripted(!startGame.GlobalScriptsRunning.empty())
+	, dwNextNode(0)
+	, bSolved(false), bExhausted(false), bDepthLimited(false)
+	, wDepthSearched(0)
+	, pMutex(NULL)
+	, wNextBatchIndex(0)
+{
+	//Nothing is saved, recorded or snapshotted by games played during the search.
+	this->pStartGame->SetAutoSaveOptions(ASO_NONE);
+	this->pStartGame->bIsDemoRecording = false;
+	this->pStartGame->dwComputationTimePerSnapshot = UINT(-1);
+	this->snapshot.AddGame(*this->pStartGame);
+	this->pStartGame->GetSimulationContext().SetDataSource(&this->snapshot);
+
+	//Only scripts can count turns or add more scripted characters.
+	for (const CMonster *pMonster = this->pStartGame->pRoom->pFirstMonster;
+			pMonster != NULL && !this->bScripted; pMonster = pMonster->pNext)
+		if (pMonster->wType == M_CHARACTER)
+			this->bScripted = true;
+
+	for (UINT wI = 0; wI < this->wThreads; ++wI)
+		this->workers.push_back(new WORKER(this, new CCurrentGame(*this->pStartGame)));
+}
+
+//*****************************************************************************
+CRoomSolver::~CRoomSolver()
+{
+	for (vector<WORKER*>::const_iterator worker = this->workers.begin();
+			worker != this->workers.end(); ++worker)
+	{
+		delete (*worker)->pGame;
+		delete (*worker)->pBaseGame;
+		delete *worker;
+	}
+	delete this->pStartGame;
+}
+
+//*****************************************************************************
+UINT CRoomSolver::GetDefaultThreadCount()
+//Returns: how many worker threads to search with when not specified.
+{
+	const int nCPUs = SDL_GetCPUCount();
+	return nCPUs > 1 ? UINT(nCPUs) : 1;
+}
+
+//*****************************************************************************
+bool CRoomSolver::Solve(
+//Searches for the shortest command sequence that conquers the room.
+//GetSolution() returns it afterwards, and GetStateCount() the number of
+//distinct states reached.
+//
+//Params:
+	const SEARCHTYPE eSearchType, //(in) [default=ST_BreadthFirst]
+	const UINT dwMaxStates,       //(in) stop after reaching this many states, or 0 for
+	                              //no limit [default=0]
+	const UINT wMaxDepth,         //(in) don't search past this many commands, or 0 for
+	                              //no limit [default=0]
+	void (*pfnProgress)(UINT, UINT)) //(in) if set, called on this thread with the state
+	                              //count and search depth as the search goes [default=NULL]
+//
+//Returns:
+//Whether a solution was found.
+{
+	this->eSearchType = eSearchType;
+	this->transpositions.Clear();
+	this->nodes.clear();
+	this->openNodes = priority_queue<OPENNODE>();
+	this->dwNextNode = 0;
+	this->solution.clear();
+	this->bSolved = this->bExhausted = this->bDepthLimited = false;
+	this->wDepthSearched = 0;
+	const UINT wDepthLimit = wMaxDepth && wMaxDepth < MAX_DEPTH ? wMaxDepth : MAX_DEPTH;
+
+	//Room might need no moves at all.
+	if (this->pStartGame->IsCurrentRoomPendingConquer())
+	{
+		this->bSolved = true;
+		return true;
+	}
+
+	const USHORT wMonsters = USHORT(std::min(this->pStartGame->pRoom->wMonsterCount, MAX_MONSTERS));
+	this->transpositions.Insert(GetStateKey(*this->pStartGame));
+	this->nodes.push_back(SOLVERNODE(NO_NODE, CMD_UNSPECIFIED, 0, wMonsters));
+	if (eSearchType == ST_AStar)
+		this->openNodes.push(OPENNODE(0, wMonsters));
+
+	this->pMutex = SDL_CreateMutex();
+	const UINT wBatchSize = this->wThreads * NODES_PER_THREAD;
+	for (;;)
+	{
+		//Pick the next states to expand.
+		this->batch.clear();
+		if (eSearchType == ST_AStar)
+		{
+			while (this->batch.size() < wBatchSize && !this->openNodes.empty())
+			{
+				this->batch.push_back(this->openNodes.top().dwNode);
+				this->openNodes.pop();
+			}
+		} else {
+			//States are added in order of depth.
+			while (this->batch.size() < wBatchSize && this->dwNextNode < this->nodes.size())
+			{
+				if (this->nodes[this->dwNextNode].wDepth >= wDepthLimit)
+				{
+					this->bDepthLimited = true;
+					this->dwNextNode = this->nodes.size();
+					break;
+				}
+				this->batch.push_back(this->dwNextNode++);
+			}
+		}
+		if (this->batch.empty())
+		{
+			this->bExhausted = !this->bDepthLimited;
+			break;
+		}
+
+		ExpandBatch();
+		MergeBatch(wDepthLimit);
+
+		if (pfnProgress)
+			pfnProgress(GetStateCount(), this->wDepthSearched);
+		if (this->bSolved)
+			break;
+		if (dwMaxStates && GetStateCount() >= dwMaxStates)
+			break;
+	}
+
+	if (this->pMutex)
+	{
+		SDL_DestroyMutex(this->pMutex);
+		this->pMutex = NULL;
+	}
+
+	//Release the games kept between batches.
+	for (vector<WORKER*>::const_iterator worker = this->workers.begin();
+			worker != this->workers.end(); ++worker)
+	{
+		delete (*worker)->pGame;
+		(*worker)->pGame = NULL;
+		(*worker)->dwGameNode = NO_NODE;
+	}
+	this->batch.clear();
+	this->results.clear();
+
+	return this->bSolved;
+}
+
+//
+//Private methods.
+//
+
+//*****************************************************************************
+CCurrentGame* CRoomSolver::CloneGame(const CCurrentGame &game) const
+//Returns: a new copy of game, which borrows game's hold and level
+{
+	CCurrentGame *pGame = new CCurrentGame(game, true);
+	pGame->Commands = game.Commands; //for commands that rewind play, i.e. temporal splits
+	return pGame;
+}
+
+//*****************************************************************************
+void CRoomSolver::ExpandBatch()
+//Tries each command from every state in the batch.
+{
+	this->results.assign(this->batch.size() * COMMANDS_PER_NODE, CHILD());
+	this->wNextBatchIndex = 0;
+
+	const UINT wWorkers = std::min(this->wThreads,
+			UINT(this->batch.size() + NODES_PER_PICKUP - 1) / NODES_PER_PICKUP);
+	if (wWorkers <= 1 || !this->pMutex)
+	{
+		ExpandPendingNodes(*this->workers[0]);
+		return;
+	}
+
+	vector<SDL_Thread*> threads;
+	for (UINT wI = 0; wI < wWorkers; ++wI)
+	{
+		SDL_Thread *pThread = SDL_CreateThread(SolverWorker, "solver", this->workers[wI]);
+		if (pThread)
+			threads.push_back(pThread);
+	}
+
+	if (threads.empty())
+	{
+		ExpandPendingNodes(*this->workers[0]); //couldn't create threads
+	} else {
+		for (vector<SDL_Thread*>::const_iterator thread = threads.begin();
+				thread != threads.end(); ++thread)
+			SDL_WaitThread(*thread, NULL);
+	}
+	ASSERT(this->wNextBatchIndex >= this->batch.size());
+}
+
+//*****************************************************************************
+void CRoomSolver::ExpandNode(
+//Tries each command from a state in the batch, storing what they lead to in
+//this->results.  Doesn't change anything else shared between workers.
+//
+//Params:
+	WORKER &worker,          //(in/out) worker thread's games
+	const UINT wBatchIndex)  //(in) state to expand
+{
+	CCurrentGame *pGame = GetStateForNode(worker, this->batch[wBatchIndex]);
+	ASSERT(pGame);
+
+	const bool bAnswering = pGame->IsPlayerAnsweringQuestions();
+	const UINT *pCommands = bAnswering ? ANSWER_COMMANDS : MOVE_COMMANDS;
+	const UINT wCommands = bAnswering ? ANSWERS_PER_NODE : COMMANDS_PER_NODE;
+
+	CHILD *pChild = &this->results[wBatchIndex * COMMANDS_PER_NODE];
+	for (UINT wI = 0; wI < wCommands; ++wI, ++pChild)
+	{
+		CCueEvents CueEvents;
+		CCurrentGame *pChildGame = CloneGame(*pGame);
+		pChildGame->ProcessCommand(pCommands[wI], CueEvents);
+
+		pChild->bytCommand = BYTE(pCommands[wI]);
+		if (IsSolved(*pChildGame, CueEvents))
+			pChild->eResult = CR_Solved;
+		else if (!pChildGame->bIsGameActive ||
+				CueEvents.HasAnyOccurred(IDCOUNT(CIDA_PlayerDied), CIDA_PlayerDied) ||
+				CueEvents.HasAnyOccurred(IDCOUNT(CIDA_PlayerLeftRoom), CIDA_PlayerLeftRoom))
+			pChild->eResult = CR_Dead;
+		else {
+			pChild->eResult = CR_State;
+			pChild->hash = GetStateKey(*pChildGame);
+			pChild->wMonsters = USHORT(std::min(pChildGame->pRoom->wMonsterCount, MAX_MONSTERS));
+		}
+		delete pChildGame;
+	}
+
+	delete pGame;
+}
+
+//*****************************************************************************
+void CRoomSolver::ExpandPendingNodes(WORKER &worker)
+//Expand states in the current batch until none are left.
+{
+	for (;;)
+	{
+		if (this->pMutex)
+			SDL_LockMutex(this->pMutex);
+		const UINT wStart = this->wNextBatchIndex;
+		const UINT wEnd = std::min(wStart + NODES_PER_PICKUP, UINT(this->batch.size()));
+		if (wStart < wEnd)
+			this->wNextBatchIndex = wEnd;
+		if (this->pMutex)
+			SDL_UnlockMutex(this->pMutex);
+		if (wStart >= wEnd)
+			return;
+
+		for (UINT wI = wStart; wI < wEnd; ++wI)
+			ExpandNode(worker, wI);
+	}
+}
+
+//*****************************************************************************
+ULONGLONG CRoomSolver::GetStateKey(const CCurrentGame &game) const
+//Returns: the transposition table key for a game's state
+{
+	return game.GetStateHash(!this->bMergeTurns || this->bScripted);
+}
+
+//*****************************************************************************
+CCurrentGame* CRoomSolver::GetStateForNode(
+//Rebuilds the game state of a node reached in the search.
+//
+//Params:
+	WORKER &worker,     //(in/out) worker thread's games
+	const UINT dwNode)  //(in)
+//
+//Returns:
+//New game in the node's state, which the caller must delete
+const
+{
+	if (dwNode == 0)
+		return CloneGame(*worker.pBaseGame);
+
+	const SOLVERNODE& node = this->nodes[dwNode];
+	if (worker.dwGameNode != node.dwParent)
+	{
+		//Replay the commands leading to the parent state from the start.
+		delete worker.pGame;
+		worker.pGame = CloneGame(*worker.pBaseGame);
+
+		vector<BYTE> commands;
+		for (UINT dwI = node.dwParent; dwI != 0; dwI = this->nodes[dwI].dwParent)
+			commands.push_back(this->nodes[dwI].bytCommand);
+
+		CCueEvents CueEvents;
+		for (vector<BYTE>::const_reverse_iterator command = commands.rbegin();
+				command != commands.rend(); ++command)
+			worker.pGame->ProcessCommand(*command, CueEvents);
+		worker.dwGameNode = node.dwParent;
+	}
+
+	//Keep the parent's state for the node's siblings.
+	CCueEvents CueEvents;
+	CCurrentGame *pGame = CloneGame(*worker.pGame);
+	pGame->ProcessCommand(node.bytCommand, CueEvents);
+	return pGame;
+}
+
+//*****************************************************************************
+bool CRoomSolver::IsSolved(
+//Returns: whether the room has been conquered, or will be when the player leaves it
+//
+//Params:
+	const CCurrentGame &game,     //(in) game after a command was processed
+	const CCueEvents &CueEvents)  //(in) events from the command
+const
+{
+	return CueEvents.HasOccurred(CID_ConquerRoom) ||
+			(game.bIsGameActive && game.IsCurrentRoomPendingConquer());
+}
+
+//*****************************************************************************
+void CRoomSolver::MergeBatch(
+//Adds the new states reached by the batch to the search, in batch order so
+//the search doesn't depend on how the work was split between threads.
+//
+//Params:
+	const UINT wMaxDepth)  //(in) don't expand states this many commands deep
+{
+	for (UINT wI = 0; wI < this->batch.size(); ++wI)
+	{
+		const UINT dwParent = this->batch[wI];
+		const USHORT wDepth = this->nodes[dwParent].wDepth + 1;
+		const CHILD *pChild = &this->results[wI * COMMANDS_PER_NODE];
+		for (UINT wC = 0; wC < COMMANDS_PER_NODE; ++wC, ++pChild)
+		{
+			switch (pChild->eResult)
+			{
+				case CR_Solved:
+					if (wDepth > this->wDepthSearched)
+						this->wDepthSearched = wDepth;
+					SetSolution(dwParent, pChild->bytCommand);
+				return;
+
+				case CR_State:
+					if (!this->transpositions.Insert(pChild->hash))
+						break; //reached already
+					if (wDepth > this->wDepthSearched)
+						this->wDepthSearched = wDepth;
+					if (this->eSearchType == ST_AStar)
+					{
+						if (wDepth < wMaxDepth)
+							this->openNodes.push(OPENNODE(this->nodes.size(), wDepth + pChild->wMonsters));
+						else
+							this->bDepthLimited = true;
+					}
+					this->nodes.push_back(SOLVERNODE(dwParent, pChild->bytCommand,
+							wDepth, pChild->wMonsters));
+				break;
+
+				default: break;
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+void CRoomSolver::SetSolution(
+//Sets the solution to the commands leading to a node, followed by one more.
+//
+//Params:
+	const UINT dwNode, const BYTE bytLastCommand) //(in)
+{
+	this->solution.clear();
+	for (UINT dwI = dwNode; dwI != 0; dwI = this->nodes[dwI].dwParent)
+		this->solution.push_back(this->nodes[dwI].bytCommand);
+	std::reverse(this->solution.begin(), this->solution.end());
+	this->solution.push_back(bytLastCommand);
+	this->bSolved = true;
+}
+
+//*****************************************************************************
+int CRoomSolver::SolverWorker(void *pData)
+//Worker thread procedure.
+{
+	WORKER *pWorker = static_cast<WORKER*>(pData);
+	pWorker->pSolver->ExpandPendingNodes(*pWorker);
+	return 0;
+}
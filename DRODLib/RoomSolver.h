@@ -0,0 +1,189 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//RoomSolver.h
+//Declarations for CRoomSolver.
+//Searches the player commands that can be made in a room for the shortest
+//sequence that conquers it, so designers can check for unintended solutions.
+//
+//Game states are not kept during the search.  Each state reached is recorded
+//as the command that reached it and the state it was reached from, and its
+//state hash is entered in a transposition table so it is only expanded once.
+//To expand a state, worker threads rebuild it by replaying its commands from
+//the start, which is cheap next to the memory full copies would take.
+
+#ifndef ROOMSOLVER_H
+#define ROOMSOLVER_H
+
+#include "SimulationContext.h"
+#include <BackEndLib/Types.h>
+
+#include <SDL_thread.h>
+
+#include <queue>
+#include <vector>
+using std::priority_queue;
+using std::vector;
+
+class CCueEvents;
+class CCurrentGame;
+
+//*****************************************************************************
+//Set of 64-bit state hashes.  Open addressing keeps it at 16 bytes per
+//entry or less, so millions of states fit in memory.
+class CTranspositionTable
+{
+public:
+	CTranspositionTable();
+
+	void Clear();
+	bool Insert(ULONGLONG hash);
+	UINT GetSize() const {return this->dwSize;}
+
+private:
+	void Grow();
+
+	vector<ULONGLONG> slots; //0 marks an empty slot
+	UINT dwSize;
+};
+
+//*****************************************************************************
+class CRoomSolver
+{
+public:
+	enum SEARCHTYPE
+	{
+		ST_BreadthFirst, //finds the shortest solution
+		ST_AStar         //expands states with fewer monsters left first; usually
+		                 //finds a solution sooner, but it may not be the shortest
+	};
+
+	CRoomSolver(const CCurrentGame &startGame, const UINT wThreads=0);
+	~CRoomSolver();
+
+	UINT  GetDepthSearched() const {return this->wDepthSearched;}
+	static UINT GetDefaultThreadCount();
+	const vector<UINT>& GetSolution() const {return this->solution;}
+	UINT  GetStateCount() const {return this->transpositions.GetSize();}
+	bool  IsExhausted() const {return this->bExhausted;}
+	bool  IsSolved() const {return this->bSolved;}
+
+	bool  Solve(const SEARCHTYPE eSearchType=ST_BreadthFirst,
+			const UINT dwMaxStates=0, const UINT wMaxDepth=0,
+			void (*pfnProgress)(UINT, UINT)=NULL);
+
+	bool bMergeTurns; //whether the same position reached on different turns is searched
+	                  //once.  Ignored in rooms with scripts, which may count turns.
+
+private:
+	//A state reached during the search.
+	struct SOLVERNODE
+	{
+		SOLVERNODE(const UINT dwParent, const BYTE bytCommand, const USHORT wDepth,
+				const USHORT wMonsters)
+			: dwParent(dwParent), bytCommand(bytCommand), wDepth(wDepth), wMonsters(wMonsters)
+		{ }
+		UINT dwParent;   //state this one was reached from
+		BYTE bytCommand; //command that reached it
+		USHORT wDepth;   //number of commands from the start
+		USHORT wMonsters; //monsters left in the room
+	};
+
+	//Outcome of one command tried from a state being expanded.
+	enum CHILDRESULT
+	{
+		CR_None=0,  //command not tried
+		CR_State,   //a state to search further
+		CR_Solved,  //room is conquered
+		CR_Dead     //player died or left the room
+	};
+	struct CHILD
+	{
+		CHILD() : eResult(CR_None), bytCommand(0), wMonsters(0), hash(0) { }
+		CHILDRESULT eResult;
+		BYTE bytCommand;
+		USHORT wMonsters;
+		ULONGLONG hash;
+	};
+
+	//State kept by each worker between batches.
+	struct WORKER
+	{
+		WORKER(CRoomSolver *pSolver, CCurrentGame *pBaseGame)
+			: pSolver(pSolver), pBaseGame(pBaseGame), pGame(NULL), dwGameNode(UINT(-1)) { }
+		CRoomSolver *pSolver;
+		CCurrentGame *pBaseGame; //copy of the start game; owns the hold and level
+		                         //this worker's games borrow, so none are shared
+		CCurrentGame *pGame;     //game in the state of node dwGameNode, kept for its children
+		UINT dwGameNode;
+	};
+
+	//Priority queue entry for A*.
+	struct OPENNODE
+	{
+		OPENNODE(const UINT dwNode, const UINT wCost) : dwNode(dwNode), wCost(wCost) { }
+		bool operator<(const OPENNODE& rhs) const {
+			//lowest cost first, then first reached
+			return this->wCost != rhs.wCost ? this->wCost > rhs.wCost : this->dwNode > rhs.dwNode;
+		}
+		UINT dwNode, wCost;
+	};
+
+	CCurrentGame* CloneGame(const CCurrentGame &game) const;
+	void  ExpandBatch();
+	void  ExpandNode(WORKER &worker, const UINT wBatchIndex);
+	void  ExpandPendingNodes(WORKER &worker);
+	ULONGLONG GetStateKey(const CCurrentGame &game) const;
+	CCurrentGame* GetStateForNode(WORKER &worker, const UINT dwNode) const;
+	bool  IsSolved(const CCurrentGame &game, const CCueEvents &CueEvents) const;
+	void  MergeBatch(const UINT wMaxDepth);
+	void  SetSolution(const UINT dwNode, const BYTE bytLastCommand);
+	static int SolverWorker(void *pData);
+
+	CCurrentGame *pStartGame;   //searched from
+	UINT wThreads;
+	CGameDataSnapshot snapshot; //hold data read by games during the search
+	SEARCHTYPE eSearchType;
+	bool bScripted;             //whether scripts run in the room
+
+	CTranspositionTable transpositions;
+	vector<SOLVERNODE> nodes;
+	priority_queue<OPENNODE> openNodes; //A* only
+	UINT dwNextNode;                    //breadth-first only
+
+	vector<UINT> solution;
+	bool bSolved, bExhausted, bDepthLimited;
+	UINT wDepthSearched;
+
+	//Shared with worker threads while a batch is being expanded.
+	vector<UINT> batch;    //nodes to expand
+	vector<CHILD> results; //COMMANDS_PER_NODE per node in batch
+	vector<WORKER*> workers;
+	SDL_mutex *pMutex;
+	UINT wNextBatchIndex;
+};
+
+#endif //...#ifndef ROOMSOLVER_H
@@ -0,0 +1,339 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+#include "ScriptExpression.h"
+#include "Character.h"
+#include "CurrentGame.h"
+#include "DbHolds.h"
+#include "PlayerStats.h"
+
+#include <BackEndLib/Assert.h>
+#include <BackEndLib/Files.h>
+#include <BackEndLib/Ports.h>
+
+#define SKIP_WHITESPACE(str, index) while (iswspace(str[index])) ++index
+
+//*****************************************************************************
+CScriptExpression::CScriptExpression(
+//Compiles the expression starting at pwStr[index].
+//
+//Params:
+	const WCHAR *pwStr, UINT& index, //(in/out) text, and where the expression
+	                                 //starts/ends in it
+	const CDbHold *pHold,            //(in) hold whose vars are referenced
+	const bool bExpectCloseParen)    //(in) [default=false] whether a close paren
+	                                 //should mark the end of the expression
+	: wStackSize(0), wMaxStackSize(0)
+	, wSource(pwStr), dwHoldID(pHold ? pHold->dwHoldID : 0), pHold(pHold)
+{
+	ASSERT(pwStr);
+
+	//Hold var IDs are looked up now instead of each time the expression is evaluated.
+	ParseExpression(pwStr, index, bExpectCloseParen);
+	this->pHold = NULL;
+	ASSERT(this->wStackSize == 1);
+}
+
+//*****************************************************************************
+int CScriptExpression::Evaluate(CCurrentGame *pGame, CCharacter *pNPC) const
+//Returns: the value of the expression in the current game state, with vars
+//local to pNPC (may be NULL)
+{
+	ASSERT(pGame);
+
+	static const UINT LOCAL_STACK_SIZE = 16;
+	int localStack[LOCAL_STACK_SIZE];
+	vector<int> largeStack;
+	int *stack = localStack;
+	if (this->wMaxStackSize > LOCAL_STACK_SIZE)
+	{
+		largeStack.resize(this->wMaxStackSize);
+		stack = &largeStack[0];
+	}
+
+	UINT wTop = 0;
+	for (vector<OP>::const_iterator op = this->ops.begin(); op != this->ops.end(); ++op)
+	{
+		switch (op->eOp)
+		{
+			case OP_Number:
+				stack[wTop++] = op->wArg;
+			break;
+			case OP_PredefinedVar:
+				if (pNPC)
+					stack[wTop++] = int(pNPC->getPredefinedVarInt(op->wArg));
+				else
+					stack[wTop++] = int(pGame->getVar(op->wArg));
+			break;
+			case OP_LocalVar:
+				stack[wTop++] = pNPC ? pNPC->getLocalVarInt(this->localVarNames[op->wArg]) : 0;
+			break;
+			case OP_HoldVar:
+				stack[wTop++] = pGame->GetHoldVarInt(op->wArg); //zero unless an integer
+			break;
+			case OP_Negate:
+				stack[wTop-1] = -stack[wTop-1];
+			break;
+			case OP_Add:
+				--wTop;
+				stack[wTop-1] += stack[wTop];
+			break;
+			case OP_Multiply:
+				--wTop;
+				stack[wTop-1] *= stack[wTop];
+			break;
+			case OP_Divide:
+				--wTop;
+				if (stack[wTop]) //no divide by zero
+					stack[wTop-1] /= stack[wTop];
+			break;
+			case OP_Modulo:
+				--wTop;
+				if (stack[wTop]) //no mod by zero
+					stack[wTop-1] %= stack[wTop];
+			break;
+			case OP_LogError:
+			{
+				CFiles f;
+				f.AppendErrorLog(this->errors[op->wArg].c_str());
+			}
+			break;
+		}
+	}
+
+	ASSERT(wTop == 1);
+	return stack[0];
+}
+
+//*****************************************************************************
+bool CScriptExpression::IsCompiledFrom(const WSTRING& wStr, const CDbHold *pHold) const
+//Returns: whether this expression was compiled from this text for this hold
+{
+	return this->dwHoldID == (pHold ? pHold->dwHoldID : 0) && this->wSource == wStr;
+}
+
+//*****************************************************************************
+void CScriptExpression::AddOp(const OPCODE eOp, const int wArg) //[default=0]
+{
+	this->ops.push_back(OP(eOp, wArg));
+
+	switch (eOp)
+	{
+		case OP_Number: case OP_PredefinedVar: case OP_LocalVar: case OP_HoldVar:
+			if (++this->wStackSize > this->wMaxStackSize)
+				this->wMaxStackSize = this->wStackSize;
+		break;
+		case OP_Add: case OP_Multiply: case OP_Divide: case OP_Modulo:
+			ASSERT(this->wStackSize >= 2);
+			--this->wStackSize;
+		break;
+		case OP_Negate: case OP_LogError:
+		break;
+	}
+}
+
+//*****************************************************************************
+void CScriptExpression::LogError(const WCHAR *pwStr, const char *pszError)
+//Adds an op to log a parse error when the expression is evaluated.
+{
+	string str = UnicodeToUTF8(pwStr);
+	str += ": Parse error (";
+	str += pszError;
+	str += ")";
+	AddOp(OP_LogError, int(this->errors.size()));
+	this->errors.push_back(str);
+}
+
+//*****************************************************************************
+void CScriptExpression::ParseExpression(
+//Compile a simple nested expression for the grammar
+//
+// expression = ["+"|"-"] term {("+"|"-") term}
+//
+//Params:
+	const WCHAR *pwStr, UINT& index, const bool bExpectCloseParen)
+{
+	SKIP_WHITESPACE(pwStr, index);
+
+	bool bAdd = true; //otherwise subtract
+	if (pwStr[index] == W_t('+'))
+		++index;
+	else if (pwStr[index] == W_t('-'))
+	{
+		bAdd = false;
+		++index;
+	}
+
+	ParseTerm(pwStr, index);
+	if (!bAdd)
+		AddOp(OP_Negate);
+
+	SKIP_WHITESPACE(pwStr, index);
+	while (pwStr[index]!=0)
+	{
+		//Parse another term.
+		if (pwStr[index] == W_t('+'))
+		{
+			bAdd = true;
+			++index;
+		}
+		else if (pwStr[index] == W_t('-'))
+		{
+			bAdd = false;
+			++index;
+		}
+		else if (bExpectCloseParen && pwStr[index] == W_t(')')) //closing nested expression
+			return; //caller will parse the close paren
+		else
+		{
+			//parse error -- the value is what has been parsed so far
+			LogError(pwStr + index, "bad symbol");
+			return;
+		}
+
+		ParseTerm(pwStr, index);
+		if (!bAdd)
+			AddOp(OP_Negate);
+		AddOp(OP_Add);
+	}
+}
+
+//*****************************************************************************
+void CScriptExpression::ParseTerm(const WCHAR *pwStr, UINT& index)
+//Compile a term in an expression.
+//
+// term = factor {("*"|"/"|"%") factor}
+{
+	ParseFactor(pwStr, index);
+
+	while (pwStr[index]!=0)
+	{
+		//Parse another factor.
+		SKIP_WHITESPACE(pwStr, index);
+
+		OPCODE eOp;
+		if (pwStr[index] == W_t('*'))
+			eOp = OP_Multiply;
+		else if (pwStr[index] == W_t('/'))
+			eOp = OP_Divide;
+		else if (pwStr[index] == W_t('%'))
+			eOp = OP_Modulo;
+		else
+			return; //no more factors in this term
+		++index;
+
+		ParseFactor(pwStr, index);
+		AddOp(eOp);
+	}
+}
+
+//*****************************************************************************
+void CScriptExpression::ParseFactor(const WCHAR *pwStr, UINT& index)
+//Compile a factor in an expression.
+//
+// factor = var | number | "(" expression ")"
+{
+	SKIP_WHITESPACE(pwStr, index);
+
+	//A nested expression?
+	if (pwStr[index] == W_t('('))
+	{
+		++index;
+		ParseExpression(pwStr, index, true); //recursive call
+		SKIP_WHITESPACE(pwStr, index);
+		if (pwStr[index] == W_t(')'))
+			++index;
+		else
+			LogError(pwStr, "missing close parenthesis");
+		return;
+	}
+
+	//Number?
+	if (iswdigit(pwStr[index]))
+	{
+		const int val = _Wtoi(pwStr + index);
+
+		//Parse past digits.
+		++index;
+		while (iswdigit(pwStr[index]))
+			++index;
+
+		if (iswalpha(pwStr[index])) //i.e. of form <digits><alphas>
+		{
+			//Invalid var name -- skip to end of it and use a zero value.
+			while (CDbHold::IsVarCharValid(pwStr[index]))
+				++index;
+
+			LogError(pwStr, "invalid var name");
+			AddOp(OP_Number, 0);
+			return;
+		}
+
+		AddOp(OP_Number, val);
+		return;
+	}
+
+	//Variable identifier?
+	if (pwStr[index] == W_t('_') || iswalpha(pwStr[index]) || pwStr[index] == W_t('.')) //valid first char
+	{
+		//Find spot where var identifier ends.
+		int endIndex = index + 1;
+		int spcTrail = 0;
+		while (CDbHold::IsVarCharValid(pwStr[endIndex]))
+		{
+			if (pwStr[endIndex] == W_t(' '))
+				++spcTrail;
+			else
+				spcTrail = 0;
+			++endIndex;
+		}
+
+		const WSTRING wVarName(pwStr + index, endIndex - index - spcTrail);
+		index = endIndex;
+
+		//Is it a predefined var?
+		const ScriptVars::Predefined eVar = ScriptVars::parsePredefinedVar(wVarName);
+		if (eVar != ScriptVars::P_NoVar)
+		{
+			if (ScriptVars::IsStringVar(eVar))
+				AddOp(OP_Number, 0);
+			else
+				AddOp(OP_PredefinedVar, int(eVar));
+		} else if (ScriptVars::IsCharacterLocalVar(wVarName)) {
+			AddOp(OP_LocalVar, int(this->localVarNames.size()));
+			this->localVarNames.push_back(wVarName);
+		} else {
+			//Is it a local hold var?
+			//Otherwise it is unrecognized and gets var ID zero, which has no value.
+			AddOp(OP_HoldVar, this->pHold ? int(this->pHold->GetVarID(wVarName.c_str())) : 0);
+		}
+		return;
+	}
+
+	//Invalid identifier
+	LogError(pwStr + index, "invalid var name");
+	AddOp(OP_Number, 0);
+}
@@ -0,0 +1,94 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//ScriptExpression.h
+//Declarations for CScriptExpression.
+//An integer expression from a script command, compiled into a list of stack
+//operations so it can be evaluated each turn without parsing its text again.
+//See CCharacter::parseExpression for the grammar.
+
+#ifndef SCRIPTEXPRESSION_H
+#define SCRIPTEXPRESSION_H
+
+#include <BackEndLib/Types.h>
+#include <BackEndLib/Wchar.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+class CCharacter;
+class CCurrentGame;
+class CDbHold;
+
+class CScriptExpression
+{
+public:
+	CScriptExpression(const WCHAR *pwStr, UINT& index, const CDbHold *pHold,
+			const bool bExpectCloseParen=false);
+
+	int  Evaluate(CCurrentGame *pGame, CCharacter *pNPC) const;
+	bool IsCompiledFrom(const WSTRING& wStr, const CDbHold *pHold) const;
+
+private:
+	enum OPCODE
+	{
+		OP_Number,        //push wArg
+		OP_PredefinedVar, //push the value of predefined var wArg
+		OP_LocalVar,      //push the value of character local var localVarNames[wArg]
+		OP_HoldVar,       //push the value of hold var ID wArg
+		OP_Negate,
+		OP_Add,
+		OP_Multiply,
+		OP_Divide,        //divide or mod by zero leaves the left operand alone
+		OP_Modulo,
+		OP_LogError       //write errors[wArg] to the error log
+	};
+	struct OP
+	{
+		OP(const OPCODE eOp, const int wArg) : eOp(eOp), wArg(wArg) { }
+		OPCODE eOp;
+		int wArg;
+	};
+
+	void  AddOp(const OPCODE eOp, const int wArg=0);
+	void  LogError(const WCHAR *pwStr, const char *pszError);
+	void  ParseExpression(const WCHAR *pwStr, UINT& index, const bool bExpectCloseParen);
+	void  ParseTerm(const WCHAR *pwStr, UINT& index);
+	void  ParseFactor(const WCHAR *pwStr, UINT& index);
+
+	vector<OP> ops;
+	vector<WSTRING> localVarNames;
+	vector<string> errors;
+	UINT wStackSize, wMaxStackSize;
+
+	WSTRING wSource;          //text compiled
+	UINT dwHoldID;            //hold whose var IDs were looked up
+	const CDbHold *pHold;     //only set while compiling
+};
+
+#endif //...#ifndef SCRIPTEXPRESSION_H
@@ -0,0 +1,392 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+#include "SimulationContext.h"
+#include "Character.h"
+#include "CurrentGame.h"
+#include "Db.h"
+#include "DbLevels.h"
+#include "DbRooms.h"
+#include "DbSpeech.h"
+#include "PlayerStats.h"
+
+//Context used when no game is being played.  Main thread only.
+static CSimulationContext mainThreadContext;
+
+//Reads the DB directly.  Main thread only.
+static const CGameDataSource dbSource;
+
+//*****************************************************************************
+CSimulationContext& GetSimulationContext(const CCurrentGame *pGame)
+{
+	return pGame ? pGame->GetSimulationContext() : mainThreadContext;
+}
+
+//
+//CGameDataSource
+//
+
+//*****************************************************************************
+void CGameDataSource::GetCustomCharacterScript(
+//Gets the default script of a custom character.
+//
+//Params:
+	const UINT /*dwHoldID*/,   //(in) hold the character belongs to
+	HoldCharacter& character,  //(in)
+	COMMAND_VECTOR& commands)  //(out)
+const
+{
+	CCharacter::LoadCommands(character.ExtraVars, commands);
+}
+
+//*****************************************************************************
+void CGameDataSource::GetRequiredRooms(
+//Gets list of rooms in level required to conquer in order to complete level.
+//
+//Params:
+	const UINT dwLevelID, CIDSet& requiredRooms) //(in/out)
+const
+{
+	CDbLevels::GetRequiredRooms(dwLevelID, requiredRooms);
+}
+
+//*****************************************************************************
+WSTRING CGameDataSource::GetInputCommandKeyText(
+//Returns: name of the key the current player has bound to a command
+//
+//Params:
+	const InputCommands::DCMD eCommand) //(in)
+const
+{
+	ASSERT(eCommand < InputCommands::DCMD_Count);
+
+	const CDbPackedVars settings = g_pTheDB->GetCurrentPlayerSettings();
+	const InputCommands::DCMD eKey = InputCommands::DCMD(
+			settings.GetVar(InputCommands::COMMANDNAME_ARRAY[eCommand], 0));
+
+	return g_pTheDB->GetMessageText(InputCommands::KeyToMID(eKey));
+}
+
+//*****************************************************************************
+CDbRoom* CGameDataSource::GetRoomAtCoords(
+//Returns: new loaded room at the given coords in level, or NULL if there is none
+//
+//Params:
+	CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY)
+const
+{
+	return level.GetRoomAtCoords(dwRoomX, dwRoomY);
+}
+
+//*****************************************************************************
+UINT CGameDataSource::GetRoomIDAtCoords(
+//Returns: ID of room at the given coords in level, or 0 if there is none
+//
+//Params:
+	const CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY)
+const
+{
+	return level.GetRoomIDAtCoords(dwRoomX, dwRoomY);
+}
+
+//*****************************************************************************
+const WCHAR* CGameDataSource::GetSpeechText(CDbSpeech& speech) const
+//Returns: speech text, read from the DB if not loaded yet
+{
+	return (const WCHAR*)speech.MessageText;
+}
+
+//*****************************************************************************
+bool CGameDataSource::IsHoldCompleted(const UINT dwHoldID) const
+//Returns: whether the current player has completed the hold
+{
+	return g_pTheDB->Holds.IsHoldCompleted(dwHoldID, g_pTheDB->GetPlayerID());
+}
+
+//*****************************************************************************
+bool CGameDataSource::IsHoldMastered(const UINT dwHoldID) const
+//Returns: whether the current player has mastered the hold
+{
+	return g_pTheDB->Holds.IsHoldMastered(dwHoldID, g_pTheDB->GetPlayerID());
+}
+
+//
+//CGameDataSnapshot
+//
+
+//*****************************************************************************
+CGameDataSnapshot::~CGameDataSnapshot()
+{
+	Clear();
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::AddGame(
+//Loads the hold data the game may need to be played from its current room,
+//if not loaded already.  Main thread only.
+//
+//Params:
+	CCurrentGame& game) //(in/out) speech text in the game's rooms is loaded
+{
+	ASSERT(game.pHold);
+	ASSERT(game.pLevel);
+	ASSERT(game.pRoom);
+
+	if (this->inputCommandKeyTexts.empty())
+	{
+		//Text shown for vars in speech.
+		for (UINT eCommand = 0; eCommand < InputCommands::DCMD_Count; ++eCommand)
+			this->inputCommandKeyTexts.push_back(
+					CGameDataSource::GetInputCommandKeyText(InputCommands::DCMD(eCommand)));
+		ScriptVars::init();
+	}
+
+	const UINT dwHoldID = game.pHold->dwHoldID;
+	if (!this->holdCompleted.count(dwHoldID))
+	{
+		this->holdCompleted[dwHoldID] = CGameDataSource::IsHoldCompleted(dwHoldID);
+		this->holdMastered[dwHoldID] = CGameDataSource::IsHoldMastered(dwHoldID);
+
+		//Custom characters placed without a script, or started as global scripts.
+		for (vector<HoldCharacter*>::const_iterator character = game.pHold->characters.begin();
+				character != game.pHold->characters.end(); ++character)
+		{
+			COMMAND_VECTOR& commands = this->customScripts[IDPAIR(dwHoldID, (*character)->dwCharID)];
+			CGameDataSource::GetCustomCharacterScript(dwHoldID, **character, commands);
+			LoadSpeechText(commands);
+		}
+	}
+
+	const UINT dwLevelID = game.pLevel->dwLevelID;
+	if (!this->requiredRooms.count(dwLevelID))
+	{
+		CGameDataSource::GetRequiredRooms(dwLevelID, this->requiredRooms[dwLevelID]);
+		this->roomIDs[dwLevelID] = CDb::getRoomCoordsInLevel(dwLevelID);
+	}
+
+	//Rooms the player can leave to.
+	const UINT dwRoomX = game.pRoom->dwRoomX, dwRoomY = game.pRoom->dwRoomY;
+	AddRoom(*game.pLevel, dwRoomX, dwRoomY - 1);
+	AddRoom(*game.pLevel, dwRoomX + 1, dwRoomY);
+	AddRoom(*game.pLevel, dwRoomX, dwRoomY + 1);
+	AddRoom(*game.pLevel, dwRoomX - 1, dwRoomY);
+
+	//Rooms the game has already loaded.
+	LoadSpeechText(*game.pRoom);
+	for (map<UINT, CDbRoom*>::const_iterator room = game.loadedRooms.begin();
+			room != game.loadedRooms.end(); ++room)
+		if (room->second)
+			LoadSpeechText(*room->second);
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::Clear()
+//Discards everything loaded.  Must not be called while games use the snapshot.
+{
+	for (map<UINT, CDbRoom*>::const_iterator room = this->rooms.begin();
+			room != this->rooms.end(); ++room)
+		delete room->second;
+	this->rooms.clear();
+	this->roomIDs.clear();
+	this->requiredRooms.clear();
+	this->holdCompleted.clear();
+	this->holdMastered.clear();
+	this->customScripts.clear();
+	this->inputCommandKeyTexts.clear();
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::GetCustomCharacterScript(
+	const UINT dwHoldID, HoldCharacter& character, COMMAND_VECTOR& commands)
+const
+{
+	map<IDPAIR, COMMAND_VECTOR>::const_iterator found =
+			this->customScripts.find(IDPAIR(dwHoldID, character.dwCharID));
+	if (found == this->customScripts.end())
+	{
+		ASSERT(!"Custom character script not loaded");
+		commands.clear();
+		return;
+	}
+	commands = found->second;
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::GetRequiredRooms(const UINT dwLevelID, CIDSet& requiredRooms) const
+{
+	map<UINT, CIDSet>::const_iterator found = this->requiredRooms.find(dwLevelID);
+	ASSERT(found != this->requiredRooms.end());
+	if (found != this->requiredRooms.end())
+		requiredRooms = found->second;
+}
+
+//*****************************************************************************
+WSTRING CGameDataSnapshot::GetInputCommandKeyText(const InputCommands::DCMD eCommand) const
+{
+	ASSERT(eCommand < this->inputCommandKeyTexts.size());
+	return eCommand < this->inputCommandKeyTexts.size() ?
+			this->inputCommandKeyTexts[eCommand] : WSTRING();
+}
+
+//*****************************************************************************
+CDbRoom* CGameDataSnapshot::GetRoomAtCoords(
+	CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY)
+const
+{
+	const UINT dwRoomID = GetRoomIDAtCoords(level, dwRoomX, dwRoomY);
+	map<UINT, CDbRoom*>::const_iterator found = this->rooms.find(dwRoomID);
+	if (found == this->rooms.end())
+	{
+		//Only rooms next to where the games were added are loaded.
+		ASSERT(!dwRoomID);
+		return NULL;
+	}
+	return new CDbRoom(*found->second);
+}
+
+//*****************************************************************************
+UINT CGameDataSnapshot::GetRoomIDAtCoords(
+	const CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY)
+const
+{
+	map<UINT, map<ROOMCOORD,UINT> >::const_iterator rooms = this->roomIDs.find(level.dwLevelID);
+	ASSERT(rooms != this->roomIDs.end());
+	if (rooms == this->roomIDs.end())
+		return 0;
+
+	map<ROOMCOORD,UINT>::const_iterator found = rooms->second.find(ROOMCOORD(dwRoomX, dwRoomY));
+	return found != rooms->second.end() ? found->second : 0;
+}
+
+//*****************************************************************************
+const WCHAR* CGameDataSnapshot::GetSpeechText(CDbSpeech& speech) const
+//Returns: speech text, which must have been loaded with LoadSpeechText()
+{
+	const CDbMessageText& text = speech.MessageText;
+	return (const WCHAR*)text;
+}
+
+//*****************************************************************************
+bool CGameDataSnapshot::IsHoldCompleted(const UINT dwHoldID) const
+{
+	map<UINT, bool>::const_iterator found = this->holdCompleted.find(dwHoldID);
+	ASSERT(found != this->holdCompleted.end());
+	return found != this->holdCompleted.end() && found->second;
+}
+
+//*****************************************************************************
+bool CGameDataSnapshot::IsHoldMastered(const UINT dwHoldID) const
+{
+	map<UINT, bool>::const_iterator found = this->holdMastered.find(dwHoldID);
+	ASSERT(found != this->holdMastered.end());
+	return found != this->holdMastered.end() && found->second;
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::LoadSpeechText(COMMAND_VECTOR& commands)
+//Reads the text of the commands' speech from the DB, so copying the commands or
+//reading the text afterwards doesn't.  Main thread only.
+{
+	for (COMMAND_VECTOR::iterator command = commands.begin();
+			command != commands.end(); ++command)
+		if (command->pSpeech)
+			command->pSpeech->MessageText.Load();
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::LoadSpeechText(CDbRoom& room)
+//Reads the text of the speech in the room's scripts.  Main thread only.
+{
+	for (CMonster *pMonster = room.pFirstMonster; pMonster != NULL;
+			pMonster = pMonster->pNext)
+		if (pMonster->wType == M_CHARACTER)
+			LoadSpeechText(DYN_CAST(CCharacter*, CMonster*, pMonster)->commands);
+}
+
+//*****************************************************************************
+void CGameDataSnapshot::AddRoom(
+//Loads the room at the given coords, if there is one and it isn't loaded yet.
+//
+//Params:
+	CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY) //(in)
+{
+	const UINT dwRoomID = GetRoomIDAtCoords(level, dwRoomX, dwRoomY);
+	if (!dwRoomID || this->rooms.count(dwRoomID))
+		return;
+
+	CDbRoom *pRoom = CGameDataSource::GetRoomAtCoords(level, dwRoomX, dwRoomY);
+	if (!pRoom)
+		return;
+	LoadSpeechText(*pRoom);
+
+	//Keep a copy of the loaded room.  Its coord indexes then share storage
+	//that already has a reference count, so copying the room on several
+	//threads at once only increments the count and doesn't write to the room.
+	this->rooms[dwRoomID] = new CDbRoom(*pRoom);
+	delete pRoom;
+}
+
+//
+//CSimulationContext
+//
+
+//*****************************************************************************
+void CPathSearchSpace::Start(
+//Begins a new search, with no squares visited and nothing in the open list.
+//
+//Params:
+	const UINT wCols, const UINT wRows) //(in) dimensions of room searched
+{
+	const UINT wArea = wCols * wRows;
+	if (wCols != this->wCols || wArea != this->searches.size() || !++this->dwSearch)
+	{
+		//Room size changed, or search numbers wrapped around.
+		this->wCols = wCols;
+		this->searches.assign(wArea, 0);
+		this->scores.resize(wArea);
+		this->moves.resize(wArea);
+		this->dwSearch = 1;
+	}
+	this->open.clear();
+}
+
+//*****************************************************************************
+CSimulationContext::CSimulationContext()
+	: bCalculatingPathmap(false)
+	, wLastStationTurnInit((UINT)-1)
+	, pDataSource(&dbSource)
+{
+}
+
+//*****************************************************************************
+void CSimulationContext::SetDataSource(
+//Sets where hold data is read from during play.
+//
+//Params:
+	const CGameDataSource *pSource) //(in) if NULL, read from the DB
+{
+	this->pDataSource = pSource ? pSource : &dbSource;
+}
@@ -0,0 +1,220 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//SimulationContext.h
+//Declarations for CSimulationContext and CGameDataSource.
+//
+//Each CCurrentGame owns a CSimulationContext holding the scratch state its
+//room objects use while processing a turn.  Hold data looked up during play
+//is read through the context's CGameDataSource, so games being stepped on
+//different threads don't touch shared state or the DB.
+
+#ifndef SIMULATIONCONTEXT_H
+#define SIMULATIONCONTEXT_H
+
+#include "CharacterCommand.h"
+#include "GameConstants.h"
+#include <BackEndLib/Coord.h>
+#include <BackEndLib/CoordIndex.h>
+#include <BackEndLib/CoordSet.h>
+#include <BackEndLib/IDSet.h>
+#include <BackEndLib/Types.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+using std::map;
+using std::pair;
+using std::vector;
+
+class CCurrentGame;
+class CDbLevel;
+class CDbRoom;
+class CDbSpeech;
+struct HoldCharacter;
+
+//*****************************************************************************
+//Read-only hold data a game needs while it is being played.
+//This implementation reads the DB directly and may only be used on the main thread.
+class CGameDataSource
+{
+public:
+	virtual ~CGameDataSource() {}
+
+	virtual void     GetCustomCharacterScript(const UINT dwHoldID, HoldCharacter& character,
+			COMMAND_VECTOR& commands) const;
+	virtual void     GetRequiredRooms(const UINT dwLevelID, CIDSet& requiredRooms) const;
+	virtual WSTRING  GetInputCommandKeyText(const InputCommands::DCMD eCommand) const;
+	virtual CDbRoom* GetRoomAtCoords(CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY) const;
+	virtual UINT     GetRoomIDAtCoords(const CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY) const;
+	virtual const WCHAR* GetSpeechText(CDbSpeech& speech) const;
+	virtual bool     IsHoldCompleted(const UINT dwHoldID) const;
+	virtual bool     IsHoldMastered(const UINT dwHoldID) const;
+};
+
+//*****************************************************************************
+//Hold data read from the DB up front, for games played on worker threads.
+//AddGame() is called on the main thread for each game before any worker starts.
+//Afterwards, lookups only read what was loaded, so any number of threads may
+//use the snapshot at once without touching the DB.
+//
+//Only what a game can reach without changing level is loaded: the rooms next to
+//its current room, level and hold tallies, custom character scripts and the text
+//of every speech command in them, and the names of the player's command keys.
+class CGameDataSnapshot : public CGameDataSource
+{
+public:
+	CGameDataSnapshot() { }
+	virtual ~CGameDataSnapshot();
+
+	void AddGame(CCurrentGame& game);
+	void Clear();
+
+	virtual void     GetCustomCharacterScript(const UINT dwHoldID, HoldCharacter& character,
+			COMMAND_VECTOR& commands) const;
+	virtual void     GetRequiredRooms(const UINT dwLevelID, CIDSet& requiredRooms) const;
+	virtual WSTRING  GetInputCommandKeyText(const InputCommands::DCMD eCommand) const;
+	virtual CDbRoom* GetRoomAtCoords(CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY) const;
+	virtual UINT     GetRoomIDAtCoords(const CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY) const;
+	virtual const WCHAR* GetSpeechText(CDbSpeech& speech) const;
+	virtual bool     IsHoldCompleted(const UINT dwHoldID) const;
+	virtual bool     IsHoldMastered(const UINT dwHoldID) const;
+
+	static void LoadSpeechText(COMMAND_VECTOR& commands);
+	static void LoadSpeechText(CDbRoom& room);
+
+private:
+	CGameDataSnapshot(const CGameDataSnapshot&);
+	CGameDataSnapshot& operator=(const CGameDataSnapshot&);
+
+	void AddRoom(CDbLevel& level, const UINT dwRoomX, const UINT dwRoomY);
+
+	typedef pair<UINT,UINT> IDPAIR;
+	map<UINT, CIDSet> requiredRooms;          //levelID --> required rooms
+	map<UINT, map<ROOMCOORD,UINT> > roomIDs;  //levelID --> room at each coord
+	map<UINT, CDbRoom*> rooms;                //roomID --> room as loaded
+	map<UINT, bool> holdCompleted, holdMastered; //holdID --> flag for player at load
+	map<IDPAIR, COMMAND_VECTOR> customScripts; //(holdID,charID) --> default script
+	vector<WSTRING> inputCommandKeyTexts;      //command --> name of key it is bound to
+};
+
+//*****************************************************************************
+//Reusable scratch space for A* searches across a room (CMonster::FindOptimalPath2).
+//Squares visited are stamped with the number of the current search, so
+//starting a new search doesn't have to clear the room-sized arrays, and the
+//open list keeps its storage from one search to the next.
+class CPathSearchSpace
+{
+public:
+	struct NODE
+	{
+		NODE(const UINT wX, const UINT wY, const UINT wCost, const UINT wScore)
+			: wX(wX), wY(wY), wCost(wCost), wScore(wScore)
+		{ }
+		UINT wX, wY;
+		UINT wCost;    //f -- distance already traveled
+		UINT wScore;   //f+g -- cost + lowest possible remaining distance to goal
+
+		//For priority queue insertion:
+		bool operator <(const NODE& mc) const {return mc.wScore < this->wScore;}
+	};
+
+	CPathSearchSpace() : wCols(0), dwSearch(0) { }
+
+	void Start(const UINT wCols, const UINT wRows);
+
+	//Returns: score square was visited with in this search, or 0 if not visited
+	UINT GetScore(const UINT wX, const UINT wY) const {
+		const UINT i = wY * this->wCols + wX;
+		return this->searches[i] == this->dwSearch ? this->scores[i] : 0;
+	}
+	//Returns: move made to reach a visited square
+	BYTE GetMove(const UINT wX, const UINT wY) const {
+		ASSERT(GetScore(wX, wY));
+		return this->moves[wY * this->wCols + wX];
+	}
+	void Visit(const UINT wX, const UINT wY, const UINT score, const BYTE move) {
+		const UINT i = wY * this->wCols + wX;
+		this->searches[i] = this->dwSearch;
+		this->scores[i] = score;
+		this->moves[i] = move;
+	}
+
+	//Open list.  The heap operations are the ones std::priority_queue uses,
+	//so nodes with equal scores come out in the same order.
+	bool empty() const {return this->open.empty();}
+	void Push(const NODE& node) {
+		this->open.push_back(node);
+		std::push_heap(this->open.begin(), this->open.end());
+	}
+	NODE Pop() {
+		std::pop_heap(this->open.begin(), this->open.end());
+		const NODE node = this->open.back();
+		this->open.pop_back();
+		return node;
+	}
+
+private:
+	UINT wCols;
+	UINT dwSearch;          //number of the current search
+	vector<UINT> searches;  //search each square was last visited in
+	vector<UINT> scores;
+	vector<BYTE> moves;
+	vector<NODE> open;
+};
+
+//*****************************************************************************
+//Per-game scratch state used while processing a turn.
+class CSimulationContext
+{
+public:
+	CSimulationContext();
+
+	const CGameDataSource& GetDataSource() const {return *this->pDataSource;}
+	void SetDataSource(const CGameDataSource *pSource);
+
+	//Monster pathfinding (CMonster).
+	CCoordIndex_T<UINT> pathSearch; //for breadth-first search
+	CPathSearchSpace pathSearchSpace; //for A* search
+	CCoordIndex swordsInRoom;       //speed optimization for pathmapping
+	bool bCalculatingPathmap;
+
+	//Station pathmaps (CStation).
+	UINT wLastStationTurnInit;
+	CCoordIndex stationSwords;
+
+	//Platform movement (CPlatform).
+	CCoordSet fallTiles; //tiles platforms moved off of since last falling check
+
+private:
+	const CGameDataSource *pDataSource;
+};
+
+//Returns: the simulation context of pGame, or a shared context for use on the
+//main thread when no game is being played (e.g. in the editor)
+CSimulationContext& GetSimulationContext(const CCurrentGame *pGame);
+
+#endif //...#ifndef SIMULATIONCONTEXT_H
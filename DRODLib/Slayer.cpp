@@ -32,6 +32,7 @@
 
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 #include <BackEndLib/UtilFuncs.h>
 
@@ -81,6 +82,16 @@ bool CSlayer::OnStabbed(
 	return CMonster::OnStabbed(CueEvents, wX, wY, weaponType);
 }
 
+//*****************************************************************************************
+ULONGLONG CSlayer::GetStateHash() const
+//Returns: a hash of the Slayer's game state, including what it is trying to do
+{
+	return CArmedMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->wTurnCombatBegan,
+			(this->openingDoorAt.wY << 16) | (this->openingDoorAt.wX & 0xffff),
+			0x08000000 | (this->state << 1) | (this->bMovingWisp ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CSlayer::Process(
 //Process Slayer for movement.
@@ -45,6 +45,7 @@ public:
 	
 	virtual bool BrainAffects() const {return false;}
 	virtual bool DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsTileObstacle(const UINT wTileNo) const;
 	virtual bool IsOpenMove(const int dx, const int dy) const;
 	virtual bool IsOpenMove(const UINT wX, const UINT wY, const int dx, const int dy) const;
@@ -32,6 +32,7 @@
 
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 const UINT wSenseRadius = 2;	//within this distance spiders are always visible
 
@@ -47,6 +48,14 @@ void CSpider::SetVisibility()
 			this->pCurrentGame->pRoom->bBetterVision;
 }
 
+//*****************************************************************************************
+ULONGLONG CSpider::GetStateHash() const
+//Returns: a hash of this monster's game state, including whether it is visible
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState, 0, 0,
+			0x09000000 | (this->bSpiderVisible ? 1 : 0));
+}
+
 //*****************************************************************************************
 void CSpider::Process(
 //Process a spider for movement.
@@ -40,6 +40,7 @@ public:
 	CSpider(CCurrentGame *pSetCurrentGame = NULL) : CMonster(M_SPIDER, pSetCurrentGame, GROUND_AND_SHALLOW_WATER), bSpiderVisible(false) {}
 	IMPLEMENT_CLONE_REPLICATE(CMonster, CSpider);
 
+	virtual ULONGLONG GetStateHash() const;
 	bool IsSpiderVisible() const { return bSpiderVisible; }
 	void SetVisibility();
 	virtual void Process(const int nLastCommand, CCueEvents &CueEvents);
@@ -33,7 +33,30 @@
 #include "CurrentGame.h"
 #include "DbRooms.h"
 
-CIDSet CStalwart::typesToAttack;
+//*****************************************************************************************
+static CIDSet GetTypesToAttack()
+//Returns: the set of monster types stalwarts attack
+{
+	//Attack non-friendly monster types.
+	static const UINT NUM_TYPES = 29;
+	static const UINT types[NUM_TYPES] = {
+		M_ROACH, M_QROACH, M_REGG, M_GOBLIN, M_WWING,
+		M_EYE, M_TARBABY, M_BRAIN, M_SPIDER, M_SERPENTG,
+		M_ROCKGOLEM, M_WATERSKIPPER, M_SKIPPERNEST, M_AUMTLICH, M_SEEP,
+		M_SLAYER, M_SLAYER2, M_GUARD, M_MUDBABY, M_GELBABY,
+		M_ROCKGIANT, M_TARMOTHER, M_MUDMOTHER, M_GELMOTHER, M_SERPENTB,
+		M_SERPENTG, M_SERPENT, M_WUBBA, M_CONSTRUCT
+		//not M_GENTRYII?
+	};
+	CIDSet typesToAttack;
+	for (UINT wI=NUM_TYPES; wI--; )
+		typesToAttack += types[wI];
+	return typesToAttack;
+}
+
+//Populated before any game runs, so it is never written to while games are played
+//on several threads.
+const CIDSet CStalwart::typesToAttack = GetTypesToAttack();
 
 //
 //Public methods.
@@ -52,23 +75,6 @@ CStalwart::CStalwart(
 	const UINT type) //[default=M_STALWART]
 	: CPlayerDouble(type, pSetCurrentGame, eMovement, SPD_STALWART) //move after fegundo, before slayer
 {
-	//The first time, populate the set of monsters to attack.
-	if (CStalwart::typesToAttack.empty())
-	{
-		//Attack non-friendly monster types.
-		static const UINT NUM_TYPES = 29;
-		static const UINT types[NUM_TYPES] = {
-			M_ROACH, M_QROACH, M_REGG, M_GOBLIN, M_WWING,
-			M_EYE, M_TARBABY, M_BRAIN, M_SPIDER, M_SERPENTG,
-			M_ROCKGOLEM, M_WATERSKIPPER, M_SKIPPERNEST, M_AUMTLICH, M_SEEP,
-			M_SLAYER, M_SLAYER2, M_GUARD, M_MUDBABY, M_GELBABY,
-			M_ROCKGIANT, M_TARMOTHER, M_MUDMOTHER, M_GELMOTHER, M_SERPENTB,
-			M_SERPENTG, M_SERPENT, M_WUBBA, M_CONSTRUCT
-			//not M_GENTRYII?
-		};
-		for (UINT wI=NUM_TYPES; wI--; )
-			CStalwart::typesToAttack += types[wI];
-	}
 }
 
 //*****************************************************************************************
@@ -113,7 +119,7 @@ const
 		return true;
 
 	//Can't step on any swords.
-	if (this->swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
+	if (GetSimulationContext().swordsInRoom.Exists(wCol, wRow)) //this set is compiled at beginning of move
 		return true;
 
 	//Player can never be stepped on.
@@ -231,7 +237,7 @@ bool CStalwart::GetGoal(UINT& wX, UINT& wY)
 
 	//Each turn, find the optimal path to the closest monster.
 	//Optimization: get all sword coords once for pathmap search.
-	this->pCurrentGame->pRoom->GetSwordCoords(this->swordsInRoom, true, false, this);
+	this->pCurrentGame->pRoom->GetSwordCoords(GetSimulationContext().swordsInRoom, true, false, this);
 	this->pathToDest.Clear();
 	if (!FindOptimalPathToClosestMonster(this->wX, this->wY, CStalwart::typesToAttack))
 		return false;  //no path is available
@@ -55,7 +55,7 @@ public:
 	void ProcessDaggerMove(const int dx, const int dy, CCueEvents& CueEvents);
 
 protected:
-	static CIDSet typesToAttack;
+	static const CIDSet typesToAttack;
 };
 
 class CStalwart2 : public CStalwart
@@ -0,0 +1,94 @@
+// $Id$
+
+/* ***** BEGIN LICENSE BLOCK *****
+* Version: MPL 1.1
+*
+* The contents of this file are subject to the Mozilla Public License Version
+* 1.1 (the "License"); you may not use this file except in compliance with
+* the License. You may obtain a copy of the License at
+* http://www.mozilla.org/MPL/
+*
+* Software distributed under the License is distributed on an "AS IS" basis,
+* WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+* for the specific language governing rights and limitations under the
+* License.
+*
+* The Original Code is Deadly Rooms of Death.
+*
+* The Initial Developer of the Original Code is
+* Caravel Software.
+* Portions created by the Initial Developer are Copyright (C) 1995, 1996,
+* 1997, 2000, 2001, 2002, 2005, 2016 Caravel Software. All Rights Reserved.
+*
+* Contributor(s):
+*
+* ***** END LICENSE BLOCK ***** */
+
+//StateHash.h
+//Zobrist-style keys for hashing game state.
+//
+//A state hash is the XOR of one key per element of state (e.g., the tile on a
+//square).  When an element changes, its old key is XORed out and its new key
+//XORed in, so the hash can be kept up to date without rescanning everything.
+//Keys are derived from their inputs with a fixed mixing function instead of
+//being drawn from a random table, so hashes are the same on every platform
+//and in every run.
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <BackEndLib/Types.h>
+
+namespace StateHash
+{
+	//What kind of state element a key is for.
+	enum Element
+	{
+		OSquare=1,   //o-layer tile on a square
+		FSquare=2,   //f-layer tile on a square
+		TSquare=3,   //t-layer object on a square
+		Var=4,       //packed var
+		Monster=5,   //monster in the room
+		MonsterPiece=6, //extra square occupied by a monster
+		Player=7,    //player state
+		Game=8,      //turn counters
+		PathSearch=9, //path search made by a monster
+		MonsterState=10, //run-time state kept by a monster type
+		RoomState=11 //room state carried between turns
+	};
+
+	//Returns: a well-distributed 64-bit value for x
+	inline ULONGLONG Mix(ULONGLONG x)
+	{
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	//Returns: the key for an element with the given values
+	inline ULONGLONG Key(const Element eElement, const UINT a, const UINT b=0, const UINT c=0)
+	{
+		return Mix(Mix(Mix((ULONGLONG(eElement) << 32) | a) ^ b) ^ c);
+	}
+
+	//Returns: a hash of a block of bytes
+	inline ULONGLONG Bytes(const void *pData, const UINT dwSize, ULONGLONG hash=0)
+	{
+		const BYTE *pByte = static_cast<const BYTE*>(pData);
+		ULONGLONG word = 0;
+		UINT wI;
+		for (wI=0; wI<dwSize; ++wI)
+		{
+			word = (word << 8) | pByte[wI];
+			if ((wI & 7) == 7)
+			{
+				hash = Mix(hash ^ word);
+				word = 0;
+			}
+		}
+		return Mix(hash ^ word ^ (ULONGLONG(dwSize) << 56));
+	}
+}
+
+#endif //...#ifndef STATEHASH_H
@@ -27,9 +27,7 @@
 #include "Station.h"
 #include "DbRooms.h"
 #include "CurrentGame.h"
-
-UINT CStation::wLastTurnInit = (UINT)-1;
-CCoordIndex CStation::swords;
+#include "SimulationContext.h"
 
 static const UINT wNumNeighbors = 8;
 static const int dxDir[wNumNeighbors] = { 0, 1, 0,-1, 1, 1,-1,-1};
@@ -44,7 +42,9 @@ CStation::CStation(const UINT wX, const UINT wY, CDbRoom* const pRoom)
 	this->pathmap.Init(pRoom->wRoomCols, pRoom->wRoomRows);
 	this->distance.Init(pRoom->wRoomCols, pRoom->wRoomRows);
 	RecalcPathmap();
-	CStation::wLastTurnInit = (UINT)-1;
+	if (pRoom->GetCurrentGame())
+		pRoom->GetCurrentGame()->GetSimulationContext().wLastStationTurnInit = (UINT)-1;
+	//else: CDbRoom::SetCurrentGame() resets this
 }
 
 //******************************************************************************
@@ -67,6 +67,7 @@ UINT CStation::GetDirectionFrom(const UINT wX, const UINT wY) const
 	if (!wCurrentDist)
 		wCurrentDist = static_cast<UINT>(-1);
 
+	const CCoordIndex& swords = Swords();
 	const UINT wT = this->pRoom->GetFSquare(wX, wY);
 	const UINT wCols = this->pRoom->wRoomCols, wRows = this->pRoom->wRoomRows;
 	UINT wXDest, wYDest, wScore, wDist;
@@ -83,7 +84,7 @@ UINT CStation::GetDirectionFrom(const UINT wX, const UINT wY) const
 		if (this->pRoom->DoesGentryiiPreventDiagonal(wX, wY, wXDest, wYDest))
 			bMonsterObstacle = true;
 		if (wScore && wDist < wCurrentDist && wScore < wBestScore &&
-				!bMonsterObstacle && !CStation::swords.Exists(wXDest, wYDest) &&
+				!bMonsterObstacle && !swords.Exists(wXDest, wYDest) &&
 				!IsObstacle(wT, wXDest, wYDest, nGetO(dxDir[n], dyDir[n])) &&
 				!this->pRoom->GetCurrentGame()->IsPlayerAt(wXDest, wYDest)) //can't step on player
 		{
@@ -108,6 +109,7 @@ UINT CStation::GetDistanceFrom(const UINT wX, const UINT wY) const
 		return wDist;
 
 	//(x,y) is not on pathmap.  See whether an adjacent tile on the pathmap can be reached.
+	const CCoordIndex& swords = Swords();
 	const UINT wT = this->pRoom->GetFSquare(wX, wY);
 	const UINT wCols = this->pRoom->wRoomCols, wRows = this->pRoom->wRoomRows;
 	UINT wXDest, wYDest;
@@ -118,7 +120,7 @@ UINT CStation::GetDistanceFrom(const UINT wX, const UINT wY) const
 		wDist = this->distance.GetAt(wXDest, wYDest);
 		if (wDist &&
 				this->pRoom->GetMonsterAtSquare(wXDest, wYDest) == NULL &&
-				!CStation::swords.Exists(wXDest, wYDest) &&
+				!swords.Exists(wXDest, wYDest) &&
 				!IsObstacle(wT, wXDest, wYDest, nGetO(dxDir[n], dyDir[n])))
 			return wDist;
 	}
@@ -126,6 +128,58 @@ UINT CStation::GetDistanceFrom(const UINT wX, const UINT wY) const
 	return 0;
 }
 
+//******************************************************************************
+UINT CStation::GetObstacleMask(
+//Returns: bits describing how a square blocks movement on station path maps.
+//Path maps only need recalculating when a square's mask changes.
+//
+//Params:
+	const CDbRoom& room,          //(in) room square is in
+	const UINT wX, const UINT wY) //(in) square
+{
+	UINT mask = 0;
+	const UINT wF = room.GetFSquare(wX, wY);
+	for (UINT wO=0; wO<ORIENTATION_COUNT; ++wO)
+	{
+		if (wO == NO_ORIENTATION)
+			continue;
+		if (IsEntryBlocked(wF, wO))
+			mask |= 1 << wO;
+		if (IsExitBlocked(room, wX, wY, wO))
+			mask |= 1 << (ORIENTATION_COUNT + wO);
+	}
+
+	//Whether a station is here, as path maps are only made from existing stations.
+	if (room.GetTSquare(wX, wY) == T_STATION)
+		mask |= 1 << (2 * ORIENTATION_COUNT);
+
+	return mask;
+}
+
+//******************************************************************************
+bool CStation::IsNearPathmap(const UINT wX, const UINT wY) const
+//Returns: whether (x,y) or a square next to it is on the pathmap.
+//If not, GetDistanceFrom(x,y) is 0 wherever monsters and swords are, until
+//the pathmap is recalculated.
+{
+	if (this->pRoom->GetTSquare(this->wX,this->wY)!=T_STATION)
+		return false; //station no longer exists
+
+	const UINT wCols = this->pRoom->wRoomCols, wRows = this->pRoom->wRoomRows;
+	if (this->distance.GetAt(wX,wY))
+		return true;
+	UINT wXDest, wYDest;
+	for (UINT n=wNumNeighbors; n--; )
+	{
+		if ((wYDest = wY+dyDir[n]) >= wRows) continue;
+		if ((wXDest = wX+dxDir[n]) >= wCols) continue;
+		if (this->distance.GetAt(wXDest, wYDest))
+			return true;
+	}
+
+	return false;
+}
+
 //******************************************************************************
 void CStation::RecalcPathmap()
 //Mark path maps as needing recalculation next time they are queried.
@@ -148,22 +202,29 @@ bool CStation::UpdateTurn(const UINT wTurnNo)
 	if (bRes)
 		CalcPathmap();
 
-	if (wTurnNo == CStation::wLastTurnInit)
+	CCurrentGame *pGame = this->pRoom->GetCurrentGame();
+	ASSERT(pGame);
+	CSimulationContext& context = pGame->GetSimulationContext();
+	if (wTurnNo == context.wLastStationTurnInit)
 		return bRes;
-	CStation::wLastTurnInit = wTurnNo;
+	context.wLastStationTurnInit = wTurnNo;
 
 	//Can't step on any swords.
-	ASSERT(this->pRoom);
-	this->pRoom->GetSwordCoords(CStation::swords, true);
+	this->pRoom->GetSwordCoords(context.stationSwords, true);
 
 	//Don't allow stepping on player either.
-	CCurrentGame *pGame = this->pRoom->GetCurrentGame();
-	ASSERT(pGame);
 	if (pGame->swordsman.IsInRoom())
-		CStation::swords.Add(pGame->swordsman.wX, pGame->swordsman.wY);
+		context.stationSwords.Add(pGame->swordsman.wX, pGame->swordsman.wY);
 	return bRes;
 }
 
+//******************************************************************************
+const CCoordIndex& CStation::Swords() const
+//Returns: sword (and player) positions marked by UpdateTurn() this turn
+{
+	return GetSimulationContext(this->pRoom->GetCurrentGame()).stationSwords;
+}
+
 //******************************************************************************
 void CStation::UpdateType()
 // Updates the type of the station to its tile's T parameter
@@ -220,19 +281,17 @@ void CStation::CalcPathmap()
 	}
 
 	this->bRecalcPathmap = false;
+	++this->pRoom->dwStationPathsVersion;
 }
 
 //******************************************************************************
-bool CStation::IsObstacle(
-//Returns: whether source tile can be exited and destination one entered
+bool CStation::IsEntryBlocked(
+//Returns: whether a tile can't be entered from the given direction
 //
 //Params:
 	const UINT wDestF,  //F-layer tile at destination
-	const UINT wX, const UINT wY, //source tile
 	const UINT wOrientation) //direction of approach
-const
 {
-	//Check whether it is impossible to reach destination from this direction.
 	switch (wDestF)
 	{
 		case T_NODIAGONAL:
@@ -248,9 +307,20 @@ const
 		break;
 		default: break;
 	}
+	return false;
+}
 
+//******************************************************************************
+bool CStation::IsExitBlocked(
+//Returns: whether a tile can't be left in the given direction
+//
+//Params:
+	const CDbRoom& room,
+	const UINT wX, const UINT wY, //source tile
+	const UINT wOrientation) //direction of movement
+{
 	//These are tiles it is impossible to come from.
-	switch (this->pRoom->GetOSquare(wX,wY))
+	switch (room.GetOSquare(wX,wY))
 	{
 		case T_PIT: case T_PIT_IMAGE: case T_STAIRS: case T_STAIRS_UP:
 		case T_WALL: case T_WALL2: case T_WALL_IMAGE:
@@ -261,7 +331,7 @@ const
 			return true;
 		default: break;
 	}
-	const UINT wF = this->pRoom->GetFSquare(wX,wY);
+	const UINT wF = room.GetFSquare(wX,wY);
 	switch (wF)
 	{
 		//Can the source tile be left from this direction?
@@ -278,7 +348,7 @@ const
 		break;
 		default: break;
 	}
-	switch (this->pRoom->GetTSquare(wX,wY))
+	switch (room.GetTSquare(wX,wY))
 	{
 		case T_BRIAR_SOURCE: case T_BRIAR_DEAD: case T_BRIAR_LIVE:
 		case T_OBSTACLE: case T_ORB: case T_BOMB:
@@ -294,9 +364,24 @@ const
 	//However, serpent body tiles aren't being considered an obstacle, like for
 	//brain pathmapping, which included them as obstacles solely due to code
 	//limitations in v1.5.
-	CMonster *pMonster = this->pRoom->GetMonsterAtSquare(wX,wY);
+	CMonster *pMonster = room.GetMonsterAtSquare(wX,wY);
 	if (pMonster && bIsRockGolemType(pMonster->wType) && !pMonster->IsAlive())
 		return true;
 
 	return false; //step can be taken
 }
+
+//******************************************************************************
+bool CStation::IsObstacle(
+//Returns: whether source tile can be exited and destination one entered
+//
+//Params:
+	const UINT wDestF,  //F-layer tile at destination
+	const UINT wX, const UINT wY, //source tile
+	const UINT wOrientation) //direction of approach
+const
+{
+	//Check whether it is impossible to reach destination from this direction.
+	return IsEntryBlocked(wDestF, wOrientation) ||
+			IsExitBlocked(*this->pRoom, wX, wY, wOrientation);
+}
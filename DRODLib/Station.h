@@ -41,7 +41,9 @@ public:
 
 	UINT GetDirectionFrom(const UINT wX, const UINT wY) const;
 	UINT GetDistanceFrom(const UINT wX, const UINT wY) const;
+	static UINT GetObstacleMask(const CDbRoom& room, const UINT wX, const UINT wY);
 	inline UINT GetType() const {return this->wType;}
+	bool IsNearPathmap(const UINT wX, const UINT wY) const;
 	void RecalcPathmap();
 	bool UpdateTurn(const UINT wTurnNo);
 	void UpdateType();
@@ -50,6 +52,10 @@ public:
 
 private:
 	void CalcPathmap();
+	const CCoordIndex& Swords() const;
+	static bool IsEntryBlocked(const UINT wDestF, const UINT wOrientation);
+	static bool IsExitBlocked(const CDbRoom& room, const UINT wX, const UINT wY,
+			const UINT wOrientation);
 	inline bool IsObstacle(const UINT wDestF, const UINT wX, const UINT wY,
 			const UINT wOrientation) const;
 
@@ -59,8 +65,6 @@ private:
 
 	CCoordIndex_T<UINT> pathmap, distance;
 
-	static UINT wLastTurnInit; //speed optimization
-	static CCoordIndex swords;
 	bool bRecalcPathmap;
 };
 
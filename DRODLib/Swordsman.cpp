@@ -31,6 +31,7 @@
 #include "Swordsman.h"
 #include "Weapons.h"
 #include "TileConstants.h"
+#include "StateHash.h"
 #include <BackEndLib/Assert.h>
 
 //
@@ -183,6 +184,30 @@ MovementType CSwordsman::GetMovementType() const
 	}
 }
 
+//*****************************************************************************
+ULONGLONG CSwordsman::GetStateHash() const
+//Returns: a hash of the player's game state, for CCurrentGame::GetStateHash()
+{
+	const UINT wFlags =
+		(this->bNoWeapon ? 0x0001 : 0) |
+		(this->bWeaponSheathed ? 0x0002 : 0) |
+		(this->bWeaponOff ? 0x0004 : 0) |
+		(this->bIsDying ? 0x0008 : 0) |
+		(this->bIsInvisible ? 0x0010 : 0) |
+		(this->bIsHiding ? 0x0020 : 0) |
+		(this->bIsHasted ? 0x0040 : 0) |
+		(this->bFrozen ? 0x0080 : 0) |
+		(this->bIsTarget ? 0x0100 : 0) |
+		(this->bCanGetItems ? 0x0200 : 0);
+	return
+		StateHash::Key(StateHash::Player,
+			(this->wY << 16) | this->wX, this->wO,
+			(this->wAppearance << 16) | this->wIdentity) ^
+		StateHash::Key(StateHash::Player,
+			0x80000000 | wFlags, (this->weaponType << 16) | this->localRoomWeaponType,
+			(this->wStealth << 16) | this->wWaterTraversal);
+}
+
 //*****************************************************************************
 bool CSwordsman::IsAt(UINT wX, UINT wY) const
 {
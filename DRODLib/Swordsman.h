@@ -72,6 +72,7 @@ public:
 	void EquipWeapon(const UINT type);
 	UINT GetWaterTraversalState(UINT wRole = M_NONE) const;
 	MovementType GetMovementType() const;
+	ULONGLONG GetStateHash() const;
 	bool IsAt(UINT wX, UINT wY) const;
 	bool IsInRoom() const;
 	bool IsStabbable() const;
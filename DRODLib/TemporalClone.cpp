@@ -27,6 +27,7 @@
 #include "TemporalClone.h"
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //*****************************************************************************************
 CTemporalClone::CTemporalClone(
@@ -182,6 +183,20 @@ bool CTemporalClone::OnStabbed(
 	return true;
 }
 
+//*****************************************************************************
+ULONGLONG CTemporalClone::GetStateHash() const
+//Returns: a hash of this clone's game state, including its queued moves
+{
+	ULONGLONG hash = CArmedMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->wIdentity, this->wAppearance,
+			0x0A000000 | (this->bInvisible ? 1 : 0) | (this->bIsTarget ? 2 : 0));
+	ULONGLONG commandHash = 0;
+	for (std::deque<int>::const_iterator command = this->commands.begin();
+			command != this->commands.end(); ++command)
+		commandHash = StateHash::Mix(commandHash ^ (UINT)*command);
+	return hash ^ StateHash::Mix(commandHash ^ (ULONGLONG(this->commands.size()) << 32));
+}
+
 //*****************************************************************************
 void CTemporalClone::Process(const int /*nLastCommand*/, CCueEvents &CueEvents)
 {
@@ -38,6 +38,7 @@ public:
 
 	virtual bool CanDropTrapdoor(const UINT oTile) const;
 	virtual UINT GetIdentity() const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsAttackableTarget() const;
 	virtual bool IsFlying() const;
 	virtual bool IsHiding() const;
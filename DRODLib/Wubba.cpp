@@ -29,11 +29,20 @@
 
 #include "CurrentGame.h"
 #include "DbRooms.h"
+#include "StateHash.h"
 
 //
 //Public methods.
 //
 
+//*****************************************************************************************
+ULONGLONG CWubba::GetStateHash() const
+//Returns: a hash of this monster's game state
+{
+	return CMonster::GetStateHash() ^ StateHash::Key(StateHash::MonsterState,
+			this->wNextStabTurn, 0, 0x0B000000);
+}
+
 //*****************************************************************************************
 void CWubba::Process(
 //Process a wubba for movement.
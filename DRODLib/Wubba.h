@@ -42,6 +42,7 @@ public:
 
 	virtual bool CheckForDamage(CCueEvents& CueEvents);
 	virtual bool DoesSquareContainObstacle(const UINT wCol, const UINT wRow) const;
+	virtual ULONGLONG GetStateHash() const;
 	virtual bool IsAggressive() const {return false;}
 	virtual bool OnStabbed(CCueEvents &CueEvents, const UINT wX=-1, const UINT wY=-1,
 			WeaponType weaponType=WT_Sword);
@@ -7,6 +7,44 @@
 #include <vector>
 using namespace std;
 
+//T-layer tiles in rect (x1,y1)-(x2,y2), row by row.
+static vector<UINT> GetTTiles(const CDbRoom& room,
+	const UINT x1, const UINT y1, const UINT x2, const UINT y2)
+{
+	vector<UINT> tiles;
+	for (UINT y = y1; y <= y2; ++y)
+		for (UINT x = x1; x <= x2; ++x)
+			tiles.push_back(room.GetTSquare(x, y));
+	return tiles;
+}
+
+static vector<UINT> GetTTiles(const CDbRoom& room)
+{
+	return GetTTiles(room, 0, 0, room.wRoomCols - 1, room.wRoomRows - 1);
+}
+
+//Plays the room twice for the given number of turns: first rebuilding every
+//briar component each turn, then as normal.  Briar must grow the same way both times.
+static void RequireSameGrowthAsFullRecalc(const UINT wTurns)
+{
+	vector<vector<UINT> > expected;
+	CCurrentGame* pGame = Runner::StartGame(35, 30, N);
+	for (UINT wTurn = 0; wTurn < wTurns; ++wTurn)
+	{
+		pGame->pRoom->briars.forceRecalc();
+		Runner::ExecuteCommand(CMD_WAIT);
+		expected.push_back(GetTTiles(*pGame->pRoom));
+	}
+
+	pGame = Runner::StartGame(35, 30, N);
+	for (UINT wTurn = 0; wTurn < wTurns; ++wTurn)
+	{
+		Runner::ExecuteCommand(CMD_WAIT);
+		INFO("turn " << wTurn + 1);
+		REQUIRE(GetTTiles(*pGame->pRoom) == expected[wTurn]);
+	}
+}
+
 TEST_CASE("Briars", "[game][elements]") {
 	RoomBuilder::ClearRoom();
 	
@@ -43,4 +81,137 @@ TEST_CASE("Briars", "[game][elements]") {
 		AssertNoTile(17, 8, T_BRIAR_LIVE);
 		AssertNoTile(17, 8, T_BRIAR_DEAD);
 	}
+
+	SECTION("Cutting one component should not change how another one grows") {
+		// #################  #################
+		// #...............#  #...............#
+		// #.wwwwwww..B....#  #.....wwwww.....#
+		// #.wwwRwww.......#  #.....wwRww.....#
+		// #.wwwwwww.......#  #.....wwwww.....#
+		// #...............#  #...............#
+		// #################  #################
+		// Left briar is cut by a bomb exploded by script on turn 1
+
+		RoomBuilder::PlotRect(T_WALL, 1, 1, 17, 15);
+		RoomBuilder::PlotRect(T_FLOOR, 2, 2, 16, 14);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 3, 6, 9, 10);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 5, 8);
+		RoomBuilder::Plot(T_BOMB, 12, 8);
+
+		RoomBuilder::PlotRect(T_WALL, 20, 1, 36, 15);
+		RoomBuilder::PlotRect(T_FLOOR, 21, 2, 35, 14);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 26, 6, 30, 10);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 28, 8);
+
+		static const UINT TURNS = 25;
+		vector<vector<UINT> > expected;
+		CCurrentGame* pGame = Runner::StartGame(35, 30, N);
+		for (UINT wTurn = 0; wTurn < TURNS; ++wTurn)
+		{
+			Runner::ExecuteCommand(CMD_WAIT);
+			expected.push_back(GetTTiles(*pGame->pRoom, 21, 2, 35, 14));
+		}
+
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(1, 25);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_AttackTile, 12, 8, 0, 0, ScriptFlag::AT_Stab);
+
+		pGame = Runner::StartGame(35, 30, N);
+		for (UINT wTurn = 0; wTurn < TURNS; ++wTurn)
+		{
+			Runner::ExecuteCommand(CMD_WAIT);
+			INFO("turn " << wTurn + 1);
+			REQUIRE(GetTTiles(*pGame->pRoom, 21, 2, 35, 14) == expected[wTurn]);
+		}
+		AssertNoTile(12, 8, T_BOMB);
+	}
+
+	SECTION("Removing a root should leave the rest of its component growing as a full recalculation would") {
+		// ##############################
+		// #............................#
+		// #..RwwwwwwwwwwwwwwwR.........#
+		// #............................#
+		// #..B.........................#
+		// ##############################
+		// Left root is destroyed by a bomb exploded by script on turn 1
+
+		RoomBuilder::PlotRect(T_WALL, 1, 1, 30, 11);
+		RoomBuilder::PlotRect(T_FLOOR, 2, 2, 29, 10);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 5, 6, 19, 6);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 4, 6);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 20, 6);
+		RoomBuilder::Plot(T_BOMB, 4, 8);
+
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(1, 25);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_AttackTile, 4, 8, 0, 0, ScriptFlag::AT_Stab);
+
+		RequireSameGrowthAsFullRecalc(25);
+
+		AssertNoTile(4, 6, T_BRIAR_SOURCE);
+		AssertTile(20, 6, T_BRIAR_SOURCE);
+	}
+
+	SECTION("Briar surrounded by its own component should grow again when a pit opens beside it") {
+		// #######
+		// #wwwww#
+		// #wwwww#
+		// #wwRwT# - T: trapdoor under the briar, dropped by script on turn 3
+		// #wwwww#
+		// #wwwww#
+		// #######
+
+		RoomBuilder::PlotRect(T_WALL, 7, 7, 13, 13);
+		RoomBuilder::PlotRect(T_FLOOR, 8, 8, 12, 12);
+		RoomBuilder::Plot(T_TRAPDOOR, 12, 10);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 8, 8, 12, 12);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 10, 10);
+
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(1, 25);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_Wait, 2);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_DestroyTrapdoor, 12, 10);
+
+		CCurrentGame* pGame = Runner::StartGame(35, 30, N);
+		Runner::ExecuteCommand(CMD_WAIT);
+		AssertTile(11, 10, T_BRIAR_DEAD);
+
+		bool bGrew = false;
+		for (UINT wTurn = 0; wTurn < 4 && !bGrew; ++wTurn)
+		{
+			Runner::ExecuteCommand(CMD_WAIT);
+			bGrew = pGame->pRoom->GetTSquare(11, 10) == T_BRIAR_LIVE;
+		}
+		REQUIRE(bGrew);
+		REQUIRE(pGame->pRoom->GetOSquare(12, 10) == T_PIT);
+		AssertNoTile(12, 10, T_BRIAR_LIVE);
+		AssertNoTile(12, 10, T_BRIAR_DEAD);
+	}
+
+	SECTION("Components should merge the same way after only one of them was recalculated") {
+		// ########################
+		// #wwwwwww........wwwwwww#
+		// #wwwwwww........wwwwwww#
+		// #wwRwwww........wwwwRww#
+		// #wwwwwww........wwwwwww#
+		// #wwwwwww........wwwwwww#
+		// ####.###################
+		// ####B################### - Bomb exploded by script on turn 1, cutting the left briar
+		// ########################
+
+		RoomBuilder::PlotRect(T_WALL, 1, 1, 24, 9);
+		RoomBuilder::PlotRect(T_FLOOR, 2, 2, 23, 6);
+		RoomBuilder::PlotRect(T_FLOOR, 5, 7, 5, 8);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 2, 2, 8, 6);
+		RoomBuilder::PlotRect(T_BRIAR_DEAD, 17, 2, 23, 6);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 3, 4);
+		RoomBuilder::Plot(T_BRIAR_SOURCE, 21, 4);
+		RoomBuilder::Plot(T_BOMB, 5, 8);
+
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(1, 25);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_AttackTile, 5, 8, 0, 0, ScriptFlag::AT_Stab);
+
+		RequireSameGrowthAsFullRecalc(80);
+
+		CBriars& briars = Runner::GetCurrentGame()->pRoom->briars;
+		REQUIRE(briars.getIndexAt(3, 4) != 0);
+		REQUIRE(briars.getIndexAt(3, 4) == briars.getIndexAt(21, 4));
+	}
 }
@@ -0,0 +1,34 @@
+#include "../../test-include.hpp"
+
+TEST_CASE("Evil eye", "[game]") {
+	RoomBuilder::ClearRoom();
+	RoomBuilder::AddMonster(M_EYE, 20, 10, W);
+
+	SECTION("Wakes on seeing the player") {
+		CCurrentGame* game = Runner::StartGame(10, 11, N);
+		CMonster* pEye = game->pRoom->GetMonsterAtSquare(20, 10);
+		Runner::ExecuteCommand(CMD_WAIT);
+		REQUIRE(!pEye->IsAggressive());
+
+		Runner::ExecuteCommand(CMD_N);
+		REQUIRE(pEye->IsAggressive());
+	}
+
+	SECTION("Gaze is blocked by a wall plotted after it was last checked") {
+		CCurrentGame* game = Runner::StartGame(10, 11, N);
+		CMonster* pEye = game->pRoom->GetMonsterAtSquare(20, 10);
+		Runner::ExecuteCommand(CMD_WAIT);
+
+		game->pRoom->Plot(15, 10, T_WALL);
+		Runner::ExecuteCommand(CMD_N);
+		REQUIRE(!pEye->IsAggressive());
+	}
+
+	SECTION("Gaze turned back by a mirror sees behind the eye") {
+		RoomBuilder::Plot(T_MIRROR, 19, 10);
+		CCurrentGame* game = Runner::StartGame(22, 11, N);
+		CMonster* pEye = game->pRoom->GetMonsterAtSquare(20, 10);
+		Runner::ExecuteCommand(CMD_N);
+		REQUIRE(pEye->IsAggressive());
+	}
+}
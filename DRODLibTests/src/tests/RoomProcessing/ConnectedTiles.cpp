@@ -0,0 +1,42 @@
+#include "../../test-include.hpp"
+
+TEST_CASE("Connected tiles", "[game]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Tarstuff is connected only through 2x2 blocks") {
+		RoomBuilder::PlotRect(T_TAR, 5, 5, 6, 6);
+		RoomBuilder::PlotRect(T_TAR, 6, 6, 7, 7);
+		RoomBuilder::Plot(T_TAR, 8, 7);
+		RoomBuilder::PlotRect(T_TAR, 30, 5, 31, 6);
+
+		CCurrentGame* game = Runner::StartGame(15, 15, N);
+		CCoordSet tiles;
+		game->pRoom->GetTarConnectedComponent(5, 5, tiles);
+		REQUIRE(tiles.size() == 7);
+		REQUIRE(tiles.has(7, 7));
+		REQUIRE(!tiles.has(8, 7));
+
+		game->pRoom->GetTarConnectedComponent(30, 5, tiles);
+		REQUIRE(tiles.size() == 4);
+
+		game->pRoom->GetTarConnectedComponent(8, 7, tiles);
+		REQUIRE(tiles.size() == 1);
+	}
+
+	SECTION("No diagonal steps are taken from beside a pit") {
+		RoomBuilder::PlotRect(T_WALL, 3, 3, 9, 9);
+		RoomBuilder::Plot(T_PIT, 6, 6);
+		RoomBuilder::Plot(T_FLOOR, 5, 6);
+		RoomBuilder::Plot(T_FLOOR, 6, 7);
+		RoomBuilder::Plot(T_FLOOR, 7, 6);
+
+		CCurrentGame* game = Runner::StartGame(15, 15, N);
+		CTileMask floorMask(T_FLOOR);
+		CCoordSet tiles;
+		game->pRoom->GetConnected8NeighborTiles(5, 6, floorMask, tiles);
+		REQUIRE(tiles.size() == 3);
+
+		game->pRoom->GetConnected8NeighborTilesWithoutAxialPit(5, 6, floorMask, tiles);
+		REQUIRE(tiles.size() == 1);
+	}
+}
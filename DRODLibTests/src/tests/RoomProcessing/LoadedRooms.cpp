@@ -0,0 +1,92 @@
+#include "../../test-include.hpp"
+
+namespace {
+	//An empty room added next to the test room for the player to walk into.
+	//It is removed again when the test is done.
+	class AdjacentRoom
+	{
+	public:
+		AdjacentRoom(const CDbRoom& room, const int dx, const int dy)
+		{
+			CDbRoom* pRoom = g_pTheDB->Rooms.GetNew();
+			pRoom->dwLevelID = room.dwLevelID;
+			pRoom->dwRoomX = room.dwRoomX + dx;
+			pRoom->dwRoomY = room.dwRoomY + dy;
+			pRoom->wRoomCols = room.wRoomCols;
+			pRoom->wRoomRows = room.wRoomRows;
+			pRoom->style = room.style;
+			REQUIRE(pRoom->AllocTileLayers());
+
+			const UINT dwSquareCount = pRoom->CalcRoomArea();
+			memset(pRoom->pszOSquares, T_FLOOR, dwSquareCount * sizeof(char));
+			memset(pRoom->pszFSquares, T_EMPTY, dwSquareCount * sizeof(char));
+			pRoom->ClearTLayer();
+			pRoom->coveredOSquares.Init(pRoom->wRoomCols, pRoom->wRoomRows);
+			pRoom->tileLights.Init(pRoom->wRoomCols, pRoom->wRoomRows);
+
+			REQUIRE(pRoom->Update());
+			this->dwRoomID = pRoom->dwRoomID;
+			delete pRoom;
+			g_pTheDB->Commit();
+		}
+		~AdjacentRoom()
+		{
+			g_pTheDB->Rooms.Delete(this->dwRoomID);
+			g_pTheDB->Commit();
+		}
+
+		UINT dwRoomID;
+	};
+
+	void RequireSameRoomState(const CDbRoom& room, const CDbRoom& expected)
+	{
+		REQUIRE(room.dwRoomID == expected.dwRoomID);
+		REQUIRE(room.GetTileHash() == expected.GetTileHash());
+		REQUIRE(room.GetTurnStateHash() == expected.GetTurnStateHash());
+
+		//Monster hashes include NPC script progress and local vars.
+		const CMonster* pMonster = room.pFirstMonster;
+		const CMonster* pExpected = expected.pFirstMonster;
+		for ( ; pMonster && pExpected; pMonster = pMonster->pNext, pExpected = pExpected->pNext)
+			REQUIRE(pMonster->GetStateHash() == pExpected->GetStateHash());
+		REQUIRE(!pMonster);
+		REQUIRE(!pExpected);
+	}
+}
+
+TEST_CASE("Loaded rooms", "[game]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Going back to a changed room enters it as loaded from the DB") {
+		RoomBuilder::Plot(T_ORB, 37, 10);
+		RoomBuilder::Plot(T_DOOR_Y, 30, 20);
+		RoomBuilder::LinkOrb(37, 10, 30, 20, OA_TOGGLE);
+		RoomBuilder::AddMonster(M_ROACH, 5, 5);
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(3, 28);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_Wait, 1);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_Wait, 10);
+
+		CCurrentGame* game = Runner::StartGame(36, 11, N);
+		AdjacentRoom eastRoom(*game->pRoom, 1, 0);
+		game = Runner::StartGame(36, 11, N);
+		const UINT dwRoomID = game->pRoom->dwRoomID;
+
+		Runner::ExecuteCommand(CMD_C); // Strike orb
+		REQUIRE(game->pRoom->GetOSquare(30, 20) == T_DOOR_YO);
+		Runner::ExecuteCommand(CMD_E);
+		Runner::ExecuteCommand(CMD_E); // Leave the room
+		REQUIRE(game->pRoom->dwRoomID == eastRoom.dwRoomID);
+
+		Runner::ExecuteCommand(CMD_W); // Come back
+		REQUIRE(game->pRoom->dwRoomID == dwRoomID);
+		REQUIRE(game->swordsman.wX == 37);
+		REQUIRE(game->pRoom->GetOSquare(30, 20) == T_DOOR_Y);
+
+		CCueEvents CueEvents;
+		CCurrentGame* pFreshGame = g_pTheDB->GetNewTestGame(dwRoomID, CueEvents,
+				game->swordsman.wX, game->swordsman.wY, game->swordsman.wO, true);
+		REQUIRE(pFreshGame != NULL);
+		RequireSameRoomState(*game->pRoom, *pFreshGame->pRoom);
+		delete pFreshGame;
+	}
+}
@@ -0,0 +1,100 @@
+#include "../../test-include.hpp"
+#include "../../../../DRODLib/Pathmap.h"
+
+#include <vector>
+using namespace std;
+
+namespace {
+	const UINT COLS = 38, ROWS = 32;
+
+	//Same numbers on every platform, so a failure can be replayed.
+	UINT NextRandom(UINT& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) & 0x7fff;
+	}
+
+	UINT RandomBlockedDirections(UINT& seed, const bool bSupportPartialObstacles)
+	{
+		static const UINT masks[] = {
+			DMASK_NONE, DMASK_ALL,
+			DMASK_NW | DMASK_N | DMASK_NE, DMASK_SW | DMASK_S | DMASK_SE, //like force arrows
+			DMASK_NE | DMASK_E | DMASK_SE, DMASK_NW | DMASK_W | DMASK_SW,
+			DMASK_NE | DMASK_SE | DMASK_SW | DMASK_NW                     //like an orthosquare
+		};
+		if (!bSupportPartialObstacles)
+			return NextRandom(seed) % 3 ? DMASK_NONE : DMASK_ALL;
+		return masks[NextRandom(seed) % (sizeof(masks) / sizeof(masks[0]))];
+	}
+
+	//Requires the repaired map to give the same distances and recommended
+	//paths as a map calculated from scratch over the same squares.
+	void RequireSameAsFullRecalc(CPathMap& repaired, const vector<UINT>& blocked,
+		const UINT xTarget, const UINT yTarget, const bool bSupportPartialObstacles)
+	{
+		CPathMap full(COLS, ROWS, xTarget, yTarget, 0, bSupportPartialObstacles);
+		for (UINT y = 0; y < ROWS; ++y)
+			for (UINT x = 0; x < COLS; ++x)
+				full.SetSquare(x, y, blocked[y * COLS + x]);
+
+		for (UINT y = 0; y < ROWS; ++y)
+			for (UINT x = 0; x < COLS; ++x)
+			{
+				INFO("square (" << x << "," << y << ")");
+				REQUIRE(repaired.GetSquare(x, y).dwTargetDist == full.GetSquare(x, y).dwTargetDist);
+
+				SORTPOINTS repairedPaths, fullPaths;
+				repaired.GetRecPaths(x, y, repairedPaths);
+				full.GetRecPaths(x, y, fullPaths);
+				REQUIRE(repairedPaths.size() == fullPaths.size());
+				for (UINT i = 0; i < fullPaths.size(); ++i)
+				{
+					REQUIRE(repairedPaths[i].wX == fullPaths[i].wX);
+					REQUIRE(repairedPaths[i].wY == fullPaths[i].wY);
+					REQUIRE(repairedPaths[i].dwScore == fullPaths[i].dwScore);
+				}
+			}
+	}
+
+	void TestRandomRepairs(const bool bSupportPartialObstacles, UINT seed)
+	{
+		const UINT xTarget = 12, yTarget = 17;
+		CPathMap repaired(COLS, ROWS, xTarget, yTarget, 0, bSupportPartialObstacles);
+		vector<UINT> blocked(COLS * ROWS, DMASK_NONE);
+
+		//Start from a room with some obstacles in it.
+		for (UINT i = 0; i < COLS * ROWS / 4; ++i)
+		{
+			const UINT index = NextRandom(seed) % (COLS * ROWS);
+			blocked[index] = RandomBlockedDirections(seed, bSupportPartialObstacles);
+			repaired.SetSquare(index % COLS, index / COLS, blocked[index]);
+		}
+		repaired.CalcPaths();
+
+		//Change a few squares at a time, and check the paths after each batch.
+		for (UINT wBatch = 0; wBatch < 40; ++wBatch)
+		{
+			const UINT wChanges = 1 + NextRandom(seed) % 6;
+			for (UINT i = 0; i < wChanges; ++i)
+			{
+				const UINT index = NextRandom(seed) % (COLS * ROWS);
+				blocked[index] = RandomBlockedDirections(seed, bSupportPartialObstacles);
+				repaired.SetSquare(index % COLS, index / COLS, blocked[index]);
+			}
+			INFO("batch " << wBatch);
+			RequireSameAsFullRecalc(repaired, blocked, xTarget, yTarget, bSupportPartialObstacles);
+		}
+	}
+}
+
+TEST_CASE("Pathmap repairs", "[game]") {
+	SECTION("Repairing after random obstacle changes should match a full recalculation") {
+		TestRandomRepairs(false, 1);
+		TestRandomRepairs(false, 2);
+	}
+
+	SECTION("Repairing after random partial obstacle changes should match a full recalculation") {
+		TestRandomRepairs(true, 3);
+		TestRandomRepairs(true, 4);
+	}
+}
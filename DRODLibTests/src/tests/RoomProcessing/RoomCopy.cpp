@@ -0,0 +1,30 @@
+#include "../../test-include.hpp"
+
+TEST_CASE("Room copies", "[game]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Copy has its own monsters and serpent pieces") {
+		CSerpent* serpent = DYN_CAST(CSerpent*, CMonster*, RoomBuilder::AddMonster(M_SERPENTB, 10, 10, E));
+		RoomBuilder::AddSerpentPiece(serpent, 9, 10);
+		RoomBuilder::AddSerpentPiece(serpent, 8, 10);
+		RoomBuilder::AddMonster(M_ROACH, 20, 20);
+
+		CCurrentGame* game = Runner::StartGame(15, 15, N);
+		CMonster* pSerpent = game->pRoom->GetMonsterAtSquare(10, 10);
+		{
+			CDbRoom copy(*game->pRoom);
+			REQUIRE(copy.wMonsterCount == game->pRoom->wMonsterCount);
+
+			CMonster* pCopiedSerpent = copy.GetMonsterAtSquare(10, 10);
+			REQUIRE(pCopiedSerpent != NULL);
+			REQUIRE(pCopiedSerpent != pSerpent);
+			REQUIRE(pCopiedSerpent->Pieces.size() == pSerpent->Pieces.size());
+			REQUIRE(copy.GetMonsterAtSquare(8, 10) == pCopiedSerpent);
+			REQUIRE(copy.GetMonsterAtSquare(20, 20) != game->pRoom->GetMonsterAtSquare(20, 20));
+		}
+
+		//The original room is intact after the copy is freed.
+		REQUIRE(game->pRoom->GetMonsterAtSquare(8, 10) == pSerpent);
+		REQUIRE(game->pRoom->GetMonsterAtSquare(20, 20) != NULL);
+	}
+}
@@ -0,0 +1,66 @@
+#include "../../test-include.hpp"
+#include "../../../../DRODLib/RoomSolver.h"
+
+TEST_CASE("Room solver", "[game]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Finds the shortest way to kill a monster") {
+		RoomBuilder::AddMonster(M_ROACH, 10, 8);
+
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		CRoomSolver solver(*game, 1);
+		REQUIRE(solver.Solve());
+
+		const vector<UINT>& solution = solver.GetSolution();
+		REQUIRE(solution.size() == 1);
+		REQUIRE(solution[0] == CMD_N);
+	}
+
+	SECTION("Solution found with several threads clears the room") {
+		RoomBuilder::AddMonster(M_ROACH, 10, 6);
+		RoomBuilder::AddMonster(M_ROACH, 13, 10);
+
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		CRoomSolver solver(*game, 4);
+		REQUIRE(solver.Solve());
+		REQUIRE(solver.GetStateCount() > 1);
+
+		const vector<UINT>& solution = solver.GetSolution();
+		for (vector<UINT>::const_iterator command = solution.begin();
+				command != solution.end(); ++command)
+			Runner::ExecuteCommand(*command);
+		REQUIRE(game->pRoom->wMonsterCount == 0);
+	}
+
+	SECTION("Solution found in a room with an evil eye and a scripted NPC clears the room") {
+		//The eye's waking and the NPC's script progress aren't visible in the
+		//tiles or monster positions, so states are only told apart correctly
+		//if the state hash covers them.
+		RoomBuilder::AddMonster(M_EYE, 10, 5, S);
+		RoomBuilder::AddMonster(M_ROACH, 20, 10);
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(1, 1);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_Wait, 2);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_AttackTile, 20, 10, 0, 0, ScriptFlag::AT_Stab);
+
+		CCurrentGame* game = Runner::StartGame(12, 10, N);
+		CRoomSolver solver(*game, 4);
+		REQUIRE(solver.Solve());
+
+		const vector<UINT>& solution = solver.GetSolution();
+		for (vector<UINT>::const_iterator command = solution.begin();
+				command != solution.end(); ++command)
+			Runner::ExecuteCommand(*command);
+		REQUIRE(game->pRoom->wMonsterCount == 0);
+	}
+
+	SECTION("Reports when the room can't be conquered") {
+		RoomBuilder::PlotRect(T_WALL, 9, 9, 11, 11);
+		RoomBuilder::Plot(T_FLOOR, 10, 10);
+		RoomBuilder::AddMonster(M_ROACH, 20, 20);
+
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		CRoomSolver solver(*game, 2);
+		REQUIRE(!solver.Solve());
+		REQUIRE(solver.IsExhausted());
+	}
+}
@@ -0,0 +1,93 @@
+#include "../../test-include.hpp"
+#include "../../../../DRODLib/EvilEye.h"
+
+namespace {
+	UINT GetLocalVarID()
+	{
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		UINT varID = game->pHold->GetVarID(L".StateHashTest");
+		if (!varID)
+		{
+			varID = game->pHold->AddVar(L".StateHashTest");
+			game->pHold->Update();
+		}
+		return varID;
+	}
+
+	ULONGLONG GetHashAfterSettingLocalVar(const UINT varID, const UINT value)
+	{
+		RoomBuilder::ClearRoom();
+		CCharacter* pCharacter = RoomBuilder::AddCharacter(20, 20);
+		RoomBuilder::AddCommand(pCharacter, CCharacterCommand::CC_VarSet, varID, ScriptVars::Assign, value);
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		Runner::ExecuteCommand(CMD_WAIT);
+		return game->GetStateHash();
+	}
+}
+
+TEST_CASE("Game state hash", "[game]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Toggling a door back restores the room's tile hash") {
+		RoomBuilder::Plot(T_ORB, 11, 9);
+		RoomBuilder::Plot(T_DOOR_Y, 15, 15);
+		RoomBuilder::LinkOrb(11, 9, 15, 15, OA_TOGGLE);
+
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		const ULONGLONG initialHash = game->pRoom->GetTileHash();
+
+		Runner::ExecuteCommand(CMD_C); // Strike orb
+		REQUIRE(game->pRoom->GetOSquare(15, 15) == T_DOOR_YO);
+		REQUIRE(game->pRoom->GetTileHash() != initialHash);
+
+		Runner::ExecuteCommand(CMD_CC);
+		Runner::ExecuteCommand(CMD_C); // Strike orb again
+		REQUIRE(game->pRoom->GetOSquare(15, 15) == T_DOOR_Y);
+		REQUIRE(game->pRoom->GetTileHash() == initialHash);
+	}
+
+	SECTION("Same moves produce the same state hash") {
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		const ULONGLONG startHash = game->GetStateHash();
+		Runner::ExecuteCommand(CMD_E);
+		const ULONGLONG movedHash = game->GetStateHash();
+		REQUIRE(movedHash != startHash);
+
+		game = Runner::StartGame(10, 10, N);
+		REQUIRE(game->GetStateHash() == startHash);
+		Runner::ExecuteCommand(CMD_E);
+		REQUIRE(game->GetStateHash() == movedHash);
+	}
+
+	SECTION("Waking an evil eye changes the state hash") {
+		RoomBuilder::AddMonster(M_EYE, 20, 10, W);
+		CCurrentGame* game = Runner::StartGame(10, 11, N);
+		CEvilEye* pEye = DYN_CAST(CEvilEye*, CMonster*, game->pRoom->GetMonsterAtSquare(20, 10));
+		Runner::ExecuteCommand(CMD_N);
+		REQUIRE(pEye->IsAggressive());
+		const ULONGLONG awakeHash = game->GetStateHash();
+
+		pEye->SetActive(false);
+		REQUIRE(game->GetStateHash() != awakeHash);
+		pEye->SetActive(true);
+		REQUIRE(game->GetStateHash() == awakeHash);
+	}
+
+	SECTION("Lighting a fuse changes the state hash") {
+		RoomBuilder::PlotRect(T_FUSE, 12, 12, 16, 12);
+		CCurrentGame* game = Runner::StartGame(10, 10, N);
+		const ULONGLONG unlitHash = game->GetStateHash();
+
+		game->pRoom->LitFuses.insert(12, 12);
+		REQUIRE(game->GetStateHash() != unlitHash);
+		game->pRoom->LitFuses.erase(12, 12);
+		REQUIRE(game->GetStateHash() == unlitHash);
+	}
+
+	SECTION("Changing an NPC's local script var changes the state hash") {
+		const UINT varID = GetLocalVarID();
+		const ULONGLONG hash = GetHashAfterSettingLocalVar(varID, 7);
+		REQUIRE(GetHashAfterSettingLocalVar(varID, 7) == hash);
+		REQUIRE(GetHashAfterSettingLocalVar(varID, 8) != hash);
+	}
+}
@@ -0,0 +1,53 @@
+#include "../../test-include.hpp"
+#include "../../../../DRODLib/ScriptExpression.h"
+
+namespace {
+	int Evaluate(const WCHAR* pwStr, CCurrentGame* game)
+	{
+		UINT index = 0;
+		return CCharacter::parseExpression(pwStr, index, game);
+	}
+}
+
+TEST_CASE("Script expressions", "[game][scripting]") {
+	RoomBuilder::ClearRoom();
+	CCurrentGame* game = Runner::StartGame(10, 10, N);
+
+	SECTION("Operators follow precedence and nesting") {
+		REQUIRE(Evaluate(L"2 + 3 * (4 - 1) % 5", game) == 6);
+		REQUIRE(Evaluate(L"-7 / 2", game) == -3);
+		REQUIRE(Evaluate(L"((1))", game) == 1);
+	}
+
+	SECTION("Divide and mod by zero leave the value alone") {
+		REQUIRE(Evaluate(L"10 / 0", game) == 10);
+		REQUIRE(Evaluate(L"10 % (1 - 1)", game) == 10);
+	}
+
+	SECTION("Unknown vars are zero") {
+		REQUIRE(Evaluate(L"NoSuchVar + 1", game) == 1);
+	}
+
+	SECTION("Hold vars are read from and written to the game's stats") {
+		UINT varID = game->pHold->GetVarID(L"TestVar");
+		if (!varID)
+			varID = game->pHold->AddVar(L"TestVar");
+		char varName[12];
+		CCurrentGame::GetHoldVarAccessToken(varID, varName);
+
+		REQUIRE(Evaluate(L"TestVar", game) == 0);
+		game->stats.SetVar(varName, 5);
+		REQUIRE(Evaluate(L"TestVar * 2", game) == 10);
+		game->SetHoldVar(varID, 7);
+		REQUIRE(game->stats.GetVar(varName, (int)0) == 7);
+		REQUIRE(Evaluate(L"TestVar", game) == 7);
+	}
+
+	SECTION("Compiled command expression is recompiled when its label changes") {
+		CCharacterCommand command;
+		command.label = L"3 * 3";
+		REQUIRE(command.GetExpression(game->pHold).Evaluate(game, NULL) == 9);
+		command.label = L"3 - 3";
+		REQUIRE(command.GetExpression(game->pHold).Evaluate(game, NULL) == 0);
+	}
+}
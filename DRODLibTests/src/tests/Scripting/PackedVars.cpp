@@ -0,0 +1,177 @@
+#include "../../test-include.hpp"
+#include "../../../../DRODLib/DbPackedVars.h"
+
+#include <cstring>
+#include <vector>
+using namespace std;
+
+namespace {
+	vector<BYTE> Pack(const CDbPackedVars& vars)
+	{
+		UINT dwSize;
+		BYTE *pBuf = vars.GetPackedBuffer(dwSize);
+		vector<BYTE> bytes(pBuf, pBuf + dwSize);
+		delete[] pBuf;
+		return bytes;
+	}
+
+	//Requires both sets to hold the same vars, with the same types and values.
+	void RequireSameVars(CDbPackedVars& vars, CDbPackedVars& other)
+	{
+		UNPACKEDVAR *pVar = vars.GetFirst();
+		UNPACKEDVAR *pOther = other.GetFirst();
+		while (pVar && pOther)
+		{
+			INFO("var " << pVar->name);
+			REQUIRE(pVar->name == pOther->name);
+			REQUIRE(pVar->eType == pOther->eType);
+			REQUIRE(pVar->dwValueSize == pOther->dwValueSize);
+			REQUIRE(!memcmp(pVar->pValue, pOther->pValue, pVar->dwValueSize));
+			pVar = vars.GetNext();
+			pOther = other.GetNext();
+		}
+		REQUIRE(!pVar);
+		REQUIRE(!pOther);
+	}
+
+	//Packs the vars, unpacks them into a new object, and requires the new
+	//object to pack to the same bytes, hold the same vars and hash the same.
+	void RequireRoundTrip(CDbPackedVars& vars)
+	{
+		const vector<BYTE> bytes = Pack(vars);
+		CDbPackedVars unpacked(&bytes[0]);
+
+		REQUIRE(Pack(unpacked) == bytes);
+		RequireSameVars(vars, unpacked);
+		REQUIRE(unpacked.GetHash() == vars.GetHash());
+
+		CDbPackedVars copied(unpacked);
+		REQUIRE(Pack(copied) == bytes);
+		REQUIRE(copied.GetHash() == vars.GetHash());
+	}
+}
+
+TEST_CASE("Packed vars round trip", "[game]") {
+	CDbPackedVars vars;
+	vars.SetVar("int", -42);
+	vars.SetVar("uint", (UINT)4000000000U);
+	vars.SetVar("byte", (BYTE)200);
+	vars.SetVar("bool", true);
+	vars.SetVar("str", "some text");
+	vars.SetVar("wstr", L"wide text");
+
+	SECTION("No vars") {
+		CDbPackedVars empty;
+		RequireRoundTrip(empty);
+		REQUIRE(empty.GetHash() == 0);
+	}
+
+	SECTION("Vars of every type keep their values") {
+		RequireRoundTrip(vars);
+
+		const vector<BYTE> bytes = Pack(vars);
+		CDbPackedVars unpacked(&bytes[0]);
+		REQUIRE(unpacked.GetVar("int", 0) == -42);
+		REQUIRE(unpacked.GetVar("uint", (UINT)0) == 4000000000U);
+		REQUIRE(unpacked.GetVar("byte", (BYTE)0) == 200);
+		REQUIRE(unpacked.GetVar("bool", false));
+		REQUIRE(!strcmp(unpacked.GetVar("str", ""), "some text"));
+		REQUIRE(!WCScmp(unpacked.GetVar("wstr", L""), L"wide text"));
+		REQUIRE(unpacked.GetVarType("wstr") == UVT_wchar_string);
+	}
+
+	SECTION("Packing doesn't depend on the order vars were set in") {
+		CDbPackedVars reordered;
+		reordered.SetVar("wstr", L"wide text");
+		reordered.SetVar("str", "some text");
+		reordered.SetVar("bool", true);
+		reordered.SetVar("byte", (BYTE)200);
+		reordered.SetVar("uint", (UINT)4000000000U);
+		reordered.SetVar("int", -42);
+
+		RequireRoundTrip(reordered);
+		REQUIRE(Pack(reordered) == Pack(vars));
+		REQUIRE(reordered.GetHash() == vars.GetHash());
+	}
+
+	SECTION("Unset vars are gone after a round trip") {
+		vars.Unset("str");
+		vars.Unset("int");
+		vars.Unset("no such var");
+		RequireRoundTrip(vars);
+
+		CDbPackedVars remaining;
+		remaining.SetVar("uint", (UINT)4000000000U);
+		remaining.SetVar("byte", (BYTE)200);
+		remaining.SetVar("bool", true);
+		remaining.SetVar("wstr", L"wide text");
+		REQUIRE(Pack(vars) == Pack(remaining));
+		REQUIRE(vars.GetHash() == remaining.GetHash());
+
+		const vector<BYTE> bytes = Pack(vars);
+		CDbPackedVars unpacked(&bytes[0]);
+		REQUIRE(!unpacked.DoesVarExist("str"));
+		REQUIRE(!unpacked.DoesVarExist("int"));
+
+		vars.Unset("uint");
+		vars.Unset("byte");
+		vars.Unset("bool");
+		vars.Unset("wstr");
+		RequireRoundTrip(vars);
+		REQUIRE(vars.GetHash() == 0);
+	}
+
+	SECTION("A var changed to a type of the same size") {
+		vars.SetVar("int", (UINT)7);
+		REQUIRE(vars.GetVarType("int") == UVT_uint);
+		RequireRoundTrip(vars);
+
+		const vector<BYTE> bytes = Pack(vars);
+		CDbPackedVars unpacked(&bytes[0]);
+		REQUIRE(unpacked.GetVarType("int") == UVT_uint);
+		REQUIRE(unpacked.GetVar("int", (UINT)0) == 7);
+
+		CDbPackedVars set;
+		set.SetVar("int", (UINT)7);
+		CDbPackedVars changed;
+		changed.SetVar("int", -42);
+		changed.SetVar("int", (UINT)7);
+		REQUIRE(changed.GetHash() == set.GetHash());
+	}
+
+	SECTION("A var changed to a type of another size") {
+		vars.SetVar("byte", "now a string");
+		vars.SetVar("str", 12);
+		REQUIRE(vars.GetVarType("byte") == UVT_char_string);
+		REQUIRE(vars.GetVarType("str") == UVT_int);
+		RequireRoundTrip(vars);
+
+		const vector<BYTE> bytes = Pack(vars);
+		CDbPackedVars unpacked(&bytes[0]);
+		REQUIRE(!strcmp(unpacked.GetVar("byte", ""), "now a string"));
+		REQUIRE(unpacked.GetVar("str", 0) == 12);
+	}
+
+	SECTION("Values rewritten until the arena is compacted") {
+		string value;
+		for (UINT i = 0; i < 100; ++i)
+		{
+			value += 'x';
+			vars.SetVar("str", value.c_str());
+			vars.SetVar("int", (int)i);
+			if (i % 10 == 0)
+				RequireRoundTrip(vars);
+		}
+		RequireRoundTrip(vars);
+
+		CDbPackedVars fresh;
+		fresh.SetVar("int", 99);
+		fresh.SetVar("uint", (UINT)4000000000U);
+		fresh.SetVar("byte", (BYTE)200);
+		fresh.SetVar("bool", true);
+		fresh.SetVar("str", value.c_str());
+		fresh.SetVar("wstr", L"wide text");
+		REQUIRE(Pack(vars) == Pack(fresh));
+		REQUIRE(vars.GetHash() == fresh.GetHash());
+	}
+}
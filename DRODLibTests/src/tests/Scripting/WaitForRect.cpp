@@ -0,0 +1,56 @@
+#include "../../test-include.hpp"
+
+namespace {
+	bool RunWaitForRectScript(const CCharacterCommand::CharCommand command,
+		const UINT x, const UINT y, const UINT w, const UINT h, const UINT flags)
+	{
+		CCharacter* pScript = RoomBuilder::AddCharacter(1, 1);
+		RoomBuilder::AddCommand(pScript, command, x, y, w, h, flags);
+		RoomBuilder::AddCommand(pScript, CCharacterCommand::CC_ChallengeCompleted, 0, 0, 0, 0, 0, L"");
+
+		CCueEvents CueEvents;
+		Runner::StartGame(10, 25, N, CueEvents);
+		return CueEvents.HasOccurred(CID_ChallengeCompleted);
+	}
+}
+
+TEST_CASE("Scripts waiting on monsters in a rect", "[game][scripting]") {
+	RoomBuilder::ClearRoom();
+
+	SECTION("Monster in rect is found") {
+		RoomBuilder::AddMonster(M_ROACH, 12, 6);
+		REQUIRE(RunWaitForRectScript(CCharacterCommand::CC_WaitForRect, 10, 5, 4, 4, ScriptFlag::MONSTER));
+	}
+
+	SECTION("Monster outside rect is not found") {
+		RoomBuilder::AddMonster(M_ROACH, 15, 6);
+		REQUIRE(!RunWaitForRectScript(CCharacterCommand::CC_WaitForRect, 10, 5, 4, 4, ScriptFlag::MONSTER));
+	}
+
+	SECTION("Monster of type is found past the first 32 columns") {
+		RoomBuilder::AddMonster(M_ROACH, 35, 6);
+		REQUIRE(RunWaitForRectScript(CCharacterCommand::CC_WaitForEntityType, 30, 5, 7, 3, M_ROACH));
+	}
+
+	SECTION("Monster of another type is not found") {
+		RoomBuilder::AddMonster(M_GOBLIN, 35, 6);
+		REQUIRE(!RunWaitForRectScript(CCharacterCommand::CC_WaitForEntityType, 30, 5, 7, 3, M_ROACH));
+	}
+
+	SECTION("No monster remains in rect after it is removed") {
+		RoomBuilder::AddMonster(M_ROACH, 31, 6);
+		RoomBuilder::AddMonster(M_ROACH, 32, 6);
+		CCharacter* pScript = RoomBuilder::AddCharacter(1, 1);
+		RoomBuilder::AddCommand(pScript, CCharacterCommand::CC_WaitForNotEntityType, 30, 5, 7, 3, M_ROACH);
+		RoomBuilder::AddCommand(pScript, CCharacterCommand::CC_ChallengeCompleted, 0, 0, 0, 0, 0, L"");
+
+		CCueEvents CueEvents;
+		CCurrentGame* game = Runner::StartGame(10, 25, N, CueEvents);
+		REQUIRE(!CueEvents.HasOccurred(CID_ChallengeCompleted));
+
+		game->pRoom->KillMonsterAtSquare(31, 6, CueEvents);
+		game->pRoom->KillMonsterAtSquare(32, 6, CueEvents);
+		Runner::ExecuteCommand(CMD_WAIT, CueEvents);
+		REQUIRE(CueEvents.HasOccurred(CID_ChallengeCompleted));
+	}
+}
@@ -114,6 +114,9 @@ void     PrintProtectHelp();
 void     PrintRoom(const COptionList &Options, const WCHAR *pszRoomID, 
 		const WCHAR *pszSrcPath, const WCHAR *pszSrcVersion);
 void     PrintRoomHelp();
+void     PrintSolve(const COptionList &Options, const WCHAR *pszRoomID,
+		const WCHAR *pszSrcPath, const WCHAR *pszSrcVersion);
+void     PrintSolveHelp();
 void     PrintSummary(const COptionList &Options, const WCHAR *pszSrcPath, 
 		const WCHAR *pszSrcVersion);
 void     PrintSummaryHelp();
@@ -137,6 +140,7 @@ static const WCHAR wszImport[] = {{'i'},{'m'},{'p'},{'o'},{'r'},{'t'},{0}};
 static const WCHAR wszLevel[] = {{'l'},{'e'},{'v'},{'e'},{'l'},{0}};
 static const WCHAR wszTest[] = {{'t'},{'e'},{'s'},{'t'},{0}};
 static const WCHAR wszRoom[] = {{'r'},{'o'},{'o'},{'m'},{0}};
+static const WCHAR wszSolve[] = {{'s'},{'o'},{'l'},{'v'},{'e'},{0}};
 static const WCHAR wszSummary[] = {{'s'},{'u'},{'m'},{'m'},{'a'},{'r'},{'y'},{0}};
 static const WCHAR wszUnprotect[] = {{'u'},{'n'},{'p'},{'r'},{'o'},{'t'},{'e'},{'c'},{'t'},{0}};
 static const WCHAR *wszProtect = wszUnprotect + 2;
@@ -216,6 +220,7 @@ int wmain(int argc, WCHAR* argv[])
 	else if(WCSicmp(argv[1], wszLevel) == 0)     PrintLevel(OptionList, OPT_PARAM(2), OPT_PARAM(3), OPT_PARAM(4));
 	else if(WCSicmp(argv[1], wszTest) == 0)         PrintTest(OptionList, OPT_PARAM(2), OPT_PARAM(3), OPT_PARAM(4));
 	else if(WCSicmp(argv[1], wszRoom) == 0)         PrintRoom(OptionList, OPT_PARAM(2), OPT_PARAM(3), OPT_PARAM(4));
+	else if(WCSicmp(argv[1], wszSolve) == 0)        PrintSolve(OptionList, OPT_PARAM(2), OPT_PARAM(3), OPT_PARAM(4));
 	else if(WCSicmp(argv[1], wszSummary) == 0)      PrintSummary(OptionList, OPT_PARAM(2), OPT_PARAM(3));
 	else if(WCSicmp(argv[1], wszProtect) == 0)      PrintProtect(OptionList, OPT_PARAM(2));
 	else if(WCSicmp(argv[1], wszUnprotect) == 0) PrintUnprotect(OptionList, OPT_PARAM(2));
@@ -304,6 +309,7 @@ void PrintUsage()
 			"  level     [ [ [ LevelID ] SrcPath ] SrcVersion ]" NEWLINE
 			"  mysql     [ [ [ HoldID ] SrcPath ] SrcVersion ]" NEWLINE
 			"  room      [ [ [ RoomID ] SrcVersion ] SrcPath ]" NEWLINE
+			"  solve     [ Options ] RoomID [ [ SrcPath ] SrcVersion ]" NEWLINE
 			"  summary   [ [ SrcPath ] SrcVersion ]" NEWLINE
 			"  test      [ Options ] [ [ [ DemoID ] SrcVersion ] SrcPath ]" NEWLINE
 			"  protect   SrcFilePath" NEWLINE
@@ -362,6 +368,7 @@ void PrintHelp(
 	else if (WCSicmp(pszCommand, wszTest) == 0)        PrintTestHelp();
 	else if (WCSicmp(pszCommand, wszMySQL) == 0)    PrintMysqlHelp();
 	else if (WCSicmp(pszCommand, wszRoom) == 0)        PrintRoomHelp();
+	else if (WCSicmp(pszCommand, wszSolve) == 0)       PrintSolveHelp();
 	else if (WCSicmp(pszCommand, wszSummary) == 0)     PrintSummaryHelp();
 	else if (WCSicmp(pszCommand, wszProtect) == 0)     PrintProtectHelp();
 	else if (WCSicmp(pszCommand, wszUnprotect) == 0)   PrintUnprotectHelp();
@@ -821,6 +828,78 @@ void PrintRoom(
 		printf("SUCCESS--Room information retrieved." NEWLINE);
 }
 
+//******************************************************************************************
+void PrintSolveHelp()
+{
+	PrintHeader();
+	printf(
+	  "solve       [-a] [-d:depth] [-n:states] [-t:threads] [-m]" NEWLINE
+	  "            [-x:X -y:Y [-o:O]] RoomID [ [ SrcPath ] SrcVersion ]" NEWLINE
+	  "" NEWLINE
+	  "Searches the moves that can be made in a room for the shortest way to conquer" NEWLINE
+	  "it, and shows how many distinct game states can be reached.  Use it to check" NEWLINE
+	  "rooms for unintended solutions." NEWLINE
+	  "" NEWLINE
+	  "Options:" NEWLINE
+	  "  -a            Search states with fewer monsters left first.  This is usually" NEWLINE
+	  "                faster, but the solution found may not be the shortest." NEWLINE
+	  "  -d:depth      Don't search past this many moves." NEWLINE
+	  "  -n:states     Stop after reaching this many states.  Default is 10000000." NEWLINE
+	  "  -t:threads    Number of threads to search with.  Default is one per CPU." NEWLINE
+	  "  -m            Search the same position reached on different turns once." NEWLINE
+	  "                Faster, but ignored in rooms with scripts, which may count" NEWLINE
+	  "                turns." NEWLINE
+	  "  -x:X -y:Y     Player start position.  If omitted, the room's level entrance" NEWLINE
+	  "                is used." NEWLINE
+	  "  -o:O          Player start orientation (0-8, as on the number pad from top" NEWLINE
+	  "                left).  Default is 7 (south)." NEWLINE
+	  "" NEWLINE
+	  "Params:" NEWLINE
+	  "  RoomID        Indicates which room to search." NEWLINE
+	  "  SrcPath       Location of data.  If omitted, default path will be used." NEWLINE
+	  "  SrcVersion    Version of data.  If omitted, default version will be used." NEWLINE
+	  );
+}
+
+//******************************************************************************************
+void PrintSolve(
+//Searches for the shortest way to conquer a room.  See PrintSolveHelp for more info.
+//
+//Params:
+	const COptionList &Options,   //(in)
+	const WCHAR *pszRoomID,       //(in)
+	const WCHAR *pszSrcPath,      //(in)
+	const WCHAR *pszSrcVersion)   //(in)
+{
+	PrintHeader();
+
+	static WCHAR options[] = {{'a'},{','},{'d'},{','},{'e'},{','},{'n'},{','},
+			{'o'},{','},{'t'},{','},{'x'},{','},{'y'},{0}};
+	if (!Options.AreOptionsValid(options)) return;
+
+	WSTRING strSrcPath =
+			(pszSrcPath == NULL || WCSicmp(pszSrcPath, wszDefault)==0 ) ?
+			GetDefaultPath() : pszSrcPath;
+	VERSION eSrcVersion =
+			(pszSrcVersion == NULL || WCSicmp(pszSrcVersion, wszDefault)==0 ) ?
+			GetDefaultVersion() : GetVersionFromParam(pszSrcVersion);
+	const UINT dwRoomID =
+			(pszRoomID == NULL || WCSicmp(pszRoomID, wszDefault)==0 ) ?
+			0L : GetIDFromParam(pszRoomID);
+
+	//Get util for source version.
+	CUtil *pUtil = GetUtil(eSrcVersion, strSrcPath.c_str());
+	if (!pUtil)
+	{
+		printf("FAILED--Version not supported." NEWLINE);
+		return;
+	}
+
+	//Search the room.
+	if (pUtil->PrintSolve(Options, dwRoomID))
+		printf("SUCCESS--Room searched." NEWLINE);
+}
+
 
 //******************************************************************************************
 void PrintSummaryHelp()
@@ -75,6 +75,7 @@ public:
 	virtual bool   PrintImport(const COptionList &/*Options*/, const WCHAR* /*pszSrcPath*/, VERSION /*eSrcVersion*/) const {PrintNotImplemented(); return false;}
 	virtual bool   PrintMysql(const COptionList &/*Options*/, UINT /*dwRoomID*/) const {PrintNotImplemented(); return false;}
 	virtual bool   PrintRoom(const COptionList &/*Options*/, UINT /*dwRoomID*/) const {PrintNotImplemented(); return false;}
+	virtual bool   PrintSolve(const COptionList &/*Options*/, UINT /*dwRoomID*/) const {PrintNotImplemented(); return false;}
 	virtual bool   PrintSummary(const COptionList &/*Options*/) const {PrintNotImplemented(); return false;}
 	virtual bool   PrintTest(const COptionList &/*Options*/, UINT /*dwDemoID*/) const {PrintNotImplemented(); return false;}
 
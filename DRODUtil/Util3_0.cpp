@@ -36,13 +36,17 @@
 #include "../DRODLib/Db.h"
 #include "../DRODLib/DbProps.h"
 #include "../DRODLib/DbMessageText.h"
+#include "../DRODLib/CurrentGame.h"
+#include "../DRODLib/EntranceData.h"
 #include "../DRODLib/GameConstants.h"
+#include "../DRODLib/RoomSolver.h"
 #include "../Texts/MIDs.h"
 #include <FrontEndLib/Screen.h>
 #include <BackEndLib/MessageIDs.h>
 #include <BackEndLib/Date.h>
 #include <BackEndLib/Files.h>
 #include <BackEndLib/GameStream.h>
+#include <BackEndLib/SysTimer.h>
 #include <BackEndLib/Wchar.h>
 #include <BackEndLib/Ports.h>
 
@@ -427,6 +431,138 @@ Failure:
 	return false;
 }
 
+//**************************************************************************************
+static const char* GetCommandName(const UINT nCommand)
+//Returns: the name a solution command is printed as
+{
+	switch (nCommand)
+	{
+		case CMD_N: return "N";
+		case CMD_NE: return "NE";
+		case CMD_E: return "E";
+		case CMD_SE: return "SE";
+		case CMD_S: return "S";
+		case CMD_SW: return "SW";
+		case CMD_W: return "W";
+		case CMD_NW: return "NW";
+		case CMD_C: return "C";
+		case CMD_CC: return "CC";
+		case CMD_WAIT: return "wait";
+		case CMD_YES: return "yes";
+		case CMD_NO: return "no";
+		default: return "?";
+	}
+}
+
+//**************************************************************************************
+static void PrintSolveProgress(const UINT dwStates, const UINT wDepth)
+//Shows search progress every so often.
+{
+	static UINT dwLastTime = 0;
+	const UINT dwNow = GetTicks();
+	if (dwNow - dwLastTime < 1000)
+		return;
+	dwLastTime = dwNow;
+	printf("  %u states reached, %u moves deep..." NEWLINE, dwStates, wDepth);
+}
+
+//**************************************************************************************
+bool CUtil3_0::PrintSolve(const COptionList &Options, UINT dwRoomID) const
+//Searches for the shortest way to conquer a room.
+{
+	if (!dwRoomID)
+	{
+		printf("FAILED--A room ID must be given." NEWLINE);
+		return false;
+	}
+
+	CDb db;
+	if (!db.IsOpen())
+	{
+		if (db.Open(this->strPath.c_str()) != MID_Success) return false;
+	}
+	g_pTheDB = &db;
+
+	static const WCHAR wA[] = {{'a'},{0}};
+	static const WCHAR wD[] = {{'d'},{0}};
+	static const WCHAR wM[] = {{'m'},{0}};
+	static const WCHAR wN[] = {{'n'},{0}};
+	static const WCHAR wO[] = {{'o'},{0}};
+	static const WCHAR wT[] = {{'t'},{0}};
+	static const WCHAR wX[] = {{'x'},{0}};
+	static const WCHAR wY[] = {{'y'},{0}};
+	OPTIONNODE *pOpNode = Options.Get(wD);
+	const UINT wMaxDepth = pOpNode ? _Wtoi(pOpNode->szAttributes) : 0;
+	pOpNode = Options.Get(wN);
+	const UINT dwMaxStates = pOpNode ? _Wtoi(pOpNode->szAttributes) : 10000000;
+	pOpNode = Options.Get(wT);
+	const UINT wThreads = pOpNode ? _Wtoi(pOpNode->szAttributes) : 0;
+
+	//Start from the given position, or else from a level entrance in the room.
+	UINT wStartX, wStartY, wStartO;
+	if (Options.Exists(wX) && Options.Exists(wY))
+	{
+		wStartX = _Wtoi(Options.Get(wX)->szAttributes);
+		wStartY = _Wtoi(Options.Get(wY)->szAttributes);
+		pOpNode = Options.Get(wO);
+		wStartO = pOpNode ? _Wtoi(pOpNode->szAttributes) : S;
+	} else {
+		ENTRANCE_VECTOR entrances;
+		db.Holds.GetEntrancesForRoom(dwRoomID, entrances);
+		if (entrances.empty())
+		{
+			printf("FAILED--Room has no level entrance.  Give a start position." NEWLINE);
+			g_pTheDB = NULL;
+			return false;
+		}
+		const CEntranceData *pEntrance = entrances.front();
+		for (ENTRANCE_VECTOR::const_iterator entrance = entrances.begin();
+				entrance != entrances.end(); ++entrance)
+			if ((*entrance)->bIsMainEntrance)
+				pEntrance = *entrance;
+		wStartX = pEntrance->wX;
+		wStartY = pEntrance->wY;
+		wStartO = pEntrance->wO;
+		for (ENTRANCE_VECTOR::const_iterator entrance = entrances.begin();
+				entrance != entrances.end(); ++entrance)
+			delete *entrance;
+	}
+
+	CCueEvents CueEvents;
+	CCurrentGame *pGame = db.GetNewTestGame(dwRoomID, CueEvents, wStartX, wStartY, wStartO, true);
+	if (!pGame)
+	{
+		printf("FAILED--Room could not be loaded." NEWLINE);
+		g_pTheDB = NULL;
+		return false;
+	}
+
+	CRoomSolver solver(*pGame, wThreads);
+	delete pGame;
+	solver.bMergeTurns = Options.Exists(wM);
+	solver.Solve(Options.Exists(wA) ? CRoomSolver::ST_AStar : CRoomSolver::ST_BreadthFirst,
+			dwMaxStates, wMaxDepth, PrintSolveProgress);
+
+	printf("%u distinct states reached, %u moves deep." NEWLINE,
+			solver.GetStateCount(), solver.GetDepthSearched());
+	if (solver.IsSolved())
+	{
+		const vector<UINT>& solution = solver.GetSolution();
+		printf("Solved in %u moves:" NEWLINE, UINT(solution.size()));
+		for (vector<UINT>::const_iterator command = solution.begin();
+				command != solution.end(); ++command)
+			printf(" %s", GetCommandName(*command));
+		printf(NEWLINE);
+	} else if (solver.IsExhausted()) {
+		printf("Room cannot be conquered from this position." NEWLINE);
+	} else {
+		printf("No solution found within the search limits." NEWLINE);
+	}
+
+	g_pTheDB = NULL;
+	return true;
+}
+
 //**************************************************************************************
 bool CUtil3_0::PrintTest(const COptionList &Options, UINT dwDemoID) const
 //Tests a demo or all demos for conquering or integrity.
@@ -54,6 +54,7 @@ public:
 	virtual bool  PrintImport(const COptionList &Options, const WCHAR* pszSrcPath, VERSION eSrcVersion) const;
 	virtual bool  PrintRoom(const COptionList &Options, UINT dwRoomID) const;
 	virtual bool  PrintLevel(const COptionList &Options, UINT dwLevelID) const;
+	virtual bool  PrintSolve(const COptionList &Options, UINT dwRoomID) const;
 	virtual bool  PrintTest(const COptionList &Options, UINT dwDemoID) const;
 
 private: